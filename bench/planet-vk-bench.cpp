@@ -0,0 +1,650 @@
+#include <planet/log.hpp>
+#include <planet/vk/engine.hpp>
+#include <planet/vk/engine/memory/pooled-vector-map.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <SDL3/SDL_hints.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/// ## `planet-vk-bench`
+/**
+ * Runs a fixed set of scenes through an off-screen renderer and writes the
+ * timings for each phase as JSON. Every phase reports:
+ *
+ * * `wall_ms` and `cpu_ms` -- elapsed and process CPU time. The frame phases
+ *   wait for the GPU to go idle before stopping the clock.
+ * * `per_second` -- iterations per second of wall time. Only the phases that
+ *   render have `frames` as their unit, and for those it is the frame rate
+ *   and is also reported as `fps`. Phases that only do CPU work count
+ *   `iterations` and have no `fps`.
+ * * `heap_allocations` -- calls to `operator new` made during the phase.
+ * * `device_allocations` -- blocks of memory taken from the Vulkan driver.
+ *
+ * The textured quad phases also report the bytes each quad touches, as
+ * `vertex_bytes_per_quad`, `index_bytes_per_quad` and their sum in
+ * `bytes_per_quad`.
+ *
+ * The device is created for a `VK_EXT_headless_surface` surface, so it runs on
+ * machines with no display. Use lavapipe on machines with no GPU.
+ */
+
+
+namespace {
+
+
+    /// ### Heap allocation counting
+    std::atomic<std::size_t> heap_allocations = {};
+
+
+    /// ### Options
+    struct options {
+        std::size_t frames = 300;
+        std::size_t warm_up = 30;
+        std::size_t sprites = 2'000;
+        std::size_t quads = 20'000;
+        std::size_t textures = 16;
+        std::size_t triangles = 50'000;
+        std::size_t segments = 50'000;
+        std::size_t churn = 100'000;
+        std::size_t bursts = 20;
+        std::size_t burst_size = 32;
+        std::size_t recreations = 20;
+        std::size_t pipelines = 512;
+        std::size_t commands = 256;
+        std::size_t width = 1280;
+        std::size_t height = 720;
+        std::string output = "-";
+    } config;
+
+    struct option {
+        std::string_view name;
+        std::size_t options::*value;
+    };
+    constexpr std::array numeric_options{
+            option{"frames", &options::frames},
+            option{"warm-up", &options::warm_up},
+            option{"sprites", &options::sprites},
+            option{"quads", &options::quads},
+            option{"textures", &options::textures},
+            option{"triangles", &options::triangles},
+            option{"segments", &options::segments},
+            option{"churn", &options::churn},
+            option{"bursts", &options::bursts},
+            option{"burst-size", &options::burst_size},
+            option{"recreations", &options::recreations},
+            option{"pipelines", &options::pipelines},
+            option{"commands", &options::commands},
+            option{"width", &options::width},
+            option{"height", &options::height}};
+
+    /// Options are given as `--name=value`
+    bool parse(int const argc, char const *argv[]) {
+        for (int index = 1; index < argc; ++index) {
+            std::string_view const arg{argv[index]};
+            auto const equals = arg.find('=');
+            if (not arg.starts_with("--") or equals == std::string_view::npos) {
+                return false;
+            }
+            auto const name = arg.substr(2, equals - 2);
+            auto const value = arg.substr(equals + 1);
+            if (name == "output") {
+                config.output = value;
+                continue;
+            }
+            auto const found = std::find_if(
+                    numeric_options.begin(), numeric_options.end(),
+                    [name](auto const &o) { return o.name == name; });
+            if (found == numeric_options.end()) { return false; }
+            auto &number = config.*(found->value);
+            auto const [end, error] = std::from_chars(
+                    value.data(), value.data() + value.size(), number);
+            if (error != std::errc{} or end != value.data() + value.size()) {
+                return false;
+            }
+        }
+        return config.textures > 0 and config.width > 0 and config.height > 0;
+    }
+    void usage(char const *const exe) {
+        std::cerr << "Usage: " << exe << " [--output=file.json]";
+        for (auto const &o : numeric_options) {
+            std::cerr << " [--" << o.name << "=" << config.*(o.value) << "]";
+        }
+        std::cerr << '\n';
+    }
+
+
+    /// ### Phase measurements
+    /// #### Bytes of vertex and index data each quad touches
+    struct quad_bytes {
+        std::size_t vertex = {}, index = {};
+    };
+    struct phase {
+        std::string_view name;
+        std::string_view unit;
+        std::size_t iterations;
+        double wall_ms, cpu_ms;
+        std::size_t heap_allocations, device_allocations;
+        quad_bytes per_quad;
+    };
+    std::vector<phase> results;
+
+    class measurement {
+        planet::vk::device &device;
+        std::chrono::steady_clock::time_point const wall =
+                std::chrono::steady_clock::now();
+        std::clock_t const cpu = std::clock();
+        std::size_t const heap = heap_allocations.load();
+        std::size_t const blocks = device.block_pool.driver_blocks_allocated();
+
+      public:
+        measurement(planet::vk::device &d) : device{d} {}
+
+        void record(
+                std::string_view const name,
+                std::string_view const unit,
+                std::size_t const iterations,
+                quad_bytes const per_quad = {}) {
+            auto const wall_time = std::chrono::steady_clock::now() - wall;
+            auto const cpu_time = std::clock() - cpu;
+            auto const heap_count = heap_allocations.load() - heap;
+            auto const block_count =
+                    device.block_pool.driver_blocks_allocated() - blocks;
+            results.push_back(
+                    {name, unit, iterations,
+                     std::chrono::duration<double, std::milli>{wall_time}
+                             .count(),
+                     1000.0 * static_cast<double>(cpu_time) / CLOCKS_PER_SEC,
+                     heap_count, block_count, per_quad});
+        }
+    };
+
+
+    /// ### JSON output
+    void write_string(std::ostream &os, std::string_view const s) {
+        os << '"';
+        for (auto const c : s) {
+            if (c == '"' or c == '\\') {
+                os << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                os << ' ';
+            } else {
+                os << c;
+            }
+        }
+        os << '"';
+    }
+    void write_json(std::ostream &os, planet::vk::engine::app const &app) {
+        os << std::fixed << std::setprecision(3)
+           << "{\n  \"benchmark\": \"planet-vk-bench\",\n  \"device\": ";
+        write_string(os, app.instance.gpu().properties.deviceName);
+        os << ",\n  \"extents\": [" << config.width << ", " << config.height
+           << "],\n  \"phases\": [";
+        for (bool first = true; auto const &p : results) {
+            os << (std::exchange(first, false) ? "\n" : ",\n")
+               << "    {\"name\": ";
+            write_string(os, p.name);
+            os << ", \"unit\": ";
+            write_string(os, p.unit);
+            auto const per_second = p.wall_ms > 0
+                    ? 1000.0 * static_cast<double>(p.iterations) / p.wall_ms
+                    : 0.0;
+            os << ", \"iterations\": " << p.iterations
+               << ", \"wall_ms\": " << p.wall_ms << ", \"cpu_ms\": " << p.cpu_ms
+               << ", \"per_second\": " << per_second;
+            if (p.unit == "frames") { os << ", \"fps\": " << per_second; }
+            os << ", \"heap_allocations\": " << p.heap_allocations
+               << ", \"device_allocations\": " << p.device_allocations;
+            if (p.per_quad.vertex or p.per_quad.index) {
+                os << ", \"vertex_bytes_per_quad\": " << p.per_quad.vertex
+                   << ", \"index_bytes_per_quad\": " << p.per_quad.index
+                   << ", \"bytes_per_quad\": "
+                   << p.per_quad.vertex + p.per_quad.index;
+            }
+            os << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+
+    /// ### Scene layout
+    /// Places item `index` of `count` in a square grid over a rectangle
+    planet::affine::rectangle2d
+            cell(std::size_t const index,
+                 std::size_t const count,
+                 planet::affine::rectangle2d const &area) {
+        auto const side = static_cast<std::size_t>(
+                std::ceil(std::sqrt(static_cast<double>(count))));
+        planet::affine::extents2d const size{
+                area.extents.width / side, area.extents.height / side};
+        return {{area.top_left.x() + size.width * (index % side),
+                 area.top_left.y() + size.height * (index / side)},
+                size};
+    }
+    planet::affine::rectangle2d const world_area{
+            {-1.0f, -1.0f}, planet::affine::extents2d{2.0f, 2.0f}};
+
+
+    /// ### Render a phase
+    /**
+     * `draw` is called for every frame. The warm-up frames aren't measured so
+     * that pipeline creation, first use allocations and the like are not
+     * counted.
+     */
+    template<typename Draw>
+    felspar::coro::task<void> frames(
+            planet::vk::engine::renderer &renderer,
+            std::string_view const name,
+            Draw draw,
+            quad_bytes const per_quad = {}) {
+        for (std::size_t frame{}; frame < config.warm_up; ++frame) {
+            co_await renderer.start(planet::colour::black);
+            draw();
+            renderer.submit_and_present();
+        }
+        renderer.app.device.wait_idle();
+        measurement m{renderer.app.device};
+        for (std::size_t frame{}; frame < config.frames; ++frame) {
+            co_await renderer.start(planet::colour::black);
+            draw();
+            renderer.submit_and_present();
+        }
+        renderer.app.device.wait_idle();
+        m.record(name, "frames", config.frames, per_quad);
+    }
+
+
+    /// ### Create the textures used by the textured phases
+    std::vector<planet::vk::texture> create_textures(
+            planet::vk::device_memory_allocator &memory,
+            planet::vk::command_pool &pool,
+            std::size_t const count,
+            std::uint32_t const size) {
+        /// The pixels are only read when the batch is submitted
+        std::vector<std::vector<std::byte>> pixels;
+        pixels.reserve(count);
+        planet::vk::texture_batch batch{memory, pool};
+        for (std::size_t index{}; index < count; ++index) {
+            auto const shade =
+                    static_cast<std::byte>(64 + (191 * index) / count);
+            auto const &p = pixels.emplace_back(4 * size * size, shade);
+            batch.add({.pixels = p, .width = size, .height = size});
+        }
+        return batch.create();
+    }
+
+
+    /// ### Batch items by texture
+    /**
+     * Runs `config.frames` iterations of the textured pipelines' batching.
+     * Each iteration pushes 20 items for every texture, walks the batches and
+     * clears them, as a frame would. Returns the number of items walked.
+     */
+    template<typename Map>
+    std::size_t batch_by_texture(std::vector<int> const &textures) {
+        constexpr std::size_t items_per_texture = 20;
+        std::size_t total = 0;
+        Map m;
+        for (std::size_t frame{}; frame < config.frames; ++frame) {
+            for (std::size_t item{}; item < items_per_texture; ++item) {
+                for (std::size_t index{}; index < textures.size(); ++index) {
+                    /// Step through the textures out of order
+                    auto const &t =
+                            textures[(index * 7 + item) % textures.size()];
+                    m.push_back(&t, static_cast<float>(item));
+                }
+            }
+            for (auto [key, vec] : m.non_empty_vectors()) {
+                total += vec.size();
+            }
+            m.clear();
+        }
+        return total;
+    }
+
+
+    /// ### The benchmark scenes
+    felspar::coro::task<int> benchmarks(
+            planet::vk::engine::app &app,
+            planet::vk::engine::renderer &renderer) {
+        planet::vk::command_pool pool{app.device, app.instance.surface};
+        planet::vk::device_memory_allocator texture_memory{
+                "planet_vk_bench_textures", app.device};
+        auto const textures =
+                create_textures(texture_memory, pool, config.textures, 64);
+        auto const screen = app.window.rectangle();
+
+        /// #### Sprites
+        {
+            planet::vk::engine::pipeline::sprite sprites{
+                    renderer, "planet-vk-engine/sprite.world.vert.spirv"};
+            co_await frames(renderer, "sprites", [&]() {
+                for (std::size_t index{}; index < config.sprites; ++index) {
+                    auto const at = cell(index, config.sprites, world_area);
+                    sprites.draw(
+                            textures[index % textures.size()],
+                            {.offset = at.top_left,
+                             .size = at.extents,
+                             .rotation = static_cast<float>(index)
+                                     / static_cast<float>(config.sprites)});
+                }
+                renderer.full_screen([&]() { renderer.render(sprites); });
+            });
+        }
+
+        /// #### Textured quads
+        /**
+         * Run writing the vertices straight into mapped memory, staging them
+         * in a CPU side vector first, and pulling the corners from one record
+         * per quad in the vertex shader. The staged vertices are written, read
+         * back and written again. The shared quad indices are 16 bit up to
+         * `max_narrow_quads` quads in a frame and 32 bit above that.
+         */
+        {
+            using textured_quad = planet::vk::engine::pipeline::textured_quad;
+            auto const index_bytes = textured_quad::indices_per_quad
+                    * (config.quads <= planet::vk::engine::quad_index_buffer::
+                                               max_narrow_quads
+                               ? sizeof(std::uint16_t)
+                               : sizeof(std::uint32_t));
+            auto const vertex_bytes = textured_quad::vertices_per_quad
+                    * sizeof(textured_quad::vertex_type);
+            struct textured_mode {
+                std::string_view name, vertex_shader;
+                bool write_through, vertex_pulling;
+                quad_bytes per_quad;
+            };
+            std::array const modes{
+                    textured_mode{
+                            "textured_quads",
+                            "planet-vk-engine/texture.screen.vert.spirv",
+                            true, false, {vertex_bytes, index_bytes}},
+                    textured_mode{
+                            "textured_quads_staged",
+                            "planet-vk-engine/texture.screen.vert.spirv",
+                            false, false, {3 * vertex_bytes, index_bytes}},
+                    textured_mode{
+                            "textured_quads_pulled",
+                            "planet-vk-engine/"
+                            "texture.instanced.screen.vert.spirv",
+                            true, true,
+                            {sizeof(textured_quad::instance_type)}}};
+            for (auto const &mode : modes) {
+                textured_quad quads{
+                        {.renderer = renderer,
+                         .vertex_shader{mode.vertex_shader},
+                         .write_through = mode.write_through,
+                         .vertex_pulling = mode.vertex_pulling}};
+                co_await frames(
+                        renderer, mode.name,
+                        [&]() {
+                            for (std::size_t index{}; index < config.quads;
+                                 ++index) {
+                                quads.draw(
+                                        textures[index % textures.size()],
+                                        cell(index, config.quads, screen));
+                            }
+                            renderer.full_screen(
+                                    [&]() { renderer.render(quads); });
+                        },
+                        mode.per_quad);
+            }
+        }
+
+        /// #### Mesh
+        {
+            std::vector<planet::vertex::coloured> vertices;
+            std::vector<std::uint32_t> indices;
+            vertices.reserve(3 * config.triangles);
+            indices.reserve(3 * config.triangles);
+            for (std::size_t index{}; index < config.triangles; ++index) {
+                auto const at = cell(index, config.triangles, world_area);
+                auto const x = at.top_left.x(), y = at.top_left.y();
+                auto const w = at.extents.width, h = at.extents.height;
+                auto const first = static_cast<std::uint32_t>(vertices.size());
+                vertices.push_back({{x, y, 0.0f}, {1.0f, 0.0f, 0.0f}});
+                vertices.push_back({{x + w, y, 0.0f}, {0.0f, 1.0f, 0.0f}});
+                vertices.push_back({{x, y + h, 0.0f}, {0.0f, 0.0f, 1.0f}});
+                indices.insert(indices.end(), {first, first + 1, first + 2});
+            }
+            planet::vk::engine::pipeline::mesh mesh{
+                    {.renderer = renderer,
+                     .vertex_shader{"planet-vk-engine/mesh.world.vert.spirv"}}};
+            co_await frames(renderer, "mesh", [&]() {
+                mesh.this_frame.draw(vertices, indices);
+                renderer.full_screen([&]() { renderer.render(mesh); });
+            });
+        }
+
+        /// #### Lines
+        {
+            std::vector<planet::vertex::coloured> vertices;
+            std::vector<std::uint32_t> indices;
+            vertices.reserve(2 * config.segments);
+            indices.reserve(2 * config.segments);
+            for (std::size_t index{}; index < config.segments; ++index) {
+                auto const at = cell(index, config.segments, world_area);
+                auto const x = at.top_left.x(), y = at.top_left.y();
+                auto const first = static_cast<std::uint32_t>(vertices.size());
+                vertices.push_back({{x, y, 0.0f}, {1.0f, 1.0f, 1.0f}});
+                vertices.push_back(
+                        {{x + at.extents.width, y + at.extents.height, 0.0f},
+                         {1.0f, 0.5f, 0.0f}});
+                indices.insert(indices.end(), {first, first + 1});
+            }
+            planet::vk::engine::pipeline::lines lines{{.renderer = renderer}};
+            co_await frames(renderer, "lines", [&]() {
+                lines.this_frame.draw(vertices, indices);
+                renderer.full_screen([&]() { renderer.render(lines); });
+            });
+        }
+
+        /// #### Allocator churn
+        {
+            planet::vk::device_memory_allocator churning{
+                    "planet_vk_bench_churn", app.device};
+            std::vector<planet::vk::device_memory> live(256);
+            measurement m{app.device};
+            for (std::size_t index{}; index < config.churn; ++index) {
+                VkMemoryRequirements const requirements{
+                        .size = 256u << (index % 9),
+                        .alignment = 256,
+                        .memoryTypeBits = ~std::uint32_t{}};
+                live[(index * 7) % live.size()] = churning.allocate(
+                        requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            }
+            live.clear();
+            m.record("allocator_churn", "allocations", config.churn);
+        }
+
+        /// #### Texture upload bursts
+        {
+            std::uint32_t const size = 128;
+            std::vector<std::vector<std::byte>> pixels(
+                    config.burst_size,
+                    std::vector<std::byte>(4 * size * size, std::byte{0x80}));
+            planet::vk::device_memory_allocator uploaded{
+                    "planet_vk_bench_uploads", app.device};
+            planet::vk::texture_batch batch{uploaded, pool};
+            measurement m{app.device};
+            for (std::size_t burst{}; burst < config.bursts; ++burst) {
+                for (auto const &p : pixels) {
+                    batch.add({.pixels = p, .width = size, .height = size});
+                }
+                batch.create();
+            }
+            m.record("texture_uploads", "bursts", config.bursts);
+        }
+
+        /// #### Texture batching maps
+        /**
+         * The `std::map` based `pooled_vector_map` against the
+         * `flat_pooled_vector_map` used by `textured_quad`, for 10, 100 and
+         * 1000 textures. This is CPU work only.
+         */
+        {
+            struct batching {
+                std::size_t textures;
+                std::string_view tree, flat;
+            };
+            constexpr std::array cases{
+                    batching{
+                            10, "texture_batching_map_10",
+                            "texture_batching_flat_10"},
+                    batching{
+                            100, "texture_batching_map_100",
+                            "texture_batching_flat_100"},
+                    batching{
+                            1000, "texture_batching_map_1000",
+                            "texture_batching_flat_1000"}};
+            using tree_type = planet::vk::engine::memory::pooled_vector_map<
+                    std::map<int const *, std::vector<float>>>;
+            using flat_type =
+                    planet::vk::engine::memory::flat_pooled_vector_map<
+                            int const *, std::vector<float>>;
+            for (auto const &c : cases) {
+                std::vector<int> const keys(c.textures);
+                measurement tree_m{app.device};
+                auto const tree = batch_by_texture<tree_type>(keys);
+                tree_m.record(c.tree, "iterations", config.frames);
+                measurement flat_m{app.device};
+                auto const flat = batch_by_texture<flat_type>(keys);
+                flat_m.record(c.flat, "iterations", config.frames);
+                if (tree != flat) {
+                    std::cerr << "The texture batching maps disagree\n";
+                    co_return EXIT_FAILURE;
+                }
+            }
+        }
+
+        /// #### Recording secondary command buffers
+        /**
+         * Records `pipelines` stand-in pipelines of `commands` dynamic state
+         * commands each, once on a single thread and once with a thread per
+         * core. Only the recording is measured, the buffers are never
+         * executed, so no shaders are needed.
+         */
+        {
+            std::vector<planet::vk::engine::secondary_recorder::job> const jobs(
+                    config.pipelines,
+                    [](planet::vk::command_buffer &cb) {
+                        VkViewport const viewport{
+                                0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+                        VkRect2D const scissor{{0, 0}, {1, 1}};
+                        for (std::size_t index{}; index < config.commands;
+                             ++index) {
+                            vkCmdSetViewport(cb.get(), 0, 1, &viewport);
+                            vkCmdSetScissor(cb.get(), 0, 1, &scissor);
+                        }
+                    });
+            VkCommandBufferInheritanceInfo const inheritance{
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                    .pNext = nullptr,
+                    .renderPass = renderer.scene_render_pass.get(),
+                    .subpass = 0,
+                    .framebuffer = renderer.scene_frame_buffers[0].get(),
+                    .occlusionQueryEnable = VK_FALSE,
+                    .queryFlags = {},
+                    .pipelineStatistics = {}};
+            auto const cores = std::max<std::size_t>(
+                    std::thread::hardware_concurrency(), 2);
+            for (std::size_t const threads : {std::size_t{1}, cores}) {
+                planet::vk::engine::secondary_recorder recorder{
+                        app.device, app.instance.surface, threads};
+                measurement m{app.device};
+                for (std::size_t frame{}; frame < config.frames; ++frame) {
+                    recorder.start(
+                            frame % planet::vk::engine::max_frames_in_flight,
+                            inheritance);
+                    recorder.record(jobs);
+                }
+                m.record(
+                        threads == 1 ? "secondary_recording"
+                                     : "secondary_recording_parallel",
+                        "iterations", config.frames);
+            }
+        }
+
+        /// #### Swap chain recreation
+        {
+            renderer.app.device.wait_idle();
+            measurement m{app.device};
+            for (std::size_t index{}; index < config.recreations; ++index) {
+                renderer.window_resized();
+                co_await renderer.start(planet::colour::black);
+                renderer.submit_and_present();
+            }
+            renderer.app.device.wait_idle();
+            m.record(
+                    "swap_chain_recreation", "recreations", config.recreations);
+        }
+
+        co_return 0;
+    }
+
+
+}
+
+
+/// ## Count heap allocations
+void *operator new(std::size_t const bytes) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto *const p = std::malloc(bytes ? bytes : 1)) {
+        return p;
+    } else {
+        throw std::bad_alloc{};
+    }
+}
+void operator delete(void *const p) noexcept { std::free(p); }
+void operator delete(void *const p, std::size_t) noexcept { std::free(p); }
+
+
+int main(int const argc, char const *argv[]) {
+    if (not parse(argc, argv)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    planet::log::active = planet::log::level::error;
+    /// No window is opened, so any display the machine has isn't needed
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+
+    planet::version const v{
+            "planet-vk-bench", "planet/planet-vk-bench", "0.1", 1};
+    felspar::posix::promise_to_never_use_select();
+    felspar::io::poll_warden warden{};
+    planet::sdl::init sdl{warden, v};
+    try {
+        planet::vk::engine::app app{
+                argc, argv, sdl, v,
+                planet::vk::engine::app::offscreen{
+                        {static_cast<float>(config.width),
+                         static_cast<float>(config.height)}}};
+        auto const result = app.run(benchmarks);
+        if (config.output == "-") {
+            write_json(std::cout, app);
+        } else {
+            std::ofstream file{config.output};
+            write_json(file, app);
+        }
+        return result;
+    } catch (planet::vk::headless_not_available const &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <planet/vk/buffer.hpp>
 #include <planet/vk/colour.hpp>
+#include <planet/vk/command_pools.hpp>
 #include <planet/vk/commands.hpp>
 #include <planet/vk/debug_messenger.hpp>
 #include <planet/vk/descriptors.hpp>
@@ -21,3 +22,5 @@
 #include <planet/vk/swap_chain.hpp>
 #include <planet/vk/synchronisation.hpp>
 #include <planet/vk/texture.hpp>
+#include <planet/vk/trace.hpp>
+#include <planet/vk/upload.hpp>
@@ -0,0 +1,126 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/vk/commands.hpp>
+
+#include <array>
+#include <deque>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
+
+
+namespace planet::vk {
+
+
+    /// ## Command pools for many threads and frames
+    /**
+     * Vulkan requires that a command pool, and every command buffer allocated
+     * from it, is only used by one thread at a time. This hands each thread
+     * its own pool for each frame in flight and each queue family, creating
+     * them the first time they're asked for.
+     *
+     * Command buffers are never freed individually. When the GPU has finished
+     * with a frame index `retire` resets every pool for it with a single
+     * `vkResetCommandPool`, and the buffers that were allocated from them are
+     * handed out again. After the first few frames no command buffers are
+     * allocated at all.
+     *
+     * `pool` and `allocate` can be called from any thread, but `retire` must
+     * not run at the same time as anything else is recording into buffers for
+     * the frame index being retired.
+     */
+    class command_pools final {
+      public:
+        command_pools(
+                vk::device &, vk::surface const &, std::size_t frames_in_flight);
+
+        command_pools(command_pools const &) = delete;
+        command_pools &operator=(command_pools const &) = delete;
+
+
+        /// ### The calling thread's pool
+        /**
+         * Command buffers allocated from the pool are submitted to the first
+         * queue in the family, but may be submitted to any queue in it.
+         */
+        vk::command_pool &pool(std::size_t frame_index, std::uint32_t family);
+        vk::command_pool &pool(std::size_t const frame_index) {
+            return pool(frame_index, graphics_family);
+        }
+
+        /// ### A command buffer for the calling thread
+        /**
+         * The buffer is in the initial state, ready for `begin`. It belongs to
+         * the `command_pools` and remains valid until the frame index is next
+         * retired.
+         */
+        command_buffer &allocate(
+                std::size_t frame_index,
+                std::uint32_t family,
+                VkCommandBufferLevel = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        command_buffer &allocate(
+                std::size_t const frame_index,
+                VkCommandBufferLevel const level =
+                        VK_COMMAND_BUFFER_LEVEL_PRIMARY) {
+            return allocate(frame_index, graphics_family, level);
+        }
+
+        /// ### Recycle everything used for a frame index
+        /**
+         * The GPU must have finished executing every command buffer allocated
+         * for the frame index.
+         */
+        void retire(std::size_t frame_index);
+
+
+        /// ### Queries
+        std::size_t frames_in_flight() const noexcept { return frames; }
+        std::uint32_t graphics_queue_family() const noexcept {
+            return graphics_family;
+        }
+        /// #### Number of pools created so far
+        std::size_t size() const;
+
+
+        /// ### Telemetry
+
+        /// #### Command pools created
+        telemetry::counter c_pools{"planet_vk_command_pools_created"};
+        /// #### Command buffers allocated
+        /**
+         * Only bumped when a thread records more buffers for a frame than it
+         * has done before.
+         */
+        telemetry::counter c_allocated{"planet_vk_command_pools_allocated"};
+        /// #### Pools reset by `retire`
+        telemetry::counter c_resets{"planet_vk_command_pools_reset"};
+
+
+      private:
+        device_view device;
+        std::size_t frames;
+        std::uint32_t graphics_family;
+
+        struct entry {
+            vk::command_pool pool;
+            /// Indexed by `VkCommandBufferLevel`
+            std::array<std::deque<command_buffer>, 2> buffers = {};
+            std::array<std::size_t, 2> used = {};
+        };
+        using key = std::tuple<std::size_t, std::uint32_t, std::thread::id>;
+        /**
+         * Entries are never removed, so once a thread has found its entry it
+         * can use it without holding the lock.
+         */
+        mutable std::shared_mutex mutex;
+        std::map<key, std::unique_ptr<entry>> entries;
+
+        entry &lookup(std::size_t frame_index, std::uint32_t family);
+    };
+
+
+}
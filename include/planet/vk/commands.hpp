@@ -4,8 +4,10 @@
 #include <planet/vk/forward.hpp>
 #include <planet/vk/owned_handle.hpp>
 #include <planet/vk/queue.hpp>
+#include <planet/vk/synchronisation.hpp>
 #include <planet/vk/view.hpp>
 
+#include <memory>
 #include <source_location>
 #include <span>
 #include <vector>
@@ -21,20 +23,25 @@ namespace planet::vk {
     }
 
 
+    class submission;
+
+
     /// ## Command buffer
     class command_buffer final {
         friend class command_buffers;
+        friend class command_pools;
         /// These instances are owned by the command_buffers type
         VkCommandBuffer handle;
         VkQueue queue;
 
         /**
          * The command buffer can be either a one-off used for a particular
-         * purpose, or it can be owned by the `command_buffers` structure. This
-         * flags tells the destructor which is which.
+         * purpose, or it can be owned by the `command_buffers` or
+         * `command_pools` structures. This flags tells the destructor which is
+         * which.
          */
         bool self_owned = false;
-        /// Used when the `command_buffers` instance owns the handles
+        /// Used when something else owns the handles
         command_buffer(vk::command_pool &, VkCommandBuffer);
 
 
@@ -68,6 +75,13 @@ namespace planet::vk {
          * it also waits for the queue to become idle again.
          */
         void end_and_submit();
+        /// #### End and submit without waiting
+        /**
+         * The command buffer is moved into the returned `submission`, which
+         * can be polled or waited on. Only the commands in this buffer are
+         * waited for, not the whole queue.
+         */
+        [[nodiscard]] submission end_and_submit_async() &&;
 
 
         /// ### API wrappers
@@ -86,6 +100,11 @@ namespace planet::vk {
 
         /// #### `vkBeginCommandBuffer`
         void begin(VkCommandBufferUsageFlags = {});
+        /// ##### Begin a secondary command buffer
+        /// The inheritance describes where the buffer will be executed
+        void begin(
+                VkCommandBufferUsageFlags,
+                VkCommandBufferInheritanceInfo const &);
         /// #### `vkEndCommandBuffer`
         void end();
 
@@ -95,7 +114,7 @@ namespace planet::vk {
          * `command_pool`, or the graphics queue if the `command_pool` is given
          * a surface.
          */
-        void submit();
+        void submit(VkFence = VK_NULL_HANDLE);
 
 
       private:
@@ -103,6 +122,50 @@ namespace planet::vk {
     };
 
 
+    /// ## A submitted command buffer
+    /**
+     * Keeps the command buffer, and anything else handed to `keep_alive`
+     * (typically staging buffers), alive until the GPU has finished with
+     * them. Completion is signalled through a fence which can be polled with
+     * `is_complete`, waited on with `wait`, or handed to something that can
+     * wait without blocking, like `engine::gpu_completion`.
+     *
+     * Destroying a submission that hasn't completed waits for it first, so the
+     * resources it holds are never freed while the GPU is still using them.
+     */
+    class submission final {
+        friend class command_buffer;
+        submission(command_buffer);
+
+        command_buffer commands;
+        std::unique_ptr<vk::fence> done;
+        std::vector<std::shared_ptr<void const>> held;
+
+
+      public:
+        submission() {}
+        submission(submission &&) = default;
+        submission &operator=(submission &&);
+        ~submission();
+
+
+        /// ### Hold on to a resource until the GPU is done
+        template<typename T>
+        submission &keep_alive(T &&t) {
+            held.push_back(std::make_shared<std::remove_cvref_t<T> const>(
+                    std::forward<T>(t)));
+            return *this;
+        }
+
+
+        /// ### Completion
+        vk::fence const &fence() const noexcept { return *done; }
+        bool is_complete() const;
+        /// #### Block until the GPU has finished and release the resources
+        void wait();
+    };
+
+
     /// ## Command buffers
     class command_buffers final {
         std::vector<VkCommandBuffer> handles;
@@ -144,11 +207,25 @@ namespace planet::vk {
         using handle_type = device_handle<VkCommandPool, vkDestroyCommandPool>;
         handle_type handle;
         vk::queue queue;
+        VkQueue family_queue = VK_NULL_HANDLE;
 
 
       public:
         command_pool(vk::device &, vk::surface const &);
         command_pool(vk::device &, vk::queue);
+        /// ### Pool for any queue family
+        /**
+         * Command buffers from the pool are submitted to the given queue,
+         * which must belong to the family. Pools whose buffers are only ever
+         * recycled by resetting the whole pool don't need
+         * `VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT`.
+         */
+        command_pool(
+                vk::device &,
+                std::uint32_t queue_family_index,
+                VkQueue,
+                VkCommandPoolCreateFlags =
+                        VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 
 
         device_view device;
@@ -1,11 +1,15 @@
 #pragma once
 
 
+#include <planet/telemetry/counter.hpp>
+#include <planet/telemetry/minmax.hpp>
 #include <planet/vk/owned_handle.hpp>
 #include <planet/vk/view.hpp>
 
 #include <source_location>
 #include <span>
+#include <string>
+#include <vector>
 
 
 namespace planet::vk {
@@ -25,7 +29,8 @@ namespace planet::vk {
         descriptor_pool(
                 vk::device &,
                 std::span<VkDescriptorPoolSize const>,
-                std::uint32_t max_sets);
+                std::uint32_t max_sets,
+                VkDescriptorPoolCreateFlags = {});
         /// ### Create a pool for a single type with the requested size
         descriptor_pool(vk::device &, VkDescriptorType, std::uint32_t count);
 
@@ -124,4 +129,102 @@ namespace planet::vk {
     };
 
 
+    /// ## Growable descriptor set allocator
+    /**
+     * Allocates descriptor sets from a chain of pools. When the current pool
+     * runs out another is used, and a new one twice the size of the last is
+     * created if needed, so there is no fixed cap on the number of sets.
+     *
+     * `reset` hands every set back by calling `vkResetDescriptorPool` on
+     * each pool in the chain. The pools are kept, so once a frame index has
+     * grown to the size it needs no further pools are created.
+     */
+    class descriptor_allocator final {
+      public:
+        descriptor_allocator(
+                std::string_view name,
+                vk::device &,
+                VkDescriptorType,
+                std::uint32_t initial_sets,
+                std::uint32_t descriptors_per_set = 1);
+
+
+        /// ### Allocate a set
+        VkDescriptorSet allocate(
+                descriptor_set_layout const &,
+                std::source_location const & = std::source_location::current());
+
+        /// ### Return all sets to their pools
+        /**
+         * None of the sets may be in use by the GPU or bound in a command
+         * buffer that is still to be submitted.
+         */
+        void reset();
+
+
+        /// ### Queries
+        std::size_t pool_count() const noexcept { return pools.size(); }
+        std::size_t allocated() const noexcept { return in_use; }
+
+
+      private:
+        device_view device;
+        VkDescriptorType type;
+        std::uint32_t descriptors_per_set;
+
+        struct pool_details {
+            descriptor_pool pool;
+            std::uint32_t capacity;
+        };
+        std::vector<pool_details> pools;
+        /// Pool currently being allocated from
+        std::size_t current = {};
+        /// Sets allocated since the last reset
+        std::size_t in_use = {};
+
+        void add_pool(std::uint32_t capacity);
+
+
+        /// ### Telemetry
+
+        /// #### Pools created
+        telemetry::counter c_pools_created;
+        /// #### Peak sets allocated between resets
+        telemetry::max c_sets_peak;
+    };
+
+
+    /// ## Batched descriptor writes
+    /**
+     * Collects descriptor writes so that they can all be handed to the driver
+     * in a single `vkUpdateDescriptorSets` call. The storage is kept between
+     * flushes, so once it has grown to the size of a typical frame there are
+     * no further allocations.
+     *
+     * A set must not be updated after it has been bound in a command buffer
+     * that is still being recorded (unless it was created for update after
+     * bind), so flush before recording the binds.
+     */
+    class descriptor_writes final {
+        std::vector<VkWriteDescriptorSet> writes;
+        std::vector<VkDescriptorImageInfo> images;
+
+      public:
+        /// ### Queue a write of an image descriptor
+        void
+                write(VkDescriptorSet,
+                      std::uint32_t binding,
+                      VkDescriptorType,
+                      VkDescriptorImageInfo const &);
+
+        /// ### Send all queued writes to the driver
+        void flush(vk::device const &);
+
+
+        /// ### Queries
+        std::size_t size() const noexcept { return writes.size(); }
+        bool empty() const noexcept { return writes.empty(); }
+    };
+
+
 }
@@ -4,14 +4,34 @@
 #include <planet/vk/forward.hpp>
 #include <planet/vk/memory.hpp>
 #include <planet/vk/memory_block_pool.hpp>
+#include <planet/vk/pipeline_cache.hpp>
 #include <planet/vk/queue.hpp>
+#include <planet/vk/shader_module.hpp>
 
 #include <mutex>
+#include <vector>
 
 
 namespace planet::vk {
 
 
+    /// ## Texture observer
+    /**
+     * Caches keyed on a texture's Vulkan handles register one of these with
+     * the device. The driver is free to hand out the same handle values again
+     * once a texture has been destroyed, so the cache must drop them when it
+     * is told.
+     */
+    class texture_observer {
+      public:
+        /// Called from whichever thread destroys the texture
+        virtual void forget(VkImageView, VkSampler) = 0;
+
+      protected:
+        ~texture_observer() = default;
+    };
+
+
     /// ## Vulkan device
     /// The logical graphics device we're using
     class device final {
@@ -25,6 +45,9 @@ namespace planet::vk {
                 {};
         void return_transfer_queue(VkQueue, std::uint32_t);
 
+        std::mutex texture_observers_mutex;
+        std::vector<texture_observer *> texture_observers;
+
 
       public:
         device(vk::instance const &, extensions const &);
@@ -45,6 +68,29 @@ namespace planet::vk {
         VkQueue graphics_queue = VK_NULL_HANDLE, present_queue = VK_NULL_HANDLE;
 
 
+        /// ### Optional features that have been enabled
+
+        /// #### Bindless textures
+        /**
+         * Set when the GPU supports it, in which case
+         * `VK_EXT_descriptor_indexing` has been enabled along with the features
+         * listed in `physical_device::supports_bindless_textures`.
+         */
+        bool bindless_textures = false;
+
+
+        /// ### Pipeline cache
+        /**
+         * Used for all pipeline creation. It starts out empty, call
+         * `pipeline_cache.load` before creating pipelines to reuse the work
+         * done in an earlier run.
+         */
+        vk::pipeline_cache pipeline_cache{*this};
+
+        /// ### Shader modules shared between pipelines
+        vk::shader_modules shader_modules{*this};
+
+
         /// ### Fetch a transfer queue
         /// If there is no transfer queue left then it will return an empty
         /// `vk::queue`
@@ -55,6 +101,14 @@ namespace planet::vk {
         void wait_idle() const;
 
 
+        /// ### Texture lifetimes
+        /// #### Register and remove caches of texture handles
+        void observe_textures(texture_observer &);
+        void stop_observing_textures(texture_observer &);
+        /// #### Tell the observers that a texture is being destroyed
+        void texture_destroyed(VkImageView, VkSampler);
+
+
         /// ### Allocators
 
         /// #### Shared pool of whole driver memory blocks
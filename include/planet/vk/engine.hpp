@@ -3,12 +3,19 @@
 
 #include <planet/vk/engine/app.hpp>
 #include <planet/vk/engine/autodelete.hpp>
+#include <planet/vk/engine/bindless_textures.hpp>
 #include <planet/vk/engine/blank.hpp>
 #include <planet/vk/engine/colour_attachment.hpp>
 #include <planet/vk/engine/depth_buffer.hpp>
 #include <planet/vk/engine/forward.hpp>
+#include <planet/vk/engine/gpu_completion.hpp>
+#include <planet/vk/engine/gpu_profiler.hpp>
+#include <planet/vk/engine/pipeline_builder.hpp>
+#include <planet/vk/engine/quad_index_buffer.hpp>
 #include <planet/vk/engine/render_parameters.hpp>
 #include <planet/vk/engine/renderer.hpp>
+#include <planet/vk/engine/secondary_recorder.hpp>
+#include <planet/vk/engine/pipeline/instanced_sprite.hpp>
 #include <planet/vk/engine/pipeline/lines.hpp>
 #include <planet/vk/engine/pipeline/mesh.hpp>
 #include <planet/vk/engine/pipeline/sprite.hpp>
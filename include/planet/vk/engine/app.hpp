@@ -5,6 +5,8 @@
 #include <planet/vk-sdl.hpp>
 #include <planet/vk/engine/forward.hpp>
 
+#include <filesystem>
+
 
 namespace planet::vk::engine {
 
@@ -18,6 +20,27 @@ namespace planet::vk::engine {
     struct app final {
         app(int argc, char const *argv[], planet::sdl::init &, version const &);
 
+        /// ### Off-screen application
+        /**
+         * No window is opened. The device is created for a
+         * `VK_EXT_headless_surface` surface and the renderer draws into images
+         * of its own at the fixed size, so the same pipelines and
+         * post-processing can be run for benchmarks and tests on machines
+         * without a display or GPU (for example with lavapipe). Throws
+         * `headless_not_available` when the extension is missing.
+         */
+        struct offscreen {
+            affine::extents2d extents = {1280, 720};
+        };
+        app(int argc,
+            char const *argv[],
+            planet::sdl::init &,
+            version const &,
+            offscreen);
+
+        /// Saves the pipeline cache
+        ~app();
+
 
         planet::asset_manager asset_manager;
         planet::sdl::init &sdl;
@@ -27,6 +50,13 @@ namespace planet::vk::engine {
         vk::instance instance;
         vk::device device{instance, extensions};
 
+        /// ### Where the pipeline cache is kept between runs
+        /**
+         * Inside the per-user data directory SDL gives the application. Empty
+         * if there isn't one, in which case the cache is not persisted.
+         */
+        std::filesystem::path pipeline_cache_filename;
+
         planet::ui::baseplate baseplate;
 
 
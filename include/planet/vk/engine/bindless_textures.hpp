@@ -0,0 +1,127 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/telemetry/id.hpp>
+#include <planet/vk/descriptors.hpp>
+#include <planet/vk/device.hpp>
+#include <planet/vk/engine/forward.hpp>
+#include <planet/vk/texture.hpp>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+
+namespace planet::vk::engine {
+
+
+    /// ## Bindless texture table
+    /**
+     * A single descriptor set holding a large, partially bound array of
+     * combined image samplers. A texture is written into a slot the first time
+     * it is drawn and after that pipelines only need to tell the shader which
+     * slot to sample from, so the set is bound once per pipeline per frame and
+     * there are no descriptor writes for textures that are already present.
+     *
+     * Needs `vk::device::bindless_textures`. The renderer owns one of these
+     * when the device supports it and advances its frame counter as each frame
+     * starts.
+     *
+     * Slots are keyed on the texture's image view and sampler. The table
+     * watches the device for textures being destroyed and drops their keys,
+     * so a new texture that the driver gives the same handles to is written
+     * into the table again. Once the table is full, slots that have not been
+     * used for a full render cycle are handed out again. Those can't be
+     * referenced by any command buffer that is still executing.
+     *
+     * Slot look ups and frame changes take a lock, so pipelines being recorded
+     * on several threads can share the table.
+     */
+    class bindless_textures final :
+    private telemetry::id,
+    private vk::texture_observer {
+      public:
+        bindless_textures(
+                std::string_view name,
+                vk::device &,
+                std::uint32_t capacity = 4096,
+                id::suffix = id::suffix::suppress);
+        ~bindless_textures();
+
+        bindless_textures(bindless_textures const &) = delete;
+        bindless_textures &operator=(bindless_textures const &) = delete;
+
+
+        /// ### Number of slots in the table
+        /// Clamped to the device's update after bind limits
+        std::uint32_t const capacity;
+
+
+        /// ### Vulkan set up
+        vk::descriptor_set_layout layout;
+        vk::descriptor_pool pool;
+        VkDescriptorSet set() const noexcept { return sets[0]; }
+
+
+        /// ### Slot a texture has been written into
+        /**
+         * Writes the texture into a slot if it isn't in the table yet. If
+         * every slot may still be in use by a frame in flight then a
+         * `felspar::stdexcept::runtime_error` is thrown, as drawing with any
+         * other slot would sample the wrong texture.
+         */
+        std::uint32_t slot_for(VkImageView, VkSampler);
+        std::uint32_t slot_for(vk::texture const &t) {
+            return slot_for(t.image_view.get(), t.sampler.get());
+        }
+
+        /// ### Drop a texture from the table
+        /**
+         * Called by the device as textures are destroyed. The slot is handed
+         * out again once the frames that may have drawn with it are done.
+         */
+        void forget(VkImageView, VkSampler) override;
+
+
+        /// ### Start the next frame
+        void next_frame() noexcept;
+
+
+        /// ### Queries
+        std::size_t size() const noexcept;
+
+
+        /// ### Telemetry
+
+        /// #### Textures written into the table
+        telemetry::counter c_writes{name() + "__writes"};
+        /// #### Slots handed out again after going unused
+        telemetry::counter c_recycled{name() + "__recycled"};
+        /// #### Lookups that found no slot at all
+        telemetry::counter c_full{name() + "__full"};
+        /// #### Textures dropped because they were destroyed
+        telemetry::counter c_forgotten{name() + "__forgotten"};
+
+
+      private:
+        vk::device &device;
+        vk::descriptor_sets sets;
+
+        mutable std::mutex mutex;
+        std::uint64_t frame = {};
+
+        /// Forgotten slots have a null image view and sampler
+        struct slot {
+            VkImageView image_view;
+            VkSampler sampler;
+            std::uint64_t last_used;
+        };
+        std::vector<slot> slots;
+        std::map<std::pair<VkImageView, VkSampler>, std::uint32_t> lookup;
+
+        void write(std::uint32_t index, VkImageView, VkSampler);
+    };
+
+
+}
@@ -15,16 +15,23 @@ namespace planet::vk::engine {
 
 
     struct app;
+    class bindless_textures;
     struct colour_attachment;
     struct depth_buffer;
+    class gpu_completion;
+    class gpu_profiler;
     struct graphics_pipeline_parameters;
+    class pipeline_builder;
+    class quad_index_buffer;
     struct render_parameters;
     class renderer;
+    class secondary_recorder;
 
 
     namespace pipeline {
 
 
+        class instanced_sprite;
         class lines;
         class mesh;
         class postprocess;
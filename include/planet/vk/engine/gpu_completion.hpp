@@ -0,0 +1,147 @@
+#pragma once
+
+
+#include <planet/vk/commands.hpp>
+#include <planet/vk/engine/forward.hpp>
+#include <planet/vk/synchronisation.hpp>
+#include <planet/vk/upload.hpp>
+
+#include <felspar/coro/eager.hpp>
+#include <felspar/coro/task.hpp>
+
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+
+namespace planet::vk::engine {
+
+
+    /// ## Wait for the GPU without blocking the event loop
+    /**
+     * Blocking Vulkan calls, like waiting on a fence or acquiring the next
+     * swap chain image, are run on a helper thread. The coroutine that asked
+     * for the wait is suspended on the SDL event loop and resumed as soon as
+     * the call returns, rather than on the next tick of a polling sleep, so
+     * other coroutines carry on running in the meantime.
+     *
+     * On POSIX the helper wakes the event loop through a pipe. Elsewhere the
+     * finished waits are checked for every millisecond.
+     *
+     * Any number of coroutines can be waiting at once. Each wait keeps its
+     * own state in the awaiting coroutine's frame, so waiting doesn't
+     * allocate, and the calls are run on the helper thread one after the
+     * other in the order they were awaited.
+     */
+    class gpu_completion final {
+      public:
+        explicit gpu_completion(engine::app &);
+        ~gpu_completion();
+
+        gpu_completion(gpu_completion const &) = delete;
+        gpu_completion &operator=(gpu_completion const &) = delete;
+
+
+        using duration = std::chrono::steady_clock::duration;
+
+
+        /// ### A single wait
+        /**
+         * Awaiting it returns how long the call took, and anything the call
+         * throws is thrown again from there. Destroying a wait that is
+         * running on the helper thread blocks until the call has returned.
+         */
+        class waiter {
+            friend class gpu_completion;
+
+            gpu_completion &owner;
+            bool const ready;
+            enum class state { idle, queued, running, finished } status = {};
+            waiter *next = nullptr;
+            std::coroutine_handle<> continuation;
+            std::exception_ptr failed;
+            std::chrono::steady_clock::time_point started;
+
+            virtual void call() = 0;
+
+
+          protected:
+            waiter(gpu_completion &g, bool const done)
+            : owner{g}, ready{done} {}
+            ~waiter();
+
+
+          public:
+            waiter(waiter const &) = delete;
+            waiter &operator=(waiter const &) = delete;
+
+            bool await_ready() const noexcept { return ready; }
+            void await_suspend(std::coroutine_handle<>);
+            duration await_resume();
+        };
+
+
+        /// ### Run a blocking call on the helper thread
+        template<typename Call>
+        class call_waiter final : public waiter {
+            friend class gpu_completion;
+            Call function;
+            call_waiter(gpu_completion &g, Call c)
+            : waiter{g, false}, function{std::move(c)} {}
+            void call() override { function(); }
+        };
+        template<std::invocable<> Call>
+        call_waiter<Call> run(Call c) {
+            return {*this, std::move(c)};
+        }
+
+        /// ### Wait for a fence to be signalled
+        /**
+         * Returns straight away, with a zero duration, if it already is. Throws
+         * if the wait fails, or if this is destroyed while it is waiting.
+         */
+        class fence_waiter final : public waiter {
+            friend class gpu_completion;
+            vk::fence const &fence;
+            fence_waiter(gpu_completion &, vk::fence const &);
+            void call() override;
+        };
+        fence_waiter wait(vk::fence const &);
+        /// ### Wait for a submission and release what it holds
+        felspar::coro::task<duration> wait(vk::submission &);
+        /// ### Wait for a batch of uploads to arrive
+        felspar::coro::task<duration> wait(vk::upload_engine::ticket);
+
+
+      private:
+        engine::app &app;
+
+        /// #### Intrusive list of waits
+        struct waiters {
+            waiter *front = nullptr, *back = nullptr;
+            void push(waiter *) noexcept;
+            waiter *pop() noexcept;
+            void erase(waiter *) noexcept;
+        };
+
+        std::mutex mutex;
+        /// Notified when a wait is queued, finished or when stopping
+        std::condition_variable signal;
+        bool stopping = false;
+        waiters queued, finished;
+#ifndef _WIN32
+        /// Written to by the helper thread when a call has returned
+        int wake_read = -1, wake_write = -1;
+#endif
+        std::thread helper;
+        /// Resumes the finished waits on the event loop
+        felspar::coro::eager<> dispatcher;
+
+        void work();
+        felspar::coro::task<void> dispatch();
+    };
+}
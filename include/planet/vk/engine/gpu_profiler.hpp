@@ -0,0 +1,202 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/telemetry/id.hpp>
+#include <planet/telemetry/map.hpp>
+#include <planet/telemetry/minmax.hpp>
+#include <planet/vk/commands.hpp>
+#include <planet/vk/engine/forward.hpp>
+#include <planet/vk/owned_handle.hpp>
+#include <planet/vk/trace.hpp>
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace planet::vk::engine {
+
+
+    /// ## GPU timestamp profiler
+    /**
+     * Measures how long named scopes take to execute on the GPU by writing a
+     * `vkCmdWriteTimestamp` at each end of the scope. Each frame in flight has
+     * its own query pool, which is read back in `start` the next time its
+     * frame index comes around. The renderer only calls `start` after the
+     * frame's fence has signalled, and the results are fetched without
+     * `VK_QUERY_RESULT_WAIT_BIT`, so reading them never stalls.
+     *
+     * For each scope name the profiler publishes the total and peak time in
+     * microseconds along with a histogram of frame timings in power of two
+     * microsecond buckets. The telemetry names are the scope name appended to
+     * the profiler's own name.
+     *
+     * When a `trace::session` is running each timed scope is also sent to the
+     * trace on its GPU timeline. The GPU's clock is lined up with the CPU's by
+     * `calibrate`, which is done the first time it is needed.
+     *
+     * On hardware whose graphics queue doesn't support timestamps the
+     * profiler does nothing.
+     *
+     * Scopes may be recorded from several threads at once, so long as each
+     * command buffer is only used by one of them, which means that pipelines
+     * recorded into secondary command buffers can be timed too.
+     */
+    class gpu_profiler final : private telemetry::id {
+      public:
+        /// ### Configuration
+        struct configuration {
+            /// #### Maximum number of scopes in a single frame
+            /**
+             * Scopes opened once this many have been used in a frame aren't
+             * timed, and are counted in `c_dropped`.
+             */
+            std::uint32_t scopes_per_frame = 128;
+        };
+
+
+        gpu_profiler(
+                std::string_view name,
+                vk::device &,
+                configuration const & = {},
+                id::suffix = id::suffix::suppress);
+
+        gpu_profiler(gpu_profiler const &) = delete;
+        gpu_profiler &operator=(gpu_profiler const &) = delete;
+
+
+        /// ### Timing a scope
+        /**
+         * Writes the end timestamp when `end` is called or the `marker` is
+         * destroyed. The command buffer must still be recording at that point.
+         */
+        class marker final {
+            friend class gpu_profiler;
+            VkQueryPool pool = VK_NULL_HANDLE;
+            VkCommandBuffer commands = VK_NULL_HANDLE;
+            std::uint32_t query = {};
+
+            marker(VkQueryPool p, VkCommandBuffer cb, std::uint32_t q)
+            : pool{p}, commands{cb}, query{q} {}
+
+
+          public:
+            /// An empty marker doesn't time anything
+            marker() {}
+            marker(marker const &) = delete;
+            marker(marker &&m)
+            : pool{std::exchange(m.pool, VK_NULL_HANDLE)},
+              commands{m.commands},
+              query{m.query} {}
+            ~marker() { end(); }
+
+            marker &operator=(marker const &) = delete;
+            marker &operator=(marker &&m) {
+                end();
+                pool = std::exchange(m.pool, VK_NULL_HANDLE);
+                commands = m.commands;
+                query = m.query;
+                return *this;
+            }
+
+            void end() {
+                if (pool) {
+                    vkCmdWriteTimestamp(
+                            commands, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            std::exchange(pool, VK_NULL_HANDLE), query + 1);
+                }
+            }
+        };
+        /// #### Open a named scope
+        [[nodiscard]] marker scope(command_buffer &, std::string_view name);
+
+
+        /// ### Start a frame
+        /**
+         * Publishes the timings recorded the last time this frame index was
+         * used and resets its queries. Must be recorded outside of a render
+         * pass, before any scopes for the frame, and only once the GPU has
+         * finished with the frame index.
+         */
+        void start(std::size_t frame_index, command_buffer &);
+
+
+        /// ### Line the GPU clock up with `trace::clock`
+        /**
+         * Submits a timestamp on its own and waits for it. Timestamps drift
+         * apart over time, so this can be called again every so often when
+         * tracing for a long time.
+         */
+        void calibrate();
+
+
+        /// ### Queries
+        bool enabled() const noexcept { return period_ns > 0.0; }
+        /// #### The most recent GPU time taken by a scope
+        /**
+         * Zero if the scope hasn't been timed yet.
+         */
+        std::chrono::nanoseconds latest(std::string_view name) const;
+
+
+        /// ### Telemetry
+
+        /// #### Frames whose timings were published
+        telemetry::counter c_frames{name() + "__frames"};
+        /// #### Scopes that couldn't be timed
+        /**
+         * Either the frame ran out of queries or the results weren't yet
+         * available when the frame index came back around.
+         */
+        telemetry::counter c_dropped{name() + "__dropped"};
+
+
+      private:
+        device_view device;
+        configuration config;
+        /// Nanoseconds per timestamp tick, or zero when unsupported
+        double period_ns = {};
+        std::uint64_t valid_mask = {};
+
+        /// #### Timings for one scope name
+        struct scope_timings {
+            scope_timings(std::string const &);
+
+            char const *trace_name;
+            std::chrono::nanoseconds latest = {};
+            telemetry::counter c_us, c_count;
+            telemetry::max c_peak_us;
+            telemetry::map<std::size_t, std::size_t> c_histogram;
+        };
+        mutable std::mutex mutex;
+        std::map<std::string, std::unique_ptr<scope_timings>, std::less<>>
+                scopes;
+
+        /// #### Queries used by a frame
+        struct frame {
+            using handle_type = device_handle<VkQueryPool, vkDestroyQueryPool>;
+            handle_type pool;
+            /// One entry per scope, the queries are `2n` and `2n + 1`
+            std::vector<scope_timings *> timed = {};
+        };
+        std::array<frame, max_frames_in_flight> frames;
+        std::size_t frame_index = {};
+        std::vector<std::array<std::uint64_t, 2>> results;
+
+        /// #### A GPU timestamp taken at a known CPU time
+        bool calibrated = false;
+        std::uint64_t gpu_anchor = {};
+        trace::clock::time_point cpu_anchor = {};
+
+        void publish(frame &);
+    };
+
+
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/telemetry/id.hpp>
+#include <planet/telemetry/minmax.hpp>
+#include <planet/vk/buffer.hpp>
+#include <planet/vk/engine/forward.hpp>
+
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <vector>
+
+
+namespace planet::vk::engine::memory {
+
+
+    /// ## Persistently mapped per-frame upload ring
+    /**
+     * Memory for data that only lives for a single frame (vertices, indices,
+     * per-instance data etc.). Each frame in flight has its own partition made
+     * up of one or more host coherent chunks, each of which is a `VkBuffer`
+     * that is mapped once when it is created and stays mapped for its whole
+     * life.
+     *
+     * Allocation is a bump of the partition's offset, and the partition is
+     * reset in constant time once the GPU has finished with that frame index.
+     * A frame that needs more than the chunks it already has gets another
+     * chunk, which is then kept for later frames, so after the first few
+     * frames no Vulkan objects are created at all.
+     *
+     * The renderer owns one of these and resets the partition for a frame
+     * index at the same time as it signals `next_frame_prestart`.
+     *
+     * Allocation takes a lock so that pipelines being recorded on several
+     * threads (see `renderer::record_secondary`) can share the ring.
+     */
+    class frame_ring final : private telemetry::id {
+      public:
+        /// ### Configuration
+        struct configuration {
+            /// #### Size of each chunk
+            /**
+             * Requests larger than this get a chunk of their own size.
+             */
+            std::size_t chunk_size = 4u << 20;
+            /// #### Usages the chunk buffers are created with
+            VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+                    | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+                    | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        };
+
+
+        frame_ring(
+                std::string_view name,
+                vk::device &,
+                configuration const & = {},
+                id::suffix = id::suffix::suppress);
+
+
+        /// ### A span of mapped GPU memory
+        /**
+         * The `buffer` and `offset` are what is needed to bind the memory, and
+         * `data` is where the CPU writes to it.
+         */
+        template<typename T>
+        struct span {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = {};
+            std::span<T> data = {};
+
+            std::size_t size() const noexcept { return data.size(); }
+            std::size_t byte_count() const noexcept {
+                return data.size_bytes();
+            }
+        };
+
+
+        /// ### Allocate memory for the frame
+        span<std::byte> allocate(
+                std::size_t frame_index,
+                std::size_t bytes,
+                std::size_t alignment);
+        template<typename T>
+        span<T> allocate(
+                std::size_t const frame_index, std::size_t const count) {
+            auto const bytes =
+                    allocate(frame_index, count * sizeof(T), alignof(T));
+            return {bytes.buffer, bytes.offset,
+                    {reinterpret_cast<T *>(bytes.data.data()), count}};
+        }
+
+        /// #### Allocate and copy the items into GPU memory
+        template<typename T>
+        span<T> upload(
+                std::size_t const frame_index, std::span<T const> const items) {
+            auto memory = allocate<T>(frame_index, items.size());
+            if (not items.empty()) {
+                std::memcpy(
+                        memory.data.data(), items.data(), items.size_bytes());
+            }
+            return memory;
+        }
+        template<typename T>
+        span<T> upload(
+                std::size_t const frame_index, std::vector<T> const &items) {
+            return upload(frame_index, std::span<T const>{items});
+        }
+
+
+        /// #### Upload indices at the narrowest width that fits
+        /**
+         * When every index addresses one of fewer than 65,537 vertices the
+         * indices are narrowed to `std::uint16_t` as they are written into
+         * mapped memory, halving the bytes uploaded. Bind the result with
+         * the returned `type`.
+         */
+        struct index_span {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = {};
+            VkIndexType type = VK_INDEX_TYPE_UINT32;
+        };
+        static constexpr std::size_t max_narrow_vertices = 1u << 16;
+        index_span upload_indices(
+                std::size_t frame_index,
+                std::span<std::uint32_t const> indices,
+                std::size_t vertex_count);
+
+
+        /// ### Release all of a frame's memory
+        /**
+         * Only call this once the GPU has finished with the frame index.
+         */
+        void reset(std::size_t frame_index) noexcept;
+
+
+        /// ### Queries
+        std::size_t bytes_used(std::size_t const frame_index) const noexcept {
+            return partitions[frame_index].used;
+        }
+
+
+      private:
+        configuration config;
+        device_memory_allocator allocator;
+        std::mutex mutex;
+
+
+        struct chunk {
+            buffer<std::byte> memory;
+            device_memory::mapping mapping;
+        };
+        struct partition {
+            std::vector<chunk> chunks;
+            /// Index of the chunk allocations are coming from
+            std::size_t current = {};
+            /// Offset within the current chunk
+            std::size_t offset = {};
+            /// Total bytes handed out this frame
+            std::size_t used = {};
+        };
+        std::array<partition, max_frames_in_flight> partitions;
+
+
+        /// ### Telemetry
+
+        /// #### Chunks created
+        telemetry::counter c_chunks_created{name() + "__chunks_created"};
+        /**
+         * Only ever bumped during warm up and when a frame needs more memory
+         * than any frame before it.
+         */
+
+        /// #### Number of allocations made
+        telemetry::counter c_allocations{name() + "__allocations"};
+
+        /// #### Peak bytes used by a single frame
+        telemetry::max c_frame_bytes_peak{name() + "__frame_bytes_peak"};
+    };
+
+
+}
@@ -1,8 +1,13 @@
 #pragma once
 
 
-#include <felspar/coro/generator.hpp>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <map>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -10,6 +15,80 @@
 namespace planet::vk::engine::memory {
 
 
+    /// ## Non-empty vectors in a pooled map
+    /**
+     * A forward range over the key-value pairs where the vector is not empty.
+     * Empty vectors are skipped. Unlike a generator the range lives on the
+     * stack, so iterating it never allocates, which matters as shaders walk
+     * their batches several times each frame.
+     */
+    template<typename Iterator>
+    class non_empty_range {
+        using pair_type = std::iter_value_t<Iterator>;
+
+      public:
+        using iteration_value_type = std::pair<
+                typename pair_type::first_type const &,
+                typename pair_type::second_type &>;
+
+        class iterator {
+            friend class non_empty_range;
+            Iterator at = {}, last = {};
+
+            iterator(Iterator const a, Iterator const l) : at{a}, last{l} {
+                skip_empty();
+            }
+            void skip_empty() {
+                while (at != last and at->second.empty()) { ++at; }
+            }
+
+          public:
+            using value_type = iteration_value_type;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            iteration_value_type operator*() const {
+                return {at->first, at->second};
+            }
+            iterator &operator++() {
+                ++at;
+                skip_empty();
+                return *this;
+            }
+            iterator operator++(int) {
+                auto const was = *this;
+                ++*this;
+                return was;
+            }
+
+            friend bool operator==(iterator const &l, iterator const &r) {
+                return l.at == r.at;
+            }
+        };
+
+
+        non_empty_range(Iterator const b, Iterator const e)
+        : position{b, e}, last{e, e} {}
+
+        iterator begin() const { return position; }
+        iterator end() const { return last; }
+
+        /// Step through the values one at a time
+        std::optional<iteration_value_type> next() {
+            if (position == last) {
+                return {};
+            } else {
+                return *position++;
+            }
+        }
+
+
+      private:
+        iterator position, last;
+    };
+
+
     /// ## Pooled map of vectors
     /**
      * This is intended for use in shaders where we often need to store a number
@@ -28,7 +107,8 @@ namespace planet::vk::engine::memory {
         using key_type = typename Map::key_type;
         using vector_type = typename Map::mapped_type;
         using value_type = typename vector_type::value_type;
-        using iteration_value_type = std::pair<key_type const &, vector_type &>;
+        using range_type = non_empty_range<typename Map::iterator>;
+        using iteration_value_type = typename range_type::iteration_value_type;
 
 
         /// ### Queries
@@ -46,15 +126,8 @@ namespace planet::vk::engine::memory {
 
 
         /// #### Iteration over non-empty vectors
-        felspar::coro::generator<iteration_value_type> non_empty_vectors()
-        /**
-         * Returns a generator that yields references to key-value pairs where
-         * the vector is not empty. Empty vectors in the map are skipped.
-         */
-        {
-            for (auto &[key, vec] : storage) {
-                if (not vec.empty()) { co_yield {key, vec}; }
-            }
+        range_type non_empty_vectors() {
+            return {storage.begin(), storage.end()};
         }
 
 
@@ -87,4 +160,142 @@ namespace planet::vk::engine::memory {
     };
 
 
+    /// ## Flat pooled map of vectors
+    /**
+     * The same interface and clearing rules as `pooled_vector_map`, but laid
+     * out for the per-draw lookup and per-frame iteration that shaders do.
+     *
+     * The keys and their vectors are held densely in `slots`, in the order the
+     * keys were first seen. An open addressing table of slot numbers, probed
+     * linearly, finds the slot for a key. Iteration walks the dense slots, so
+     * it never chases pointers.
+     *
+     * When `clear` drops a key the last live slot is moved into its place and
+     * the dropped vector is kept, empty, past the live slots. The next new key
+     * re-uses it along with its capacity, so textures that come and go don't
+     * cost allocations either.
+     */
+    template<typename Key, typename Vector, typename Hash = std::hash<Key>>
+    class flat_pooled_vector_map {
+        using slot_type = std::pair<Key, Vector>;
+        using slots_type = std::vector<slot_type>;
+
+      public:
+        using key_type = Key;
+        using vector_type = Vector;
+        using value_type = typename vector_type::value_type;
+        using range_type = non_empty_range<typename slots_type::iterator>;
+        using iteration_value_type = typename range_type::iteration_value_type;
+
+
+        /// ### Queries
+        bool empty() const noexcept { return live == 0; }
+        bool contains(key_type const &key) const noexcept {
+            return slot_of(key) != live;
+        }
+        std::size_t non_empty_count() const noexcept {
+            std::size_t count = 0;
+            for (std::size_t index{}; index < live; ++index) {
+                if (not slots[index].second.empty()) { ++count; }
+            }
+            return count;
+        }
+
+
+        /// #### Iteration over non-empty vectors
+        range_type non_empty_vectors() {
+            auto const b = slots.begin();
+            return {b, b + static_cast<std::ptrdiff_t>(live)};
+        }
+
+
+        /// ### Mutation
+        void push_back(key_type const &key, value_type value) {
+            vector_for(key).push_back(std::move(value));
+        }
+
+        template<typename... Args>
+        void emplace_back(key_type const &key, Args... args) {
+            vector_for(key).emplace_back(std::forward<Args>(args)...);
+        }
+
+        /// #### Clear the vectors, dropping keys that weren't used
+        void clear() {
+            std::size_t const was_live = live;
+            for (std::size_t index{}; index < live;) {
+                if (slots[index].second.empty()) {
+                    --live;
+                    std::swap(slots[index], slots[live]);
+                } else {
+                    slots[index].second.clear();
+                    ++index;
+                }
+            }
+            if (live != was_live) { rebuild_table(); }
+        }
+
+
+      private:
+        slots_type slots;
+        std::size_t live = {};
+        /// Slot number plus one, so that zero marks an unused entry
+        std::vector<std::uint32_t> table;
+
+        std::size_t home(key_type const &key) const noexcept {
+            /// Fibonacci hashing spreads keys like aligned pointers, whose low
+            /// bits are always the same, across the table
+            auto const h = static_cast<std::uint64_t>(Hash{}(key))
+                    * 0x9e37'79b9'7f4a'7c15ull;
+            auto const bits = std::countr_zero(table.size());
+            return static_cast<std::size_t>(h >> (64 - bits));
+        }
+
+        /// The slot holding the key, or `live` if the key isn't there
+        std::size_t slot_of(key_type const &key) const noexcept {
+            if (not table.empty()) {
+                auto const mask = table.size() - 1;
+                for (auto probe = home(key); table[probe];
+                     probe = (probe + 1) & mask) {
+                    std::size_t const slot = table[probe] - 1;
+                    if (slots[slot].first == key) { return slot; }
+                }
+            }
+            return live;
+        }
+
+        vector_type &vector_for(key_type const &key) {
+            if (auto const slot = slot_of(key); slot != live) {
+                return slots[slot].second;
+            }
+            if (live == slots.size()) {
+                slots.emplace_back(key, vector_type{});
+            } else {
+                slots[live].first = key;
+            }
+            ++live;
+            /// Keep the table at most three quarters full
+            if (4 * live > 3 * table.size()) {
+                rebuild_table();
+            } else {
+                insert(live - 1);
+            }
+            return slots[live - 1].second;
+        }
+
+        void insert(std::size_t const slot) {
+            auto const mask = table.size() - 1;
+            auto probe = home(slots[slot].first);
+            while (table[probe]) { probe = (probe + 1) & mask; }
+            table[probe] = static_cast<std::uint32_t>(slot + 1);
+        }
+
+        void rebuild_table() {
+            std::size_t size = table.empty() ? 16 : table.size();
+            while (4 * live > 3 * size) { size *= 2; }
+            table.assign(size, 0);
+            for (std::size_t slot{}; slot < live; ++slot) { insert(slot); }
+        }
+    };
+
+
 }
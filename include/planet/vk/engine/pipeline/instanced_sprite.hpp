@@ -0,0 +1,127 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/vk/engine/memory/pooled-vector-map.hpp>
+#include <planet/vk/engine/pipeline/sprite.hpp>
+
+
+namespace planet::vk::engine::pipeline {
+
+
+    /// ## Draw sprites using instancing
+    /**
+     * Draws the same sprites as `sprite`, but instead of building four
+     * vertices per sprite and issuing a draw call for each one, the transform,
+     * colour, texture co-ordinates and z height of each sprite are written to a
+     * per-instance buffer. The vertex shader builds the quad's corners from
+     * `gl_VertexIndex`, so there is no vertex or index buffer at all.
+     *
+     * Sprites are grouped by texture and each group is drawn with a single
+     * instanced draw call. Descriptor sets for the textures are allocated as
+     * needed, starting from `textures_per_frame` per frame, and the number of
+     * sprites is limited only by the size of the renderer's `frame_uploads`.
+     *
+     * When the renderer has bindless textures each instance carries the slot
+     * of its texture, and the whole frame is drawn with a single descriptor
+     * set bind and a single draw call.
+     */
+    class instanced_sprite final : private telemetry::id {
+        graphics_pipeline create_pipeline(engine::renderer &, std::string_view);
+
+      public:
+        using location = sprite::location;
+
+
+        /// ### Per-instance data
+        /**
+         * The layout must match the instance attributes in the
+         * `sprite.instanced.*.vert` shaders.
+         */
+        struct instance_type {
+            /// #### Transform from sprite space into world space
+            affine::matrix3d transform;
+            /// #### Colour the texture is multiplied by
+            planet::colour colour;
+            /// #### Sprite space corners
+            /// Stored as the top left x and y followed by the bottom right
+            std::array<float, 4> position;
+            /// #### Texture co-ordinates
+            /// Stored in the same order as the `position`
+            std::array<float, 4> uv;
+            /// #### Z height
+            float z_height;
+            /// #### Bindless texture slot
+            /// Only used when drawing with bindless textures
+            std::uint32_t texture_slot = {};
+        };
+        static constexpr std::uint32_t vertices_per_sprite = 6;
+
+        /// #### Work out the instance data for a sprite
+        static instance_type
+                make_instance(affine::rectangle2d const &uv,
+                              location const &,
+                              colour const &) noexcept;
+
+
+        instanced_sprite(
+                engine::renderer &r,
+                std::string_view const vertex_shader,
+                std::uint32_t const textures_per_frame = 256)
+        : instanced_sprite{
+                  "planet_vk_engine_pipeline_instanced_sprite", r,
+                  vertex_shader, textures_per_frame, id::suffix::add} {}
+        instanced_sprite(
+                std::string_view,
+                engine::renderer &,
+                std::string_view vertex_shader,
+                std::uint32_t textures_per_frame = 256,
+                id::suffix = id::suffix::suppress);
+
+        /// #### Name used for telemetry and GPU profiling
+        using id::name;
+
+
+        ubo::textures<instance_type, engine::max_frames_in_flight> textures;
+        vk::graphics_pipeline pipeline;
+
+
+        /// ### Drawing API
+
+        /// #### Draw texture stretched to the axis aligned rectangle
+        void
+                draw(std::pair<vk::texture const &, affine::rectangle2d>,
+                     location const &,
+                     colour const & = colour::white);
+        void
+                draw(vk::texture const &t,
+                     location const &l,
+                     colour const &c = colour::white) {
+            draw({t, {{0, 0}, affine::extents2d{1, 1}}}, l, c);
+        }
+
+
+        /// ### Add draw commands to command buffer
+        void render(render_parameters);
+
+
+      private:
+        engine::bindless_textures *bindless;
+        void render_bindless(render_parameters &);
+
+        std::size_t instance_count = {};
+        planet::vk::engine::memory::pooled_vector_map<
+                std::map<vk::texture const *, std::vector<instance_type>>>
+                instances;
+
+
+        /// ### Telemetry
+
+        /// #### Sprites drawn in a single frame
+        telemetry::max c_instances_in_frame{name() + "__instances_in_frame"};
+        /// #### Instanced draw calls issued
+        telemetry::counter c_draw_calls{name() + "__draw_calls"};
+    };
+
+
+}
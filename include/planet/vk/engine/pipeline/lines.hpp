@@ -17,7 +17,7 @@ namespace planet::vk::engine::pipeline {
      * (`vertex::coloured`) and the mesh shaders unchanged -- only the pipeline
      * topology differs.
      */
-    class lines final {
+    class lines final : private telemetry::id {
       public:
         /// ### Construction
         /**
@@ -26,6 +26,13 @@ namespace planet::vk::engine::pipeline {
          * layout to the renderer's coordinates UBO layout.
          */
         struct parameters {
+            static std::string_view constexpr default_name =
+                    "planet_vk_engine_pipeline_lines";
+
+            std::string_view name = default_name;
+            id::suffix use_name_suffix =
+                    (name == default_name ? id::suffix::add
+                                          : id::suffix::suppress);
             engine::renderer &renderer;
             shader_parameters vertex_shader{
                     .spirv_filename = "planet-vk-engine/mesh.world.vert.spirv"};
@@ -37,6 +44,9 @@ namespace planet::vk::engine::pipeline {
         };
         lines(parameters);
 
+        /// #### Name used for telemetry and GPU profiling
+        using id::name;
+
 
         vk::graphics_pipeline pipeline;
 
@@ -89,11 +99,6 @@ namespace planet::vk::engine::pipeline {
 
         /// ### Add draw commands to command buffer
         void render(render_parameters);
-
-
-      private:
-        std::array<buffer<vertex::coloured>, max_frames_in_flight> vertex_buffers;
-        std::array<buffer<std::uint32_t>, max_frames_in_flight> index_buffers;
     };
 
 
@@ -11,7 +11,7 @@ namespace planet::vk::engine::pipeline {
 
 
     /// ## 2D triangle mesh with per-vertex colour
-    class mesh final {
+    class mesh final : private telemetry::id {
         static pipeline_layout default_layout(engine::renderer &);
 
 
@@ -26,6 +26,13 @@ namespace planet::vk::engine::pipeline {
          * vertex shader.
          */
         struct parameters {
+            static std::string_view constexpr default_name =
+                    "planet_vk_engine_pipeline_mesh";
+
+            std::string_view name = default_name;
+            id::suffix use_name_suffix =
+                    (name == default_name ? id::suffix::add
+                                          : id::suffix::suppress);
             engine::renderer &renderer;
             shader_parameters vertex_shader;
             shader_parameters fragment_shader{
@@ -36,6 +43,9 @@ namespace planet::vk::engine::pipeline {
         };
         mesh(parameters);
 
+        /// #### Name used for telemetry and GPU profiling
+        using id::name;
+
 
         vk::graphics_pipeline pipeline;
 
@@ -85,11 +95,6 @@ namespace planet::vk::engine::pipeline {
 
         /// ### Add draw commands to command buffer
         void render(render_parameters);
-
-
-      private:
-        std::array<buffer<vertex::coloured>, max_frames_in_flight> vertex_buffers;
-        std::array<buffer<std::uint32_t>, max_frames_in_flight> index_buffers;
     };
 
 
@@ -8,6 +8,8 @@
 #include <planet/vk/engine/render_parameters.hpp>
 #include <planet/vk/engine/textured.draw.hpp>
 
+#include <array>
+
 
 namespace planet::vk::engine::pipeline {
 
@@ -18,6 +20,16 @@ namespace planet::vk::engine::pipeline {
      * provided rotation about a provided centre. These are typically used for
      * game characters, shots etc. that need to be drawn in world coordinate
      * space.
+     *
+     * Each sprite costs a descriptor update and a draw call, and needs its own
+     * descriptor set. `textures_per_frame` sets the size of the first pool,
+     * more are allocated if needed. Use `instanced_sprite` where there are
+     * many sprites to draw.
+     *
+     * When the renderer has bindless textures the sprites use those instead.
+     * The descriptor set is bound once and the texture slot is passed to the
+     * fragment shader as a push constant, and there is no limit on the number
+     * of sprites.
      */
     class sprite final : private telemetry::id {
         graphics_pipeline create_pipeline(engine::renderer &, std::string_view);
@@ -37,6 +49,9 @@ namespace planet::vk::engine::pipeline {
                std::uint32_t textures_per_frame = 256,
                id::suffix = id::suffix::suppress);
 
+        /// #### Name used for telemetry and GPU profiling
+        using id::name;
+
 
         textures_type textures;
         vk::graphics_pipeline pipeline;
@@ -98,6 +113,28 @@ namespace planet::vk::engine::pipeline {
 
         /// ### Add draw commands to command buffer
         void render(render_parameters);
+
+
+        /// ### Sprite geometry
+        using vertex_type = textures_type::vertex_type;
+
+        /// #### The four sprite space corners
+        /**
+         * In the order the renderer's `quad_indices` expects. The sprite is
+         * moved into place by the `transform`, which every vertex shader for
+         * this pipeline must apply.
+         */
+        static std::array<vertex_type, 4>
+                make_vertices(affine::rectangle2d const &uv,
+                              location const &,
+                              colour const &) noexcept;
+        /// #### Transform from sprite space into world space
+        static push_constant make_transform(location const &) noexcept;
+
+
+      private:
+        engine::bindless_textures *bindless;
+        void render_bindless(render_parameters &);
     };
 
 
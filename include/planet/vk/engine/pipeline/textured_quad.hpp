@@ -1,8 +1,10 @@
 #pragma once
 
 
+#include <planet/telemetry/counter.hpp>
 #include <planet/vk/engine/app.hpp>
 #include <planet/vk/engine/memory/pooled-vector-map.hpp>
+#include <planet/vk/engine/quad_index_buffer.hpp>
 #include <planet/vk/engine/render_parameters.hpp>
 #include <planet/vk/ubo/textures.hpp>
 #include <planet/vk/vertex/coloured_textured.hpp>
@@ -15,6 +17,8 @@ namespace planet::vk::engine::pipeline {
     /**
      * Draws 2D axis-aligned quads with texture support. Quads are grouped by
      * texture to reduce the number of texture bindings and descriptor updates.
+     * With bindless textures the descriptor set is bound once for the frame
+     * and each group only needs a push constant.
      */
     class textured_quad final : private telemetry::id {
       public:
@@ -34,9 +38,37 @@ namespace planet::vk::engine::pipeline {
             shader_parameters fragment_shader{
                     .spirv_filename = "planet-vk-engine/textured.frag.spirv"};
             std::uint32_t const textures_per_frame = 256;
+            /// #### Write vertices straight into mapped GPU memory
+            /**
+             * When `false` the quads are first expanded into CPU side vectors
+             * and then copied into the renderer's `frame_uploads`.
+             */
+            bool write_through = true;
+            /// #### Build the quads' corners in the vertex shader
+            /**
+             * When `true` a single `instance_type` is uploaded for each quad
+             * instead of its four vertices and six indices, and the
+             * `vertex_shader` must be one of the `texture.instanced.*.vert`
+             * shaders.
+             */
+            bool vertex_pulling = false;
+            /// #### Use the renderer's bindless textures when it has them
+            /**
+             * The bindless fragment shader is used in place of the
+             * `fragment_shader`, so a pipeline with a custom fragment shader
+             * should either provide a matching bindless one or turn this off.
+             * The texture slot is a `uint` push constant at offset 64.
+             */
+            bool bindless = true;
+            shader_parameters bindless_fragment_shader{
+                    .spirv_filename =
+                            "planet-vk-engine/textured.bindless.frag.spirv"};
         };
         textured_quad(parameters);
 
+        /// #### Name used for telemetry and GPU profiling
+        using id::name;
+
 
         ubo::textures<vertex_type, engine::max_frames_in_flight> textures_ubo;
         vk::graphics_pipeline pipeline;
@@ -81,24 +113,79 @@ namespace planet::vk::engine::pipeline {
         void render(render_parameters);
 
 
-      private:
+        /// ### Telemetry
+        /// #### Frames whose quads were drawn with 16 or 32 bit indices
+        telemetry::counter c_index16_batches{name() + "__index16_batches"},
+                c_index32_batches{name() + "__index32_batches"};
+
+
+        /// ### Quad geometry
         struct quad_draw_info {
             affine::rectangle2d position;
             affine::rectangle2d uv;
             planet::colour colour;
             float z;
         };
+        static constexpr std::size_t vertices_per_quad =
+                quad_index_buffer::vertices_per_quad;
+        static constexpr std::size_t indices_per_quad =
+                quad_index_buffer::indices_per_quad;
+
+        /// #### Write out the vertices for a quad
+        /**
+         * Writes `vertices_per_quad` vertices in the order the renderer's
+         * `quad_indices` expects. The destination is only ever written to,
+         * never read, so it can be write-combined mapped GPU memory.
+         */
+        static void
+                emit(quad_draw_info const &, vertex_type *vertices) noexcept;
+
+
+        /// ### Per-quad record used for vertex pulling
+        /**
+         * The layout must match the instance attributes in the
+         * `texture.instanced.*.vert` shaders, which build the same corners as
+         * `emit` from `gl_VertexIndex`.
+         */
+        struct instance_type {
+            /// #### Top left x and y followed by the bottom right
+            std::array<float, 4> position;
+            /// #### Texture co-ordinates in the same order as `position`
+            std::array<float, 4> uv;
+            /// #### Red, green, blue and alpha as `R8G8B8A8_UNORM`
+            /**
+             * Packing the colour keeps the record at 40 bytes. Each channel is
+             * clamped to `[0, 1]` and kept to 8 bits, which is all the colour
+             * attachments hold.
+             */
+            std::array<std::uint8_t, 4> colour;
+            float z;
+        };
+        static_assert(sizeof(instance_type) == 40);
+        static constexpr std::uint32_t vertices_per_instance = 6;
 
-        planet::vk::engine::memory::pooled_vector_map<
-                std::map<vk::texture const *, std::vector<quad_draw_info>>>
+        /// #### Work out the instance record for a quad
+        static instance_type make_instance(quad_draw_info const &) noexcept;
+
+
+      private:
+        graphics_pipeline create_pipeline(parameters const &);
+
+        bool write_through;
+        bool vertex_pulling;
+        engine::bindless_textures *bindless;
+        std::size_t quad_count = {};
+
+        planet::vk::engine::memory::flat_pooled_vector_map<
+                vk::texture const *, std::vector<quad_draw_info>>
                 commands;
 
+        /// Only used when not writing through
         std::vector<vertex_type> vertices;
-        std::vector<std::uint32_t> indices;
-        std::array<buffer<vertex_type>, engine::max_frames_in_flight>
-                vertex_buffers;
-        std::array<buffer<std::uint32_t>, engine::max_frames_in_flight>
-                index_buffers;
+        std::vector<instance_type> instances;
+
+        void upload_vertices(render_parameters &);
+        void upload_instances(render_parameters &);
     };
 
 
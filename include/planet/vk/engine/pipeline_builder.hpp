@@ -0,0 +1,83 @@
+#pragma once
+
+
+#include <planet/vk/engine/renderer.hpp>
+
+#include <felspar/coro/task.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace planet::vk::engine {
+
+
+    /// ## Build graphics pipelines on worker threads
+    /**
+     * Compiling pipelines is the slowest part of starting up. Pipelines handed
+     * to the builder are compiled on a pool of worker threads, so the main
+     * thread can carry on loading textures or drawing `engine::blank` frames
+     * while they build.
+     *
+     * Shader modules are fetched from the device's registry on the calling
+     * thread, reading the SPIR-V through the asset manager if they haven't
+     * been used before. Pipeline creation happens on a worker, using the
+     * device's pipeline cache.
+     *
+     * Everything the parameters refer to (vertex descriptions, specialisation
+     * data, render pass etc.) must stay alive until the pipeline is ready. The
+     * builder must be destroyed before the device, and its destructor waits
+     * for any queued work to finish.
+     */
+    class pipeline_builder final {
+      public:
+        explicit pipeline_builder(
+                engine::app &,
+                std::size_t threads = std::thread::hardware_concurrency());
+        ~pipeline_builder();
+
+        pipeline_builder(pipeline_builder const &) = delete;
+        pipeline_builder &operator=(pipeline_builder const &) = delete;
+
+
+        /// ### Queue pipelines to be built
+        std::future<graphics_pipeline> build(
+                graphics_pipeline_parameters,
+                std::source_location const & = std::source_location::current());
+        std::vector<std::future<graphics_pipeline>>
+                build(std::vector<graphics_pipeline_parameters>,
+                      std::source_location const & =
+                              std::source_location::current());
+
+
+        /// ### Wait for a pipeline without blocking the event loop
+        /**
+         * Polls the future between sleeps on the SDL event loop, in the same
+         * way as `renderer::start` waits for its fences.
+         */
+        felspar::coro::task<graphics_pipeline>
+                ready(std::future<graphics_pipeline>);
+
+
+        /// ### Queries
+        std::size_t thread_count() const noexcept { return workers.size(); }
+
+
+      private:
+        engine::app &app;
+
+        std::mutex mutex;
+        std::condition_variable signal;
+        std::deque<std::packaged_task<graphics_pipeline()>> queue;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+
+        void work();
+    };
+
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/telemetry/id.hpp>
+#include <planet/telemetry/minmax.hpp>
+#include <planet/vk/buffer.hpp>
+#include <planet/vk/commands.hpp>
+#include <planet/vk/engine/forward.hpp>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <vector>
+
+
+namespace planet::vk::engine {
+
+
+    /// ## Shared index buffer for drawing quads
+    /**
+     * Every quad is drawn with the same six indices into its four vertices,
+     * so rather than each pipeline building and uploading them every frame,
+     * the renderer owns one device local buffer that holds the pattern for as
+     * many quads as have been asked for so far. Quad `n` uses vertices `4n` to
+     * `4n + 3`, so a pipeline only needs to write its vertices in that order.
+     *
+     * Batches of up to `max_narrow_quads` quads are bound to a buffer of
+     * `std::uint16_t` indices, and larger ones to a buffer of `std::uint32_t`
+     * indices, so small batches only need half the index bandwidth.
+     *
+     * When a bind asks for more quads than the buffer holds, it is replaced
+     * by a host visible one at least twice the size whose indices are
+     * written by the CPU. Nothing is submitted to a queue and nothing waits
+     * for the GPU while commands are being recorded. The next time
+     * `next_frame` is called, before any recording for the frame, the
+     * indices are copied into a device local buffer by a submission that
+     * isn't waited on. `reserve` can be used to make that happen before the
+     * first frame that needs the space. Replaced buffers are kept until the
+     * frames that may have used them have finished.
+     *
+     * Binding a buffer that is already big enough doesn't lock, so pipelines
+     * recorded on several threads can share it. Growing takes a lock.
+     */
+    class quad_index_buffer final : private telemetry::id {
+      public:
+        static constexpr std::size_t vertices_per_quad = 4;
+        static constexpr std::size_t indices_per_quad = 6;
+        static constexpr std::array<std::uint32_t, indices_per_quad> pattern =
+                {0, 1, 2, 0, 2, 3};
+
+        /// #### Smallest number of quads a buffer is created for
+        static constexpr std::size_t minimum_quads = 1024;
+        /// #### Most quads that can be drawn with 16 bit indices
+        static constexpr std::size_t max_narrow_quads =
+                (std::size_t{1} << 16) / vertices_per_quad;
+
+
+        quad_index_buffer(std::string_view name, vk::device &);
+
+
+        /// ### Bind the indices
+        /**
+         * Binds a buffer holding at least `quads` quads to the command buffer,
+         * growing it first if needed, and returns the width of its indices.
+         * Draw quad `n` with a first index of `n * indices_per_quad`.
+         */
+        VkIndexType bind(command_buffer &, std::size_t quads);
+
+
+        /// ### Ask for space ahead of time
+        /**
+         * The buffer for batches of this many quads is grown to at least this
+         * size the next time `next_frame` is called.
+         */
+        void reserve(std::size_t quads);
+
+
+        /// ### Move to device local memory and release old buffers
+        /**
+         * The renderer calls this each time it has waited for a frame in
+         * flight to finish, before it starts recording the frame. Any buffer
+         * that `bind` had to grow, or that `reserve` asked for, is copied into
+         * device local memory on the graphics queue, so this must be called
+         * from the thread that submits the frames.
+         */
+        void next_frame();
+
+
+        /// ### Queries
+        std::size_t narrow_capacity() const noexcept {
+            return narrow.quads.load(std::memory_order_acquire);
+        }
+        std::size_t wide_capacity() const noexcept {
+            return wide.quads.load(std::memory_order_acquire);
+        }
+
+        /// #### Write the indices for quads into memory
+        template<typename Index>
+        static void
+                fill(std::span<Index> const out,
+                     std::size_t const first_quad = {}) {
+            auto vertex = first_quad * vertices_per_quad;
+            for (std::size_t index{}; index + indices_per_quad <= out.size();
+                 index += indices_per_quad) {
+                for (std::size_t corner{}; corner < indices_per_quad;
+                     ++corner) {
+                    out[index + corner] =
+                            static_cast<Index>(vertex + pattern[corner]);
+                }
+                vertex += vertices_per_quad;
+            }
+        }
+
+
+        /// ### Telemetry
+        telemetry::counter c_grown{name() + "__grown"};
+        telemetry::max c_capacity{name() + "__capacity"};
+        /// #### Copies into device local memory made by `next_frame`
+        telemetry::counter c_uploads{name() + "__uploads"};
+
+
+      private:
+        device_memory_allocator allocator;
+        vk::command_pool pool;
+        std::mutex mutex;
+
+        template<typename Index>
+        struct indices {
+            buffer<Index> memory;
+            /**
+             * Read by `bind` without the lock. The handle is always stored
+             * before the number of quads, so a buffer is never bound for more
+             * quads than it holds.
+             */
+            std::atomic<VkBuffer> handle = VK_NULL_HANDLE;
+            std::atomic<std::size_t> quads = {};
+            /// Set once `memory` is device local
+            bool device_local = false;
+            /// Asked for by `reserve`
+            std::size_t wanted = {};
+        };
+        indices<std::uint16_t> narrow;
+        indices<std::uint32_t> wide;
+        std::size_t frames = {};
+
+        struct retired_buffer {
+            /// The value of `frames` after which it can be destroyed
+            std::size_t release_after;
+            buffer<std::uint16_t> narrow = {};
+            buffer<std::uint32_t> wide = {};
+            /// The copy into device local memory, with its staging buffer
+            vk::submission copy = {};
+        };
+        std::vector<retired_buffer> retired;
+
+        template<typename Index>
+        VkBuffer buffer_for(
+                indices<Index> &, std::size_t needed, std::size_t limit);
+        template<typename Index>
+        void upload(indices<Index> &, std::size_t limit);
+        template<typename Index>
+        void replace(indices<Index> &, buffer<Index>, std::size_t quads);
+    };
+
+
+}
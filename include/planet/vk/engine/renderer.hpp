@@ -4,13 +4,24 @@
 #include <planet/affine/matrix3d.hpp>
 #include <planet/array.hpp>
 #include <planet/vk/engine/app.hpp>
+#include <planet/vk/engine/bindless_textures.hpp>
 #include <planet/vk/engine/depth_buffer.hpp>
+#include <planet/vk/engine/gpu_completion.hpp>
+#include <planet/vk/engine/gpu_profiler.hpp>
+#include <planet/vk/engine/memory/frame-ring.hpp>
+#include <planet/vk/engine/quad_index_buffer.hpp>
 #include <planet/vk/frame_buffer.hpp>
 #include <planet/vk/engine/postprocess/glow.hpp>
 #include <planet/vk/engine/render_parameters.hpp>
+#include <planet/vk/engine/secondary_recorder.hpp>
 #include <planet/vk/ubo/coordinate_space.hpp>
 
 #include <felspar/coro/barrier.hpp>
+#include <felspar/coro/eager.hpp>
+
+#include <coroutine>
+#include <exception>
+#include <optional>
 
 #include <planet/time/checkpointer.hpp>
 
@@ -56,9 +67,52 @@ namespace planet::vk::engine {
         device_memory_allocator per_swap_chain_memory{
                 "renderer_per_swap_chain", app.device};
 
+        /// #### Per-frame upload ring
+        /**
+         * Persistently mapped memory for vertex, index and other data that is
+         * written by the CPU and read by the GPU during a single frame. Prefer
+         * this over building a new `vk::buffer` from `per_frame_memory` each
+         * frame. A frame index's memory is recycled just before
+         * `next_frame_prestart` fires for it.
+         */
+        memory::frame_ring frame_uploads{
+                "planet_vk_engine_renderer__frame_uploads", app.device};
+
+        /// #### Indices shared by the quad pipelines
+        /**
+         * Pipelines that draw quads write four vertices per quad and bind
+         * this instead of building their own indices.
+         */
+        quad_index_buffer quad_indices{
+                "planet_vk_engine_renderer__quad_indices", app.device};
+
+
+        /// ### Bindless textures
+        /**
+         * Only present when the device has enabled bindless textures. The
+         * texture pipelines use it instead of their per-frame texture sets
+         * when it is available.
+         */
+        std::optional<engine::bindless_textures> bindless =
+                app.device.bindless_textures
+                ? std::optional<engine::bindless_textures>{
+                          std::in_place,
+                          "planet_vk_engine_renderer__bindless_textures",
+                          app.device}
+                : std::nullopt;
+
 
         /// ### Swap chain, command buffers and synchronisation
-        vk::swap_chain swap_chain{app.device, app.window.extents()};
+        /**
+         * For an off-screen `app` the swap chain owns an image per frame in
+         * flight, and `start` and `submit_and_present` skip the acquire and
+         * present.
+         */
+        vk::swap_chain swap_chain = app.window.offscreen()
+                ? vk::swap_chain{
+                          app.device, per_swap_chain_memory,
+                          app.window.extents(), max_frames_in_flight}
+                : vk::swap_chain{app.device, app.window.extents()};
 
         vk::command_pool command_pool{app.device, app.instance.surface};
         vk::command_buffers command_buffers{command_pool, max_frames_in_flight};
@@ -87,6 +141,17 @@ namespace planet::vk::engine {
         std::array<vk::fence, max_frames_in_flight> fence{
                 array_of<max_frames_in_flight>(
                         [this]() { return vk::fence{app.device}; })};
+        /// Waits on the fences and swap chain without polling
+        engine::gpu_completion gpu_completion{app};
+
+        /// #### GPU timings
+        /**
+         * The scene render pass, the post-process steps and each pipeline
+         * passed to `render` are timed. Other work can be timed by opening a
+         * scope on the command buffer in the `render_parameters`.
+         */
+        engine::gpu_profiler gpu_profiler{
+                "planet_vk_engine_renderer__gpu", app.device};
 
 
         /// ### Drawing API
@@ -95,8 +160,29 @@ namespace planet::vk::engine {
         /**
          * Returns the current frame index. This is the index between zero and
          * `max_frames_in_flight` that is currently being worked on.
+         *
+         * The frame is started by a coroutine that lives as long as the
+         * renderer, so awaiting `start` doesn't allocate. Only one `start` can
+         * be awaited at a time.
          */
-        felspar::coro::task<std::size_t> start(VkClearValue);
+        struct start_awaitable {
+            engine::renderer &renderer;
+            VkClearValue colour;
+            std::coroutine_handle<> mine = {};
+
+
+            start_awaitable(engine::renderer &r, VkClearValue const c)
+            : renderer{r}, colour{c} {}
+            start_awaitable(start_awaitable const &) = delete;
+            start_awaitable &operator=(start_awaitable const &) = delete;
+            ~start_awaitable();
+
+
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<>);
+            std::size_t await_resume();
+        };
+        start_awaitable start(VkClearValue);
         auto start(planet::colour const &colour) {
             return start(as_VkClearValue(colour));
         }
@@ -106,12 +192,53 @@ namespace planet::vk::engine {
         render_parameters
                 bind(vk::graphics_pipeline &,
                      std::span<ubo::coherent_details const *const>);
+        /// ##### Bind into a particular command buffer
+        render_parameters
+                bind(command_buffer &,
+                     vk::graphics_pipeline &,
+                     std::span<ubo::coherent_details const *const>);
         /// ##### Bind and call render on the pipeline type
+        /**
+         * When recording into secondary command buffers each pipeline gets a
+         * buffer of its own, and the pipelines passed to a single call may be
+         * recorded at the same time on different threads.
+         */
         template<typename... Shaders>
         void render(Shaders &&...s) {
-            (bind_and_render(std::forward<Shaders>(s)), ...);
+            if (secondaries) {
+                std::array<secondary_recorder::job, sizeof...(Shaders)> const
+                        jobs{secondary_recorder::job{
+                                [this, &s](command_buffer &cb) {
+                                    record_viewport_and_scissor(cb);
+                                    bind_and_render(
+                                            cb, std::forward<Shaders>(s));
+                                }}...};
+                secondaries->record(jobs);
+            } else {
+                auto &cb = command_buffers[fif_image_index];
+                (bind_and_render(cb, std::forward<Shaders>(s)), ...);
+            }
         }
 
+        /// #### Record pipelines into secondary command buffers
+        /**
+         * From the next `start` the scene render pass is begun with
+         * `VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS`, each pipeline passed
+         * to `render` is recorded into its own secondary command buffer, and
+         * `submit_and_present` executes them in the order they were rendered.
+         *
+         * With more than one thread the pipelines given to each `render` call
+         * are recorded in parallel. They must then not share anything mutable
+         * other than the renderer's `frame_uploads`, `quad_indices`,
+         * `bindless` and `gpu_profiler`, which are all safe to use from any
+         * thread.
+         *
+         * Passing zero goes back to recording straight into the primary
+         * command buffer. Must not be called between `start` and
+         * `submit_and_present`. Waits for the frames in flight to finish.
+         */
+        void record_secondary(std::size_t threads);
+
         /// #### Viewport and Scissor settings
         /**
          * Sets the Vulkan viewport and scissor to the full window extent, then
@@ -137,7 +264,10 @@ namespace planet::vk::engine {
         }
 
         /// #### Submit and present the frame
-        /// This blocks until the frame is complete
+        /**
+         * This blocks until the frame is complete. Off-screen frames are only
+         * submitted, and the image is left ready to be copied out.
+         */
         void submit_and_present();
 
 
@@ -215,6 +345,11 @@ namespace planet::vk::engine {
 
 
         /// #### Set viewport and scissor
+        /**
+         * When recording into secondary command buffers the rectangles are
+         * remembered and set at the start of each pipeline's buffer, as the
+         * dynamic state isn't inherited from the primary.
+         */
         void set_viewport(affine::rectangle2d const &) noexcept;
         void set_scissor(affine::rectangle2d const &) noexcept;
         /**
@@ -313,6 +448,18 @@ namespace planet::vk::engine {
         bool swap_chain_suboptimal = false;
 
 
+        /// ### Timing of the scene render pass
+        engine::gpu_profiler::marker scene_timing;
+
+
+        /// ### Secondary command buffer recording
+        std::optional<engine::secondary_recorder> secondaries;
+        affine::rectangle2d viewport_rectangle, scissor_rectangle;
+        void record_viewport_and_scissor(command_buffer &) noexcept;
+        void record_viewport(command_buffer &) noexcept;
+        void record_scissor(command_buffer &) noexcept;
+
+
         /// ### Standard UBOs
         ubo::coordinate_space::ubo_type<max_frames_in_flight> coordinates;
         std::array<ubo::coherent_details const *const, 1>
@@ -321,16 +468,35 @@ namespace planet::vk::engine {
         /// #### Binds and renders a shader
         template<typename Shader, std::size_t N>
         void bind_and_render(
+                command_buffer &cb,
                 std::pair<
                         Shader &,
                         std::span<
                                 planet::vk::ubo::coherent_details const *const,
                                 N>> const &&p) {
-            p.first.render(bind(p.first.pipeline, p.second));
+            trace::scope const tracing{profile_name(p.first), "pipeline"};
+            auto const timing = gpu_profiler.scope(cb, profile_name(p.first));
+            p.first.render(bind(cb, p.first.pipeline, p.second));
         }
         template<typename Shader>
-        void bind_and_render(Shader &s) {
-            s.render(bind(s.pipeline, find_coherent_details(s, *this)));
+        void bind_and_render(command_buffer &cb, Shader &s) {
+            trace::scope const tracing{profile_name(s), "pipeline"};
+            auto const timing = gpu_profiler.scope(cb, profile_name(s));
+            s.render(bind(cb, s.pipeline, find_coherent_details(s, *this)));
+        }
+        /// #### The GPU profiler scope name for a shader
+        /**
+         * Pipelines with a `name()` are timed and traced under it. All other
+         * pipelines share the `pipeline` scope, which keeps mangled type names
+         * out of the telemetry names.
+         */
+        template<typename Shader>
+        static std::string_view profile_name(Shader const &s) {
+            if constexpr (requires { std::string_view{s.name()}; }) {
+                return s.name();
+            } else {
+                return "pipeline";
+            }
         }
         /// #### Finds the coherent memory UBOs used by the shader
         /**
@@ -350,10 +516,35 @@ namespace planet::vk::engine {
         }
 
 
-        /// TODO This array would be better as a circular buffer
+        /// Coroutines waiting on `full_render_cycle`, used as a ring so that
+        /// each slot's vector keeps its capacity from cycle to cycle
         std::array<std::vector<std::coroutine_handle<>>, max_frames_in_flight + 1>
                 render_cycle_coroutines;
+        std::size_t render_cycle_front = {};
+        std::vector<std::coroutine_handle<>> render_cycle_resuming;
+        auto &render_cycle_back() {
+            return render_cycle_coroutines
+                    [(render_cycle_front + max_frames_in_flight)
+                     % render_cycle_coroutines.size()];
+        }
         felspar::coro::barrier<std::size_t> prestart_barrier;
+
+        /// ### Starting frames
+        /**
+         * `start_awaitable` hands its coroutine over to the `starter`, which
+         * starts the frame and then hands back. `starting` stays set until the
+         * frame has started, even if the coroutine waiting for it is
+         * destroyed.
+         */
+        struct start_request;
+        felspar::coro::task<void> starter();
+        void begin_frame(VkClearValue);
+        std::coroutine_handle<> starter_handle = {}, start_requester = {};
+        bool starting = false;
+        VkClearValue start_colour = {};
+        std::exception_ptr start_failure = {};
+        /// Destroyed first, whilst everything the `starter` uses is alive
+        felspar::coro::eager<> start_frames;
     };
 
 
@@ -402,6 +593,20 @@ namespace planet::vk::engine {
     graphics_pipeline create_graphics_pipeline(
             graphics_pipeline_parameters,
             std::source_location const & = std::source_location::current());
+    /// ### Create from shader modules that have already been loaded
+    /**
+     * Doesn't touch the asset manager, so it can be called from a thread other
+     * than the main one. See `pipeline_builder`.
+     */
+    graphics_pipeline create_graphics_pipeline(
+            graphics_pipeline_parameters,
+            shader_modules::module_ptr vertex_shader,
+            shader_modules::module_ptr fragment_shader,
+            std::source_location const & = std::source_location::current());
+    /// ### Fetch a shader module through the device's registry
+    /// The SPIR-V is only read through the asset manager the first time
+    shader_modules::module_ptr
+            shader_module_for(app &, shader_parameters const &);
 
 
 }
@@ -0,0 +1,132 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/vk/command_pools.hpp>
+#include <planet/vk/engine/forward.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace planet::vk::engine {
+
+
+    /// ## Record secondary command buffers on several threads
+    /**
+     * Every job handed to `record` gets its own
+     * `VK_COMMAND_BUFFER_LEVEL_SECONDARY` command buffer, and `execute` adds
+     * them to a primary command buffer in the order the jobs were given, no
+     * matter which thread recorded them.
+     *
+     * The buffers come from a `vk::command_pools`, so each thread has its own
+     * command pool for each frame in flight, no locking is needed while
+     * recording, and all of a frame's buffers are recycled with a single
+     * `vkResetCommandPool` per thread in `start`. After the first few frames
+     * no command buffers are allocated.
+     *
+     * With one thread everything is recorded on the calling thread. With more,
+     * the calling thread records alongside `threads - 1` workers.
+     *
+     * The renderer owns one of these when it has been asked to record into
+     * secondary command buffers, see `renderer::record_secondary`.
+     */
+    class secondary_recorder final {
+      public:
+        secondary_recorder(
+                vk::device &, vk::surface const &, std::size_t threads = 1);
+        ~secondary_recorder();
+
+        secondary_recorder(secondary_recorder const &) = delete;
+        secondary_recorder &operator=(secondary_recorder const &) = delete;
+
+
+        /// ### Work recorded into one secondary command buffer
+        /**
+         * The command buffer has already been begun and is ended after the
+         * job returns.
+         */
+        using job = std::function<void(command_buffer &)>;
+
+
+        /// ### Start recording a frame
+        /**
+         * Recycles the command buffers for the frame index, so the GPU must
+         * have finished with them. The inheritance describes the render pass,
+         * sub-pass and frame buffer that the buffers will be executed in.
+         */
+        void start(std::size_t frame_index, VkCommandBufferInheritanceInfo);
+
+        /// ### Record jobs
+        /**
+         * Returns once every job has been recorded. Jobs run concurrently so
+         * they must not share mutable state. The first exception thrown by a
+         * job is re-thrown here.
+         */
+        void record(std::span<job const>);
+
+        /// ### Execute everything recorded since `start`
+        void execute(command_buffer &primary);
+
+
+        /// ### Queries
+        std::size_t thread_count() const noexcept {
+            return workers.size() + 1;
+        }
+        /// #### Buffers recorded since `start`
+        std::size_t recorded() const noexcept { return order.size(); }
+
+
+        /// ### Telemetry
+
+        /// #### Secondary command buffers recorded
+        telemetry::counter c_recorded{
+                "planet_vk_engine_secondary_recorder_recorded"};
+        /// #### Secondary command buffers allocated
+        /**
+         * Only ever bumped during warm up and when a frame records more
+         * buffers on a thread than any frame before it.
+         */
+        telemetry::counter c_allocated{
+                "planet_vk_engine_secondary_recorder_allocated"};
+
+
+      private:
+        command_pools pools;
+        std::size_t allocated = {};
+        void count_allocations();
+
+        std::size_t frame_index = {};
+        VkCommandBufferInheritanceInfo inheritance = {};
+        /// Recorded buffers, in job order
+        std::vector<VkCommandBuffer> order;
+
+
+        /// ### Hand out jobs to the threads
+        /**
+         * Everything in here is protected by the mutex. Jobs are large (a
+         * whole pipeline's worth of commands) so taking the lock for each one
+         * costs next to nothing.
+         */
+        std::mutex mutex;
+        std::condition_variable wake, done;
+        std::span<job const> jobs;
+        std::size_t first = {}, next = {}, remaining = {};
+        std::size_t generation = {};
+        std::exception_ptr failure;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+
+        void work();
+        void take_jobs(std::size_t batch);
+        void record_one(job const &, std::size_t slot);
+    };
+
+
+}
@@ -1,9 +1,12 @@
 #pragma once
 
 
+#include <planet/telemetry/counter.hpp>
 #include <planet/telemetry/minmax.hpp>
 #include <planet/vk/commands.hpp>
 #include <planet/vk/engine/forward.hpp>
+#include <planet/vk/engine/memory/frame-ring.hpp>
+#include <planet/vk/engine/quad_index_buffer.hpp>
 #include <planet/vk/ubo/textures.hpp>
 #include <planet/vk/vertex/coloured_textured.hpp>
 
@@ -20,70 +23,64 @@ namespace planet::vk::engine {
                 std::string_view const name,
                 vk::device &d,
                 std::uint32_t max_textures_per_frame)
-        : ubo{name, d, max_textures_per_frame} {}
+        : ubo{name, d, max_textures_per_frame},
+          c_index16_batches{std::string{name} + "__index16_batches"},
+          c_index32_batches{std::string{name} + "__index32_batches"} {}
 
 
         /// ### UBO
         ubo::textures<vertex_type, Frames> ubo;
 
 
-        /// ### Across frames data
-        std::array<buffer<vertex_type>, Frames> vertex_buffers;
-        std::array<buffer<std::uint32_t>, Frames> index_buffers;
+        /// ### Telemetry
+        /// #### Frames whose quads were drawn with 16 or 32 bit indices
+        telemetry::counter c_index16_batches, c_index32_batches;
 
 
         /// ### Per-frame data
         std::vector<VkDescriptorImageInfo> descriptors = {};
+        /// Four per quad, in the order `quad_index_buffer` expects
         std::vector<vertex_type> vertices;
-        std::vector<std::uint32_t> indices;
 
 
         /// ### Upload buffers to GPU
         [[nodiscard]] bool
-                bind(device_memory_allocator &allocator,
+                bind(memory::frame_ring &uploads,
+                     quad_index_buffer &quads,
                      std::size_t frame_index,
                      command_buffer &cb)
         /**
-         * Returns `true` if there are vertices and indices and they have been
-         * uploaded to the GPU. If `false` then there is nothing more to do in
-         * any render calls for pipelines using this UBO.
+         * Returns `true` if there are vertices and they have been uploaded to
+         * the GPU, with the shared quad indices bound. If `false` then there
+         * is nothing more to do in any render calls for pipelines using this
+         * UBO.
          */
         {
             if (empty()) { return false; }
 
-            auto &vertex_buffer = vertex_buffers[frame_index];
-            vertex_buffer = {
-                    allocator, vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-            auto &index_buffer = index_buffers[frame_index];
-            index_buffer = {
-                    allocator, indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+            auto const vertex_buffer = uploads.upload(frame_index, vertices);
 
-            std::array buffers{vertex_buffer.get()};
-            std::array offset{VkDeviceSize{}};
+            std::array buffers{vertex_buffer.buffer};
+            std::array offset{vertex_buffer.offset};
 
             vkCmdBindVertexBuffers(
                     cb.get(), 0, buffers.size(), buffers.data(), offset.data());
-            vkCmdBindIndexBuffer(
-                    cb.get(), index_buffer.get(), 0, VK_INDEX_TYPE_UINT32);
+            if (quads.bind(
+                        cb,
+                        vertices.size() / quad_index_buffer::vertices_per_quad)
+                == VK_INDEX_TYPE_UINT16) {
+                ++c_index16_batches;
+            } else {
+                ++c_index32_batches;
+            }
 
             ubo.textures_in_frame.value(descriptors.size());
-            if (descriptors.size() > ubo.max_per_frame) {
-                planet::log::critical(
-                        "We will run out of texture slots for this frame. Textures requested",
-                        descriptors.size(), "maximum per frame",
-                        ubo.max_per_frame);
-            }
             return true;
         }
 
 
         void clear() {
             vertices.clear();
-            indices.clear();
             descriptors.clear();
         }
         [[nodiscard]] bool empty() const noexcept { return vertices.empty(); }
@@ -7,6 +7,7 @@ namespace planet::vk {
     template<typename T>
     class buffer;
     class command_pool;
+    class command_pools;
     class descriptor_set_layout;
     class device;
     class device_memory;
@@ -19,9 +20,12 @@ namespace planet::vk {
     class physical_device;
     class queue;
     class render_pass;
+    class submission;
     class surface;
     class swap_chain;
     class texture;
+    class texture_batch;
+    class upload_engine;
 
 
 }
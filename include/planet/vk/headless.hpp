@@ -63,6 +63,15 @@ namespace planet::vk {
          */
         static std::unique_ptr<headless> make_if_available();
 
+        /// #### The parts needed to make a headless instance
+        /**
+         * For anything else that wants a headless surface, for example an
+         * off-screen `engine::app`. Both throw `headless_not_available` if the
+         * extension is missing.
+         */
+        static vk::extensions instance_extensions();
+        static VkSurfaceKHR create_surface(VkInstance);
+
         /// #### Not movable or copyable
         headless(headless const &) = delete;
         headless(headless &&) = delete;
@@ -6,10 +6,12 @@
 #include <planet/telemetry/map.hpp>
 #include <planet/telemetry/minmax.hpp>
 #include <planet/vk/forward.hpp>
+#include <planet/vk/memory_free_ranges.hpp>
 #include <planet/vk/owned_handle.hpp>
 #include <planet/vk/view.hpp>
 
 #include <atomic>
+#include <memory>
 #include <mutex>
 
 
@@ -41,9 +43,24 @@ namespace planet::vk {
      * `device_memory_block_pool` that exists on the Vulkan device. This is a
      * thread safe pool of memory allocations that means that short lived
      * allocators don't thrash the Vulkan memory APIs.
+     *
+     * Allocators whose memory lifetimes can't be kept in step (for example
+     * long running sessions using the start up and staging allocators) can opt
+     * in to the `free_ranges` strategy instead. Each block then tracks which of
+     * its ranges have been freed and hands them out again, so a single long
+     * lived allocation no longer stops the rest of its block from being used.
      */
 
 
+    /// ## Sub-allocation strategies
+    enum class device_memory_strategy {
+        /// Bump-split blocks, recycling a block once all of it is free
+        slab,
+        /// Track freed ranges inside each block and reuse them
+        free_ranges,
+    };
+
+
     /// ## Memory allocation configuration
     struct device_memory_allocator_configuration {
         /// ### GPU memory allocation block size
@@ -62,6 +79,17 @@ namespace planet::vk {
          * requests.
          */
 
+        /// ### How freed memory inside a block is reused
+        device_memory_strategy strategy = device_memory_strategy::slab;
+        /**
+         * With `device_memory_strategy::free_ranges` each block keeps a
+         * segregated fit index (`device_memory_free_ranges`) of the ranges that
+         * have been freed and new requests are placed into those ranges before
+         * a fresh block is pulled. This costs a little more per allocation and
+         * release than the slab strategy. It has no effect when `split` is
+         * turned off.
+         */
+
         /// ### Memory mapping flags for all memory allocated here
         VkMemoryMapFlags memory_map_flags = {};
     };
@@ -91,6 +119,15 @@ namespace planet::vk {
         std::size_t mapping_count = 0u;
         std::byte *mapped_base = nullptr;
 
+        /// Only present for blocks managed by the `free_ranges` strategy
+        std::unique_ptr<device_memory_free_ranges> free_ranges;
+        /**
+         * Where the block is in its pool's `ranged` list, or `not_ranged` once
+         * it has been dropped from it. Guarded by the pool's mutex.
+         */
+        static constexpr std::size_t not_ranged = ~std::size_t{};
+        std::size_t ranged_index = not_ranged;
+
         device_memory_allocation(
                 device_memory_allocator *,
                 handle_type,
@@ -146,6 +183,9 @@ namespace planet::vk {
                 std::size_t const s) noexcept
         : allocation{a}, offset{o}, byte_count{s} {}
 
+        /// Hand the range back to a `free_ranges` block
+        void release_range();
+
       public:
         device_memory() {}
         ~device_memory() { reset(); }
@@ -178,6 +218,7 @@ namespace planet::vk {
 
         /// ### Free the held memory
         void reset() {
+            if (allocation and allocation->free_ranges) { release_range(); }
             device_memory_allocation::decrement(allocation);
             offset = {};
             byte_count = {};
@@ -234,6 +275,7 @@ namespace planet::vk {
      * use of the handed out memory.
      */
     class device_memory_allocator final : private telemetry::id {
+        friend class device_memory;
         friend class device_memory_allocation;
 
 
@@ -250,6 +292,11 @@ namespace planet::vk {
             std::recursive_mutex mtx;
             std::vector<device_memory_allocation::handle_type> free_memory;
             device_memory splitting;
+            /**
+             * Blocks being sub-allocated by the `free_ranges` strategy. The
+             * pool holds one ownership count on each of them.
+             */
+            std::vector<device_memory_allocation *> ranged;
         };
 
 
@@ -295,6 +342,26 @@ namespace planet::vk {
 
 
       private:
+        /// ### Allocation helpers
+
+        /// #### A whole block from the local free list or the shared pool
+        device_memory_allocation::handle_type acquire_block(
+                pool &, std::uint32_t memory_type_index, std::size_t bytes);
+
+        /// #### Allocate using the `free_ranges` strategy
+        device_memory allocate_from_free_ranges(
+                pool &,
+                std::size_t bytes,
+                std::uint32_t memory_type_index,
+                std::size_t alignment);
+
+        /// #### Return a range to its block's free ranges
+        void reclaim(
+                device_memory_allocation *,
+                std::size_t offset,
+                std::size_t bytes);
+
+
         /// ### Telemetry
 
         /// #### Whole blocks drawn fresh from the shared pool (free-list miss)
@@ -368,6 +435,27 @@ namespace planet::vk {
          * this allocator's local free list -- the part of `c_bytes_held` not
          * currently carved into sub-allocations.
          */
+
+        /// ### Free range reuse
+        telemetry::counter c_bytes_reclaimed;
+        /**
+         * Running total of the bytes handed back to block free ranges by the
+         * `free_ranges` strategy. Under the slab strategy these bytes would be
+         * unusable until the rest of their block was also freed.
+         */
+
+        /// #### Allocations placed into a block that was already in use
+        telemetry::counter c_free_range_allocations{
+                name() + "__free_range_allocations"};
+
+        /// #### Blocks dropped from the `free_ranges` set once entirely free
+        telemetry::counter c_free_range_blocks_retired{
+                name() + "__free_range_blocks_retired"};
+        /**
+         * A block whose ranges have all been reclaimed is handed back to the
+         * local free list (unless it is the only one the pool is using) which
+         * is what lets `c_free_blocks` recover during long sessions.
+         */
     };
 
 
@@ -0,0 +1,97 @@
+#pragma once
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+
+namespace planet::vk {
+
+
+    /// ## Segregated-fit index of the free ranges inside one memory block
+    /**
+     * A two-level segregated fit (TLSF) index over the free byte ranges of a
+     * single `device_memory_allocation`. Free ranges are binned first by the
+     * position of their most significant bit and then by the next
+     * `second_level_bits` bits below it. A pair of bitmaps records which bins
+     * are non-empty, so finding a bin whose every range is large enough for a
+     * request is a couple of bit scans regardless of how many ranges are free.
+     *
+     * Released ranges are merged with free neighbours on either side, found
+     * through hash maps keyed by range start and range end, so `release` is
+     * also constant time.
+     *
+     * The type is not thread safe. The allocator guards it with the mutex of
+     * the pool the block belongs to.
+     */
+    class device_memory_free_ranges final {
+      public:
+        /// ### Create the index covering `[0, bytes)`
+        /**
+         * The whole block starts out free.
+         */
+        explicit device_memory_free_ranges(std::size_t bytes);
+
+
+        /// ### Take `bytes` at an offset aligned to `alignment`
+        /**
+         * Returns the offset of the range handed out, or no value if no free
+         * range can hold the request. `alignment` must be a power of two. Any
+         * padding needed to reach the aligned offset, and any tail beyond
+         * `bytes`, stays in the index as free ranges.
+         */
+        std::optional<std::size_t>
+                acquire(std::size_t bytes, std::size_t alignment);
+
+        /// ### Give back a range previously handed out by `acquire`
+        void release(std::size_t offset, std::size_t bytes);
+
+
+        /// ### Queries
+        std::size_t capacity() const noexcept { return block_size; }
+        std::size_t bytes_free() const noexcept { return free_bytes; }
+        bool all_free() const noexcept { return free_bytes == block_size; }
+        /// #### Number of distinct free ranges (after coalescing)
+        std::size_t range_count() const noexcept { return starts.size(); }
+
+
+      private:
+        static constexpr std::size_t second_level_bits = 3;
+        static constexpr std::size_t second_levels = 1u << second_level_bits;
+        static constexpr std::size_t first_levels = 64;
+        static constexpr std::size_t none = ~std::size_t{};
+
+        struct bin_index {
+            std::size_t first, second;
+        };
+        /// #### The bin a range of `bytes` is filed under
+        static bin_index bin_for(std::size_t bytes) noexcept;
+        /// #### The first bin all of whose ranges can hold `bytes`
+        static std::optional<bin_index> bin_at_least(std::size_t bytes) noexcept;
+
+        /// #### A free range, doubly linked into its bin's list
+        struct range {
+            std::size_t bytes, previous, next;
+        };
+
+        void insert(std::size_t offset, std::size_t bytes);
+        void remove(std::size_t offset);
+
+
+        std::size_t block_size, free_bytes;
+
+        /// #### Free ranges keyed by start offset, and end offset to start
+        std::unordered_map<std::size_t, range> starts;
+        std::unordered_map<std::size_t, std::size_t> ends;
+
+        /// #### Bitmaps of non-empty bins and the head of each bin's list
+        std::uint64_t first_level_map = {};
+        std::array<std::uint32_t, first_levels> second_level_maps = {};
+        std::array<std::size_t, first_levels * second_levels> heads;
+    };
+
+
+}
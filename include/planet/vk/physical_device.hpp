@@ -31,6 +31,27 @@ namespace planet::vk {
         std::vector<VkExtensionProperties> extensions;
 
 
+        /// ### Descriptor indexing
+        /**
+         * Only filled in when the device advertises
+         * `VK_EXT_descriptor_indexing`, otherwise all of the features are
+         * `VK_FALSE` and the limits are zero.
+         */
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT
+                descriptor_indexing_features = {};
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT
+                descriptor_indexing_properties = {};
+
+        /// #### Whether bindless textures can be used
+        /**
+         * True when the device has every descriptor indexing feature needed for
+         * a large, partially bound array of combined image samplers that is
+         * updated after being bound and indexed non-uniformly in the fragment
+         * shader.
+         */
+        bool supports_bindless_textures() const noexcept;
+
+
         /// ### API wrappers
 
         /// #### `vkGetPhysicalDeviceFormatProperties`
@@ -0,0 +1,107 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/vk/forward.hpp>
+#include <planet/vk/owned_handle.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <vector>
+
+
+namespace planet::vk {
+
+
+    /// ## Pipeline cache
+    /**
+     * The device owns one of these and every graphics pipeline is created
+     * through it, so a pipeline that the driver has already compiled doesn't
+     * need to be compiled again.
+     *
+     * The cache can be loaded from and saved to a file so that the work is
+     * kept between runs. The file is ignored unless its header matches the
+     * vendor, device and pipeline cache UUID of the GPU in use, which means a
+     * driver update or a new GPU just starts again with an empty cache.
+     */
+    class pipeline_cache final {
+        using handle_type =
+                device_handle<VkPipelineCache, vkDestroyPipelineCache>;
+        handle_type handle;
+
+        vk::device &device;
+        bool warm = false;
+        /// Pipelines may be built on several threads at once
+        std::mutex timing_mutex;
+
+
+      public:
+        explicit pipeline_cache(vk::device &);
+
+
+        VkPipelineCache get() const noexcept { return handle.get(); }
+
+
+        /// ### Create the Vulkan cache
+        /**
+         * Called by the device once it has its handle. Any previous content is
+         * thrown away. Initial data whose header doesn't match the GPU is
+         * ignored.
+         */
+        void create(std::span<std::byte const> initial_data = {});
+        /// ### Destroy the Vulkan cache
+        /// Called by the device before it is destroyed
+        void reset() noexcept { handle.reset(); }
+
+
+        /// ### Persistence
+
+        /// #### Check a cache header against the GPU in use
+        bool is_compatible(std::span<std::byte const>) const noexcept;
+
+        /// #### Merge in the cache data from a file
+        /// Returns `false` if the file is missing or doesn't match this GPU
+        bool load(std::filesystem::path const &);
+
+        /// #### Save the cache data to a file
+        /**
+         * The data is written to a temporary file next to the destination and
+         * then renamed over it, so a crash part way through can't leave a
+         * truncated cache behind.
+         */
+        void save(std::filesystem::path const &) const;
+
+        /// #### The current cache data
+        std::vector<std::byte> data() const;
+
+
+        /// ### Record the time taken to create a pipeline
+        /**
+         * Creation time is reported separately depending on whether the cache
+         * was primed with data from an earlier run. Safe to call from more
+         * than one thread.
+         */
+        void created(std::chrono::steady_clock::duration);
+
+
+        /// ### Telemetry
+
+        /// #### Pipelines created with a primed cache
+        telemetry::counter c_warm_pipelines{
+                "planet_vk_pipeline_cache_warm_pipelines"};
+        /// #### Microseconds spent creating those pipelines
+        telemetry::counter c_warm_us{"planet_vk_pipeline_cache_warm_us"};
+        /// #### Pipelines created from an empty cache
+        telemetry::counter c_cold_pipelines{
+                "planet_vk_pipeline_cache_cold_pipelines"};
+        /// #### Microseconds spent creating those pipelines
+        telemetry::counter c_cold_us{"planet_vk_pipeline_cache_cold_us"};
+        /// #### Cache files rejected because of their header
+        telemetry::counter c_rejected{"planet_vk_pipeline_cache_rejected"};
+    };
+
+
+}
@@ -53,6 +53,20 @@ namespace planet::vk::sdl {
             planet::sdl::surface const &,
             create_parameters = {});
 
+    /// ### Add a surface to a batch of textures
+    /**
+     * Returns the index of the texture in the batch. The surface is read when
+     * the batch is submitted, so it must stay alive until then.
+     */
+    std::size_t add_texture_with_mip_levels(
+            texture_batch &,
+            planet::sdl::surface const &,
+            create_parameters = {});
+    std::size_t add_texture_without_mip_levels(
+            texture_batch &,
+            planet::sdl::surface const &,
+            create_parameters = {});
+
 
     /// ##  Render text and turn it into a Vulkan texture
     inline texture
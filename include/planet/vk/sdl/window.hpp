@@ -31,8 +31,16 @@ namespace planet::vk::sdl {
          * `init`'s `configuration`.
          */
 
+        window(planet::sdl::init &, affine::extents2d fixed_size);
+        /**
+         * No SDL window is created. The window always reports `fixed_size` as
+         * its size and the display's, so a renderer can be driven off-screen
+         * with the same code as for a real window.
+         */
+
 
         SDL_Window *get() const noexcept { return pw.get(); }
+        bool offscreen() const noexcept { return pw.get() == nullptr; }
 
 
         /// ### Refresh the window dimensions
@@ -66,7 +74,11 @@ namespace planet::vk::sdl {
 
         /// ### Display pixel density
         affine::extents2d pixel_density() const noexcept {
-            return planet::sdl::pixel_density(pw.get());
+            if (offscreen()) {
+                return {1.0f, 1.0f};
+            } else {
+                return planet::sdl::pixel_density(pw.get());
+            }
         }
         /**
          * The number of drawable pixels per logical point on the display the
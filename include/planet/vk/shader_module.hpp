@@ -1,10 +1,18 @@
 #pragma once
 
 
+#include <planet/telemetry/counter.hpp>
 #include <planet/vk/helpers.hpp>
 #include <planet/vk/owned_handle.hpp>
 #include <planet/vk/view.hpp>
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
 
 namespace planet::vk {
 
@@ -24,12 +32,74 @@ namespace planet::vk {
 
         device_view device;
         VkShaderModule get() const noexcept { return handle.get(); }
+        std::span<std::byte const> code() const noexcept { return spirv; }
 
         /// Fill in the structure from the shader module
         VkPipelineShaderStageCreateInfo shader_stage_info(
                 VkShaderStageFlagBits,
                 char const *,
-                VkSpecializationInfo const * = nullptr);
+                VkSpecializationInfo const * = nullptr) const;
+    };
+
+
+    /// ## Shader module registry
+    /**
+     * Shared shader modules for the whole device. A module is looked up by
+     * name first, so a file only needs to be read the first time it is used.
+     * New SPIR-V is also checked against the modules already present using a
+     * hash of its content, so the same code under two names only makes one
+     * driver shader module.
+     *
+     * Modules are handed out as shared pointers, which keeps them alive while
+     * a pipeline is being built even if the registry is cleared in the
+     * meantime. All members can be used from any thread.
+     */
+    class shader_modules final {
+      public:
+        explicit shader_modules(vk::device &);
+
+        using module_ptr = std::shared_ptr<shader_module const>;
+
+
+        /// ### Find a module by name
+        /// Returns `nullptr` if there is no module with that name yet
+        module_ptr find(std::string_view name);
+
+        /// ### Add the SPIR-V for a name
+        /**
+         * Returns an existing module if one was created from identical code,
+         * otherwise a new one is made. Any earlier module for the name is
+         * replaced.
+         */
+        module_ptr add(std::string_view name, std::vector<std::byte> spirv);
+
+        /// ### Drop all modules
+        /**
+         * Modules still referenced from elsewhere live on until those
+         * references go. The device calls this before it is destroyed.
+         */
+        void clear();
+
+
+        /// ### Queries
+        std::size_t size() const;
+
+
+        /// ### Telemetry
+
+        /// #### Lookups by name that found a module
+        telemetry::counter c_hits{"planet_vk_shader_modules__hits"};
+        /// #### New names that shared a module with identical code
+        telemetry::counter c_shared{"planet_vk_shader_modules__shared"};
+        /// #### Driver shader modules created
+        telemetry::counter c_created{"planet_vk_shader_modules__created"};
+
+
+      private:
+        vk::device &device;
+        mutable std::mutex mutex;
+        std::map<std::string, module_ptr, std::less<>> by_name;
+        std::multimap<std::uint64_t, module_ptr> by_hash;
     };
 
 
@@ -37,9 +37,19 @@ namespace planet::vk {
                 device_handle<VkSwapchainKHR, vkDestroySwapchainKHR>;
         handle_type handle;
 
+        /// ### Off-screen images
+        /**
+         * When there is an allocator the images are owned by the swap chain
+         * and there is no `VkSwapchainKHR`.
+         */
+        device_memory_allocator *allocator = nullptr;
+        std::uint32_t owned_count = {};
+        std::vector<vk::image> owned_images;
+
         /// ### (Re-)create the swap chain and its attendant items
         std::uint32_t create(VkExtent2D);
         std::uint32_t create(affine::extents2d);
+        std::uint32_t create_offscreen(VkExtent2D);
 
 
       public:
@@ -61,18 +71,44 @@ namespace planet::vk {
             create(ex);
         }
 
+        /// #### Render into images that are never presented
+        /**
+         * Creates `image_count` images of the surface's preferred format at a
+         * fixed size, allocated from `allocator`. The surface is not used for
+         * anything else, so it can be a headless one. There is nothing to
+         * acquire or present: any of the images may be rendered into once the
+         * work that last used it has completed.
+         *
+         * The images are always created with `VK_IMAGE_USAGE_TRANSFER_SRC_BIT`
+         * and are left in `VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL` by a render
+         * pass that uses the `attachment_description`.
+         */
+        template<typename Ex>
+        swap_chain(
+                vk::device &d,
+                device_memory_allocator &a,
+                Ex const ex,
+                std::uint32_t const image_count)
+        : allocator{&a},
+          owned_count{image_count},
+          device{d},
+          transfer{transfer_source::available} {
+            create(ex);
+        }
+
 
         /// ### Queries
         device_view device;
 
         VkSwapchainKHR get() const noexcept { return handle.get(); }
+        bool offscreen() const noexcept { return allocator != nullptr; }
 
 
         /// ### Recreation
         /**
          * Recreate the swap chain and everything dependant on it, for example
          * if the window has changed dimensions. Returns the number of images to
-         * use
+         * use. Off-screen images are re-created at the new size.
          */
         template<typename Ex>
         std::uint32_t recreate(Ex const ex) {
@@ -2,9 +2,13 @@
 
 
 #include <planet/affine/rectangle2d.hpp>
+#include <planet/vk/commands.hpp>
 #include <planet/vk/image.hpp>
 #include <planet/ui/scale.hpp>
 
+#include <span>
+#include <vector>
+
 
 namespace planet::vk {
 
@@ -34,6 +38,9 @@ namespace planet::vk {
     };
 
 
+    struct texture_upload;
+
+
     /// ## Texture map
     class texture final {
       public:
@@ -50,8 +57,25 @@ namespace planet::vk {
             VkFilter filter = VK_FILTER_LINEAR;
             VkBorderColor border_color = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
         };
+        /// #### Create and wait for the upload to complete
         static texture create_with_mip_levels_from(parameters);
         static texture create_without_mip_levels_from(parameters);
+        /// #### Create and return while the upload is still on the GPU
+        /**
+         * The texture can't be sampled until the returned submission has
+         * completed. The staging buffer in the parameters must also stay alive
+         * until then, either by the caller keeping it or by moving it into
+         * `submission::keep_alive`.
+         */
+        static texture_upload upload_with_mip_levels_from(parameters);
+        static texture_upload upload_without_mip_levels_from(parameters);
+
+
+        texture() = default;
+        texture(texture &&) = default;
+        texture &operator=(texture &&);
+        /// #### Destruction tells the device's `texture_observer`s
+        ~texture();
 
 
         /// ### Attributes
@@ -62,6 +86,85 @@ namespace planet::vk {
 
         /// ### Queries
         explicit operator bool() const noexcept;
+
+      private:
+        void release() noexcept;
+    };
+
+
+    /// ## A texture whose upload is still in progress
+    struct texture_upload {
+        vk::texture texture;
+        vk::submission submission;
+    };
+
+
+    /// ## Upload many textures at once
+    /**
+     * Creating textures one at a time costs a staging buffer, a command buffer
+     * and a queue submission each. A batch gathers any number of images and
+     * then, in `submit`, packs all of their pixels into a single staging
+     * buffer, records every layout transition, copy and mip level blit into a
+     * single command buffer and submits that once.
+     *
+     * Pixel data is read when the batch is submitted, not when it is added, so
+     * it must stay alive until then. Pixels are expected to be four bytes
+     * each.
+     */
+    class texture_batch final {
+      public:
+        texture_batch(device_memory_allocator &images, vk::command_pool &);
+        texture_batch(
+                device_memory_allocator &staging,
+                device_memory_allocator &images,
+                vk::command_pool &);
+
+
+        /// ### Image to add to the batch
+        struct image_data {
+            std::span<std::byte const> pixels;
+            std::uint32_t width;
+            std::uint32_t height;
+            /// Bytes from the start of one row to the next, zero if packed
+            std::size_t pitch = {};
+            bool mip_levels = true;
+            ui::scale scale = ui::scale::lock_aspect;
+            VkFormat format = VK_FORMAT_B8G8R8A8_SRGB;
+            VkSamplerAddressMode address_mode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+            VkFilter filter = VK_FILTER_LINEAR;
+            VkBorderColor border_color = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        };
+        /// #### Add an image
+        /// Returns the index of its texture in the submitted batch
+        std::size_t add(image_data);
+
+        /// #### Number of images waiting to be submitted
+        std::size_t size() const noexcept { return pending.size(); }
+
+
+        /// ### Textures created by a batch
+        /**
+         * The textures can't be sampled until the submission has completed.
+         * The submission holds on to the staging buffer until then.
+         */
+        struct upload {
+            std::vector<vk::texture> textures;
+            vk::submission submission;
+        };
+
+        /// ### Upload everything added so far
+        /**
+         * The batch is empty again afterwards and can be re-used.
+         */
+        upload submit();
+        /// #### Upload and wait for it to complete
+        std::vector<vk::texture> create();
+
+
+      private:
+        device_memory_allocator &staging, &images;
+        vk::command_pool &command_pool;
+        std::vector<image_data> pending;
     };
 
 
@@ -0,0 +1,163 @@
+#pragma once
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+
+namespace planet::vk::trace {
+
+
+    /// ## Frame timeline tracing
+    /**
+     * Records begin/end timings from any thread and streams them to a JSON
+     * file in the Chrome trace event format, which can be loaded into
+     * `chrome://tracing` or <https://ui.perfetto.dev>.
+     *
+     * Each thread writes its events into a ring buffer of its own without
+     * taking any locks, and a `session` drains the rings into the file on a
+     * background thread. When no `session` is running a `scope` costs a
+     * single relaxed atomic load.
+     *
+     * Event names and categories are stored as pointers, so they must stay
+     * alive until the session has ended. String literals are always fine, and
+     * anything else should be passed through `intern`.
+     */
+
+
+    using clock = std::chrono::steady_clock;
+
+
+    namespace detail {
+        inline std::atomic<bool> active = false;
+        void record(
+                char const *name,
+                char const *category,
+                clock::time_point start,
+                clock::duration,
+                bool gpu) noexcept;
+    }
+
+
+    /// ### Is a session recording events?
+    inline bool enabled() noexcept {
+        return detail::active.load(std::memory_order_relaxed);
+    }
+
+
+    /// ### Keep a copy of a name for the lifetime of the process
+    /**
+     * Interning the same string again returns the same pointer. Takes a lock,
+     * so check `enabled` first on hot paths.
+     */
+    char const *intern(std::string_view);
+
+
+    /// ### Record an event that has already finished
+    /**
+     * GPU events are shown on a timeline of their own. The CPU events are
+     * shown against the thread that recorded them.
+     */
+    inline void complete(
+            char const *const name,
+            char const *const category,
+            clock::time_point const start,
+            clock::duration const duration,
+            bool const gpu = false) noexcept {
+        if (enabled()) {
+            detail::record(name, category, start, duration, gpu);
+        }
+    }
+
+
+    /// ### Time the lifetime of the scope
+    class scope final {
+        char const *name = nullptr;
+        char const *category = nullptr;
+        clock::time_point started = {};
+
+
+      public:
+        scope(char const *const n, char const *const c) noexcept {
+            if (enabled()) {
+                name = n;
+                category = c;
+                started = clock::now();
+            }
+        }
+        /// The name is only interned when tracing is enabled
+        scope(std::string_view const n, char const *const c) {
+            if (enabled()) {
+                name = intern(n);
+                category = c;
+                started = clock::now();
+            }
+        }
+        scope(scope const &) = delete;
+        scope &operator=(scope const &) = delete;
+        ~scope() { end(); }
+
+        /// #### End the scope early
+        void end() noexcept {
+            if (name) {
+                complete(
+                        std::exchange(name, nullptr), category, started,
+                        clock::now() - started);
+            }
+        }
+    };
+
+
+    /// ## Stream events to a file
+    /**
+     * Only one session may be running at a time. Events are written out every
+     * `flush_interval`, and any still in the rings when the session is
+     * destroyed are written before the file is closed.
+     *
+     * A thread that records events faster than they're written out loses the
+     * events that don't fit in its ring. They are counted in `dropped`.
+     */
+    class session final {
+      public:
+        session(std::filesystem::path,
+                clock::duration flush_interval = std::chrono::milliseconds{
+                        100});
+        ~session();
+
+        session(session const &) = delete;
+        session &operator=(session const &) = delete;
+
+
+        /// ### Write out everything recorded so far
+        void flush();
+
+
+        /// ### Queries
+        std::size_t written() const;
+        static std::size_t dropped() noexcept;
+
+
+      private:
+        std::ofstream file;
+        clock::time_point const origin = clock::now();
+        std::size_t events = {};
+        /// Threads whose names have been written
+        std::size_t named = {};
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+        std::thread writer;
+
+        void drain();
+    };
+
+
+}
@@ -4,10 +4,15 @@
 #include <planet/affine/point3d.hpp>
 #include <planet/array.hpp>
 #include <planet/log.hpp>
+#include <planet/telemetry/counter.hpp>
 #include <planet/telemetry/minmax.hpp>
 #include <planet/vk/descriptors.hpp>
 #include <planet/vk/device.hpp>
 
+#include <algorithm>
+#include <string>
+#include <utility>
+
 
 namespace planet::vk::ubo {
 
@@ -25,17 +30,23 @@ namespace planet::vk::ubo {
         textures(
                 std::string_view const name,
                 vk::device &d,
-                std::uint32_t max_textures_per_frame,
+                std::uint32_t initial_textures_per_frame,
                 std::source_location const &loc =
                         std::source_location::current())
         : device{d},
-          max_per_frame{max_textures_per_frame},
-          textures_in_frame{std::string{name} + "__textures_in_frame", loc} {}
+          initial_per_frame{std::max(initial_textures_per_frame, 1u)},
+          textures_in_frame{std::string{name} + "__textures_in_frame", loc},
+          write_hits{std::string{name} + "__descriptor_write_hits"},
+          write_misses{std::string{name} + "__descriptor_write_misses"},
+          allocators{make_allocators(
+                  name, std::make_index_sequence<Frames>{})} {}
 
 
         /// ### Configuration
         vk::device &device;
-        std::uint32_t max_per_frame;
+        /// #### Size of the first descriptor pool for each frame index
+        /// Further pools are added as needed, there is no upper limit
+        std::uint32_t initial_per_frame;
         telemetry::max textures_in_frame;
 
 
@@ -47,12 +58,78 @@ namespace planet::vk::ubo {
                  .descriptorCount = 1,
                  .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
                  .pImmutableSamplers = nullptr}};
-        vk::descriptor_pool pool{
-                device, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                static_cast<std::uint32_t>(Frames *max_per_frame)};
-        std::array<vk::descriptor_sets, Frames> sets = array_of<Frames>([&]() {
-            return vk::descriptor_sets{pool, layout, max_per_frame};
-        });
+
+        /// #### The set for a texture index within a frame
+        /**
+         * Sets are kept from one use of the frame index to the next so that
+         * unchanged sets don't need to be written again. Asking for an index
+         * past the end allocates more sets, so the number of textures in a
+         * frame is only limited by device memory.
+         */
+        VkDescriptorSet
+                set(std::size_t const frame_index, std::uint32_t const index) {
+            auto &frame = sets[frame_index];
+            while (index >= frame.size()) {
+                frame.push_back(allocators[frame_index].allocate(layout));
+                written[frame_index].emplace_back();
+            }
+            return frame[index];
+        }
+
+
+        /// ### Descriptor writes
+
+        /// #### Point a set at a texture
+        /**
+         * The write is skipped if the set for this frame index was already
+         * written with the same image view and sampler the last time the frame
+         * index came around. Otherwise it is queued until `flush`.
+         *
+         * The cache trusts that a view and sampler handle pair still refers
+         * to the same objects, so textures must not be destroyed and
+         * recreated with the same handles while sets point at them.
+         */
+        void write(
+                std::size_t const frame_index,
+                std::uint32_t const index,
+                VkDescriptorImageInfo const &image) {
+            auto const dst = set(frame_index, index);
+            auto &current = written[frame_index][index];
+            if (current.first == image.imageView
+                and current.second == image.sampler) {
+                ++write_hits;
+            } else {
+                ++write_misses;
+                current = {image.imageView, image.sampler};
+                pending.write(
+                        dst, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                        image);
+            }
+        }
+        /// #### Send the queued writes to the driver
+        /// Must be called before any of the written sets are bound
+        void flush() { pending.flush(device); }
+
+        /// #### Cache hits and misses
+        telemetry::counter write_hits, write_misses;
+
+
+      private:
+        /// Each frame index gets its own telemetry names
+        template<std::size_t... Frame>
+        std::array<vk::descriptor_allocator, Frames> make_allocators(
+                std::string_view const name, std::index_sequence<Frame...>) {
+            return {vk::descriptor_allocator{
+                    std::string{name} + "__frame" + std::to_string(Frame),
+                    device, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    initial_per_frame}...};
+        }
+
+        std::array<vk::descriptor_allocator, Frames> allocators;
+        std::array<std::vector<VkDescriptorSet>, Frames> sets;
+        vk::descriptor_writes pending;
+        std::array<std::vector<std::pair<VkImageView, VkSampler>>, Frames>
+                written;
     };
 
 
@@ -0,0 +1,239 @@
+#pragma once
+
+
+#include <planet/telemetry/counter.hpp>
+#include <planet/vk/buffer.hpp>
+#include <planet/vk/commands.hpp>
+#include <planet/vk/image.hpp>
+#include <planet/vk/synchronisation.hpp>
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+namespace planet::vk {
+
+
+    /// ## Upload engine
+    /**
+     * Copies data from the CPU into buffers and images that live in device
+     * local memory. Copies are recorded into the current batch, and nothing is
+     * sent to the GPU until `submit` is called, so loading a large number of
+     * meshes or textures costs one queue submission rather than one each.
+     *
+     * The source data is written into persistently mapped, host coherent
+     * staging chunks. The chunks used by a batch are handed back for re-use
+     * once the batch's fence is signalled, so after warm up no new staging
+     * memory is allocated.
+     *
+     * When the device has a dedicated transfer queue the copies run on it.
+     * The batch then ends with queue family ownership release barriers, and a
+     * second, small, submission on the graphics queue waits on a semaphore
+     * and performs the matching acquire barriers. Without a transfer queue
+     * (lavapipe, for example) everything is recorded into a single command
+     * buffer on the graphics queue and plain barriers are used instead.
+     *
+     * All of the calls must be made from the same thread, and the engine must
+     * be destroyed before the device. Its destructor waits for any batches
+     * that are still in flight.
+     */
+    class upload_engine final {
+      public:
+        /// ### Configuration
+        struct configuration {
+            /// #### Size of each staging chunk
+            /**
+             * Copies larger than this get a chunk of their own size.
+             */
+            std::size_t chunk_size = 8u << 20;
+        };
+
+
+        upload_engine(
+                vk::device &, vk::surface const &, configuration const & = {});
+        ~upload_engine();
+
+        upload_engine(upload_engine const &) = delete;
+        upload_engine &operator=(upload_engine const &) = delete;
+
+
+        /// ### Completion of a submitted batch
+        /**
+         * Cheap to copy, and stays valid after the engine has recycled the
+         * batch. A ticket for an empty batch is always complete.
+         */
+        class ticket final {
+            friend class upload_engine;
+            std::shared_ptr<vk::fence const> done;
+
+
+          public:
+            /// #### Queries
+            bool is_complete() const;
+            /**
+             * Hand it to something that can wait without blocking, like
+             * `engine::gpu_completion`. Throws for the empty ticket returned
+             * when there was nothing to submit, which has no fence.
+             */
+            vk::fence const &fence() const;
+            explicit operator bool() const noexcept {
+                return static_cast<bool>(done);
+            }
+
+            /// #### Block until the batch has finished
+            void wait() const;
+        };
+
+
+        /// ### Record copies into the current batch
+
+        /// #### Copy into a buffer
+        /**
+         * The stage and access masks describe how the destination is used
+         * once the copy has finished, for example
+         * `VK_PIPELINE_STAGE_VERTEX_INPUT_BIT` and
+         * `VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT` for a vertex buffer.
+         */
+        void copy(
+                std::span<std::byte const> data,
+                VkBuffer destination,
+                VkDeviceSize destination_offset,
+                VkPipelineStageFlags destination_stage,
+                VkAccessFlags destination_access);
+        template<typename T>
+        void copy(
+                std::span<T const> const items,
+                buffer<T> &destination,
+                VkPipelineStageFlags const destination_stage,
+                VkAccessFlags const destination_access,
+                std::size_t const first_item = {}) {
+            copy(std::as_bytes(items), destination.get(),
+                 first_item * sizeof(T), destination_stage, destination_access);
+        }
+
+        /// #### Copy into the first mip level of an image
+        /**
+         * The whole image is overwritten and then moved to `final_layout`.
+         * The data must hold at least `width * height` tightly packed texels,
+         * otherwise a `felspar::stdexcept::logic_error` is thrown.
+         */
+        void copy(
+                std::span<std::byte const> data,
+                vk::image &destination,
+                VkImageLayout final_layout =
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VkPipelineStageFlags destination_stage =
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VkAccessFlags destination_access = VK_ACCESS_SHADER_READ_BIT);
+
+
+        /// ### Send the current batch to the GPU
+        /**
+         * Batches that have already finished are recycled first. Any
+         * destination used in this batch must not be used by other GPU work
+         * until the returned ticket is complete.
+         */
+        ticket submit();
+
+        /// ### Recycle the staging memory of finished batches
+        void retire();
+
+        /// ### Block until every submitted batch has finished
+        void wait_idle();
+
+
+        /// ### Queries
+
+        /// #### True if copies run on a dedicated transfer queue
+        bool has_transfer_queue() const noexcept {
+            return transfer_pool.has_value();
+        }
+        /// #### Copies recorded since the last `submit`
+        std::size_t pending_copies() const noexcept { return recording.copies; }
+        /// #### Submitted batches that haven't been retired
+        std::size_t batches_in_flight() const noexcept {
+            return in_flight.size();
+        }
+
+
+        /// ### Telemetry
+
+        /// #### Batches submitted
+        telemetry::counter c_batches{"planet_vk_upload_engine_batches"};
+        /// #### Copies recorded
+        telemetry::counter c_copies{"planet_vk_upload_engine_copies"};
+        /// #### Bytes written to staging memory
+        telemetry::counter c_bytes{"planet_vk_upload_engine_bytes"};
+        /// #### Staging chunks created
+        /**
+         * Finished batches are retired before a new chunk is made, so this is
+         * only bumped during warm up and when more data is in flight than at
+         * any time before.
+         */
+        telemetry::counter c_chunks_created{
+                "planet_vk_upload_engine_chunks_created"};
+
+
+      private:
+        configuration config;
+        device_view device;
+        device_memory_allocator allocator;
+
+        std::uint32_t graphics_family, transfer_family;
+        vk::command_pool graphics_pool;
+        std::optional<vk::command_pool> transfer_pool;
+
+
+        struct chunk {
+            buffer<std::byte> memory;
+            device_memory::mapping mapping;
+        };
+        std::vector<chunk> spare;
+
+        /// Allocate staging memory in the current batch
+        struct staging {
+            VkBuffer buffer;
+            VkDeviceSize offset;
+        };
+        staging allocate(std::span<std::byte const>, std::size_t alignment);
+
+
+        struct batch {
+            command_buffer transfer, acquire;
+            std::vector<chunk> chunks;
+            std::unique_ptr<vk::semaphore> handoff;
+            std::shared_ptr<vk::fence> done;
+        };
+        std::deque<batch> in_flight;
+
+        /// The batch being recorded
+        struct {
+            command_buffer commands;
+            std::vector<chunk> chunks;
+            std::size_t offset = {};
+            std::size_t copies = {};
+
+            /**
+             * Barriers recorded at the end of the transfer command buffer.
+             * With a dedicated transfer queue these are the release half of
+             * the ownership transfer, otherwise they are the only barriers.
+             */
+            std::vector<VkBufferMemoryBarrier> buffer_releases;
+            std::vector<VkImageMemoryBarrier> image_releases;
+            /// The acquire half, only used with a dedicated transfer queue
+            std::vector<VkBufferMemoryBarrier> buffer_acquires;
+            std::vector<VkImageMemoryBarrier> image_acquires;
+            VkPipelineStageFlags destination_stages = {};
+        } recording;
+
+        command_buffer &commands();
+        bool transfers_ownership() const noexcept {
+            return transfer_family != graphics_family;
+        }
+    };
+
+
+}
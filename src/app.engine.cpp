@@ -1,8 +1,10 @@
 #include <planet/vk/engine/app.hpp>
+#include <planet/vk/headless.hpp>
 #include <planet/vk/engine/renderer.hpp>
 
 #include <planet/platform.hpp>
 
+#include <SDL3/SDL_filesystem.h>
 #include <SDL3/SDL_vulkan.h>
 
 #include <cstdlib>
@@ -55,6 +57,22 @@ namespace {
     }
 
 
+    /// ## Per-user location of the pipeline cache
+    std::filesystem::path
+            pipeline_cache_filename(planet::version const &version) {
+        char *const pref = SDL_GetPrefPath(
+                nullptr, version.application_id.c_str());
+        if (not pref) {
+            planet::log::warning(
+                    "No user data path for the pipeline cache", SDL_GetError());
+            return {};
+        }
+        std::filesystem::path filename{pref};
+        SDL_free(pref);
+        return filename / "pipeline.cache";
+    }
+
+
 }
 
 
@@ -93,7 +111,47 @@ planet::vk::engine::app::app(
                   }
                   return surface_handle;
               }};
-  }()} {}
+  }()},
+  pipeline_cache_filename{::pipeline_cache_filename(version)} {
+    if (not pipeline_cache_filename.empty()) {
+        device.pipeline_cache.load(pipeline_cache_filename);
+    }
+}
+
+
+planet::vk::engine::app::app(
+        int,
+        char const *argv[],
+        planet::sdl::init &s,
+        planet::version const &version,
+        offscreen const config)
+: asset_manager{configure_bundle(argv[0])},
+  sdl{s},
+  window{sdl, config.extents},
+  extensions{headless::instance_extensions()},
+  instance{[&]() {
+      auto app_info = planet::vk::application_info();
+      app_info.pApplicationName = version.application_id.c_str();
+      app_info.applicationVersion = VK_MAKE_VERSION(
+              version.semver.major, version.semver.minor, version.semver.patch);
+      auto info = planet::vk::instance::info(extensions, app_info);
+      return planet::vk::instance{extensions, info, headless::create_surface};
+  }()},
+  pipeline_cache_filename{::pipeline_cache_filename(version)} {
+    if (not pipeline_cache_filename.empty()) {
+        device.pipeline_cache.load(pipeline_cache_filename);
+    }
+}
+
+
+planet::vk::engine::app::~app() {
+    if (pipeline_cache_filename.empty()) { return; }
+    try {
+        device.pipeline_cache.save(pipeline_cache_filename);
+    } catch (std::exception const &e) {
+        planet::log::error("Saving the pipeline cache failed", e.what());
+    }
+}
 
 
 int planet::vk::engine::app::run(
@@ -0,0 +1,168 @@
+#include <planet/vk/device.hpp>
+#include <planet/vk/engine/bindless_textures.hpp>
+#include <planet/vk/instance.hpp>
+
+#include <felspar/exceptions/logic_error.hpp>
+#include <felspar/exceptions/runtime_error.hpp>
+
+#include <algorithm>
+#include <string>
+
+
+/// ## `planet::vk::engine::bindless_textures`
+
+
+namespace {
+    std::uint32_t clamp_capacity(
+            planet::vk::device const &device, std::uint32_t const requested) {
+        if (not device.bindless_textures) {
+            throw felspar::stdexcept::logic_error{
+                    "The device has not enabled bindless textures"};
+        }
+        auto const &limits = device.instance.gpu().descriptor_indexing_properties;
+        return std::min(
+                {requested, limits.maxDescriptorSetUpdateAfterBindSamplers,
+                 limits.maxDescriptorSetUpdateAfterBindSampledImages,
+                 limits.maxPerStageDescriptorUpdateAfterBindSamplers,
+                 limits.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    }
+
+    planet::vk::descriptor_set_layout
+            create_layout(planet::vk::device &d, std::uint32_t const capacity) {
+        VkDescriptorSetLayoutBinding const binding{
+                .binding = 0,
+                .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                .descriptorCount = capacity,
+                .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .pImmutableSamplers = nullptr};
+        VkDescriptorBindingFlagsEXT const flags =
+                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT
+                | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT
+                | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT const binding_flags{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+                .pNext = nullptr,
+                .bindingCount = 1,
+                .pBindingFlags = &flags};
+        VkDescriptorSetLayoutCreateInfo const info{
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .pNext = &binding_flags,
+                .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT,
+                .bindingCount = 1,
+                .pBindings = &binding};
+        return {d, info};
+    }
+}
+
+
+planet::vk::engine::bindless_textures::bindless_textures(
+        std::string_view const n,
+        vk::device &d,
+        std::uint32_t const requested_capacity,
+        id::suffix const s)
+: id{n, s},
+  capacity{clamp_capacity(d, requested_capacity)},
+  layout{create_layout(d, capacity)},
+  pool{d,
+       std::array{VkDescriptorPoolSize{
+               .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+               .descriptorCount = capacity}},
+       1, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT},
+  device{d},
+  sets{pool, layout, 1} {
+    slots.reserve(capacity);
+    device.observe_textures(*this);
+}
+
+
+planet::vk::engine::bindless_textures::~bindless_textures() {
+    device.stop_observing_textures(*this);
+}
+
+
+std::uint32_t planet::vk::engine::bindless_textures::slot_for(
+        VkImageView const image_view, VkSampler const sampler) {
+    std::scoped_lock _{mutex};
+    auto const key = std::pair{image_view, sampler};
+    if (auto const found = lookup.find(key); found != lookup.end()) {
+        slots[found->second].last_used = frame;
+        return found->second;
+    }
+
+    if (slots.size() < capacity) {
+        auto const index = static_cast<std::uint32_t>(slots.size());
+        slots.push_back({image_view, sampler, frame});
+        lookup.emplace(key, index);
+        write(index, image_view, sampler);
+        return index;
+    }
+
+    /**
+     * The table is full so look for the least recently used slot. It can only
+     * be reused if the last frame that drew with it has finished on the GPU.
+     */
+    auto const lru = std::ranges::min_element(slots, {}, &slot::last_used);
+    if (lru->last_used + max_frames_in_flight <= frame) {
+        auto const index = static_cast<std::uint32_t>(lru - slots.begin());
+        if (lru->image_view) { lookup.erase({lru->image_view, lru->sampler}); }
+        *lru = {image_view, sampler, frame};
+        lookup.emplace(key, index);
+        write(index, image_view, sampler);
+        ++c_recycled;
+        return index;
+    }
+
+    ++c_full;
+    throw felspar::stdexcept::runtime_error{
+            "Bindless texture table is full and every slot may still be in "
+            "use. Capacity "
+            + std::to_string(capacity)};
+}
+
+
+void planet::vk::engine::bindless_textures::forget(
+        VkImageView const image_view, VkSampler const sampler) {
+    std::scoped_lock _{mutex};
+    if (auto const found = lookup.find({image_view, sampler});
+        found != lookup.end()) {
+        auto &s = slots[found->second];
+        s.image_view = VK_NULL_HANDLE;
+        s.sampler = VK_NULL_HANDLE;
+        lookup.erase(found);
+        ++c_forgotten;
+    }
+}
+
+
+void planet::vk::engine::bindless_textures::next_frame() noexcept {
+    std::scoped_lock _{mutex};
+    ++frame;
+}
+
+
+std::size_t planet::vk::engine::bindless_textures::size() const noexcept {
+    std::scoped_lock _{mutex};
+    return slots.size();
+}
+
+
+void planet::vk::engine::bindless_textures::write(
+        std::uint32_t const index,
+        VkImageView const image_view,
+        VkSampler const sampler) {
+    ++c_writes;
+    VkDescriptorImageInfo const texture_info{
+            .sampler = sampler,
+            .imageView = image_view,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+
+    VkWriteDescriptorSet wds{};
+    wds.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    wds.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    wds.dstSet = set();
+    wds.dstBinding = 0;
+    wds.dstArrayElement = index;
+    wds.descriptorCount = 1;
+    wds.pImageInfo = &texture_info;
+    vkUpdateDescriptorSets(device.get(), 1, &wds, 0, nullptr);
+}
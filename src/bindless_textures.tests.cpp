@@ -0,0 +1,192 @@
+#include <planet/log.hpp>
+#include <planet/vk/device.hpp>
+#include <planet/vk/engine/bindless_textures.hpp>
+#include <planet/vk/headless.hpp>
+#include <planet/vk/image.hpp>
+#include <planet/vk/texture.hpp>
+
+#include <felspar/test.hpp>
+
+#include <thread>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("engine::bindless_textures", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ### A view and sampler to put into the table
+    struct sampled_image {
+        planet::vk::image image;
+        planet::vk::image_view view;
+        planet::vk::sampler sampler;
+
+        sampled_image(planet::vk::device &device)
+        : image{device.startup_memory,
+                4,
+                4,
+                1,
+                VK_SAMPLE_COUNT_1_BIT,
+                VK_FORMAT_R8G8B8A8_UNORM,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT},
+          view{image, VK_IMAGE_ASPECT_COLOR_BIT},
+          sampler{{.device = device}} {}
+    };
+
+
+    /// ## Textures keep their slot
+    auto const slots = suite.test("slots", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk or not vk->device.bindless_textures) { return; }
+
+        planet::vk::engine::bindless_textures table{
+                "slots", vk->device, 16, planet::telemetry::id::suffix::add};
+        sampled_image a{vk->device}, b{vk->device};
+
+        auto const first = table.slot_for(a.view.get(), a.sampler.get());
+        auto const second = table.slot_for(b.view.get(), b.sampler.get());
+        check(first) != second;
+        check(table.slot_for(a.view.get(), a.sampler.get())) == first;
+        check(table.size()) == 2u;
+    });
+
+
+    /// ## Full tables recycle slots after a render cycle
+    /**
+     * A slot can't be given to another texture until the frames that might
+     * still be sampling from it have completed.
+     */
+    auto const recycles = suite.test("recycles", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk or not vk->device.bindless_textures) { return; }
+
+        planet::vk::engine::bindless_textures table{
+                "recycles", vk->device, 2, planet::telemetry::id::suffix::add};
+        sampled_image a{vk->device}, b{vk->device}, c{vk->device};
+
+        check(table.slot_for(a.view.get(), a.sampler.get())) == 0u;
+        check(table.slot_for(b.view.get(), b.sampler.get())) == 1u;
+
+        /// Both slots may still be in use, so there is nowhere to put `c`
+        table.next_frame();
+        check([&]() {
+            table.slot_for(c.view.get(), c.sampler.get());
+        }).throws(std::runtime_error{
+                "Bindless texture table is full and every slot may still be "
+                "in use. Capacity 2"});
+        check(table.c_full.value()) == 1;
+        check(table.size()) == 2u;
+
+        /// A full cycle later `a`'s slot is handed over to `c`
+        for (std::size_t frame{1};
+             frame < planet::vk::engine::max_frames_in_flight; ++frame) {
+            table.next_frame();
+        }
+        check(table.slot_for(c.view.get(), c.sampler.get())) == 0u;
+
+        /// `a` has lost its slot and now takes over `b`'s
+        table.next_frame();
+        check(table.slot_for(a.view.get(), a.sampler.get())) == 1u;
+        check(table.slot_for(c.view.get(), c.sampler.get())) == 0u;
+        check(table.size()) == 2u;
+    });
+
+
+
+    /// ## Forgotten textures are written into the table again
+    /**
+     * The driver may give a new texture the handles of one that has been
+     * destroyed, so after `forget` the same handles must not find the old
+     * slot.
+     */
+    auto const forgets = suite.test("forget", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk or not vk->device.bindless_textures) { return; }
+
+        planet::vk::engine::bindless_textures table{
+                "forget", vk->device, 16, planet::telemetry::id::suffix::add};
+        sampled_image a{vk->device}, b{vk->device};
+
+        auto const first = table.slot_for(a.view.get(), a.sampler.get());
+        table.slot_for(b.view.get(), b.sampler.get());
+        table.forget(a.view.get(), a.sampler.get());
+        check(table.c_forgotten.value()) == 1;
+
+        check(table.slot_for(a.view.get(), a.sampler.get())) != first;
+        check(table.c_writes.value()) == 3;
+    });
+
+
+    /// ## Destroying a texture drops it from the table
+    auto const destroyed = suite.test("texture-destroyed", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk or not vk->device.bindless_textures) { return; }
+
+        planet::vk::engine::bindless_textures table{
+                "destroyed", vk->device, 16,
+                planet::telemetry::id::suffix::add};
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+        std::vector<std::byte> const pixels(4 * 4 * 4, std::byte{0x80});
+        planet::vk::texture_batch batch{vk->device.startup_memory, pool};
+        batch.add({.pixels = pixels, .width = 4, .height = 4});
+        auto textures = batch.create();
+        table.slot_for(textures[0]);
+
+        /// Moving a texture doesn't destroy it
+        auto moved = std::move(textures[0]);
+        textures.clear();
+        check(table.c_forgotten.value()) == 0;
+
+        moved = {};
+        check(table.c_forgotten.value()) == 1;
+    });
+
+
+
+    /// ## Pipelines recorded on several threads share the table
+    /**
+     * Every thread looks up the same textures, as pipelines drawing the same
+     * sprite sheet would, and they must all agree on the slots.
+     */
+    auto const threads = suite.test("threads", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk or not vk->device.bindless_textures) { return; }
+
+        planet::vk::engine::bindless_textures table{
+                "threads", vk->device, 64, planet::telemetry::id::suffix::add};
+        std::vector<sampled_image> images;
+        images.reserve(16);
+        for (std::size_t index{}; index < 16; ++index) {
+            images.emplace_back(vk->device);
+        }
+
+        constexpr std::size_t thread_count = 4;
+        std::array<std::vector<std::uint32_t>, thread_count> found;
+        std::vector<std::thread> recorders;
+        for (auto &slots : found) {
+            recorders.emplace_back([&]() {
+                for (std::size_t round{}; round < 100; ++round) {
+                    slots.clear();
+                    for (auto const &image : images) {
+                        slots.push_back(table.slot_for(
+                                image.view.get(), image.sampler.get()));
+                    }
+                    table.next_frame();
+                }
+            });
+        }
+        for (auto &t : recorders) { t.join(); }
+
+        for (auto const &slots : found) { check(slots == found[0]) == true; }
+        check(table.size()) == images.size();
+        check(table.c_writes.value()) == 16;
+    });
+
+
+}
@@ -0,0 +1,95 @@
+#include <planet/vk/command_pools.hpp>
+#include <planet/vk/device.hpp>
+#include <planet/vk/surface.hpp>
+
+#include <felspar/exceptions/logic_error.hpp>
+
+#include <mutex>
+
+
+/// ## `planet::vk::command_pools`
+
+
+planet::vk::command_pools::command_pools(
+        vk::device &d, vk::surface const &s, std::size_t const fif)
+: device{d}, frames{fif}, graphics_family{s.graphics_queue_family_index()} {
+    if (frames == 0) {
+        throw felspar::stdexcept::logic_error{
+                "There must be at least one frame in flight"};
+    }
+}
+
+
+auto planet::vk::command_pools::pool(
+        std::size_t const frame_index, std::uint32_t const family)
+        -> vk::command_pool & {
+    return lookup(frame_index, family).pool;
+}
+
+
+auto planet::vk::command_pools::allocate(
+        std::size_t const frame_index,
+        std::uint32_t const family,
+        VkCommandBufferLevel const level) -> command_buffer & {
+    auto &e = lookup(frame_index, family);
+    auto &buffers = e.buffers[level];
+    auto &used = e.used[level];
+    if (used == buffers.size()) {
+        VkCommandBuffer handle = VK_NULL_HANDLE;
+        VkCommandBufferAllocateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        info.commandPool = e.pool.get();
+        info.level = level;
+        info.commandBufferCount = 1;
+        worked(vkAllocateCommandBuffers(device.get(), &info, &handle));
+        buffers.push_back(command_buffer{e.pool, handle});
+        /// Telemetry is shared between threads, so bump it under the lock
+        std::unique_lock _{mutex};
+        ++c_allocated;
+    }
+    return buffers[used++];
+}
+
+
+void planet::vk::command_pools::retire(std::size_t const frame_index) {
+    std::shared_lock _{mutex};
+    for (auto &[k, e] : entries) {
+        if (std::get<0>(k) == frame_index) {
+            worked(vkResetCommandPool(device.get(), e->pool.get(), {}));
+            e->used = {};
+            ++c_resets;
+        }
+    }
+}
+
+
+std::size_t planet::vk::command_pools::size() const {
+    std::shared_lock _{mutex};
+    return entries.size();
+}
+
+
+auto planet::vk::command_pools::lookup(
+        std::size_t const frame_index, std::uint32_t const family)
+        -> entry & {
+    if (frame_index >= frames) {
+        throw felspar::stdexcept::logic_error{
+                "The frame index is larger than the number of frames in "
+                "flight"};
+    }
+    key const k{frame_index, family, std::this_thread::get_id()};
+    {
+        std::shared_lock _{mutex};
+        if (auto const found = entries.find(k); found != entries.end()) {
+            return *found->second;
+        }
+    }
+    VkQueue queue = VK_NULL_HANDLE;
+    vkGetDeviceQueue(device.get(), family, 0, &queue);
+    auto created = std::make_unique<entry>(entry{vk::command_pool{
+            device(), family, queue, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT}});
+    std::unique_lock _{mutex};
+    auto [position, inserted] = entries.try_emplace(k, std::move(created));
+    if (inserted) { ++c_pools; }
+    return *position->second;
+}
@@ -0,0 +1,78 @@
+#include <planet/log.hpp>
+#include <planet/vk/command_pools.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <felspar/test.hpp>
+
+#include <stdexcept>
+#include <thread>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::command_pools", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Retiring a frame hands its buffers out again
+    auto const recycles = suite.test("recycle", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::command_pools pools{vk->device, vk->instance.surface, 2};
+        std::vector<VkCommandBuffer> first;
+        for (std::size_t index{}; index < 3; ++index) {
+            auto &cb = pools.allocate(0);
+            cb.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+            cb.end();
+            cb.submit();
+            first.push_back(cb.get());
+        }
+        pools.allocate(1, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+        vkQueueWaitIdle(vk->device.graphics_queue);
+        check(pools.size()) == 2u;
+        check(pools.c_allocated.value()) == 4;
+
+        pools.retire(0);
+        check(pools.c_resets.value()) == 1;
+        for (auto const handle : first) {
+            check(pools.allocate(0).get()) == handle;
+        }
+        check(pools.c_allocated.value()) == 4;
+        check(pools.size()) == 2u;
+    });
+
+
+    /// ## Each thread gets its own pool
+    auto const threads = suite.test("threads", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::command_pools pools{vk->device, vk->instance.surface, 2};
+        VkCommandPool mine = pools.pool(0).get(), theirs = VK_NULL_HANDLE;
+        std::thread{[&]() { theirs = pools.pool(0).get(); }}.join();
+        check(theirs) != mine;
+        check(pools.pool(0).get()) == mine;
+        check(pools.size()) == 2u;
+        check(pools.c_pools.value()) == 2;
+    });
+
+
+    /// ## Frame indexes must be in range
+    auto const range = suite.test("frame-index", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::command_pools pools{vk->device, vk->instance.surface, 2};
+        check([&]() {
+            pools.allocate(2);
+        }).throws(std::logic_error{
+                "The frame index is larger than the number of frames in "
+                "flight"});
+    });
+
+
+}
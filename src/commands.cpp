@@ -4,6 +4,7 @@
 #include <planet/vk/surface.hpp>
 
 #include <array>
+#include <limits>
 
 
 /// ## `planet::vk::command_buffers`
@@ -63,6 +64,7 @@ planet::vk::command_buffer::command_buffer(
 planet::vk::command_buffer::command_buffer(command_buffer &&b)
 : handle{std::exchange(b.handle, VK_NULL_HANDLE)},
   queue{std::exchange(b.queue, VK_NULL_HANDLE)},
+  self_owned{std::exchange(b.self_owned, false)},
   device{std::move(b.device)},
   command_pool{std::move(b.command_pool)} {}
 
@@ -72,6 +74,7 @@ auto planet::vk::command_buffer::operator=(command_buffer &&cb)
     reset();
     handle = std::exchange(cb.handle, VK_NULL_HANDLE);
     queue = std::exchange(cb.queue, VK_NULL_HANDLE);
+    self_owned = std::exchange(cb.self_owned, false);
     device = std::move(cb.device);
     command_pool = std::move(cb.command_pool);
     return *this;
@@ -101,6 +104,10 @@ void planet::vk::command_buffer::end_and_submit() {
     submit();
     vkQueueWaitIdle(queue);
 }
+auto planet::vk::command_buffer::end_and_submit_async() && -> submission {
+    end();
+    return submission{std::move(*this)};
+}
 
 
 void planet::vk::command_buffer::begin(VkCommandBufferUsageFlags const flags) {
@@ -111,16 +118,67 @@ void planet::vk::command_buffer::begin(VkCommandBufferUsageFlags const flags) {
 }
 
 
+void planet::vk::command_buffer::begin(
+        VkCommandBufferUsageFlags const flags,
+        VkCommandBufferInheritanceInfo const &inheritance) {
+    VkCommandBufferBeginInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    info.flags = flags;
+    info.pInheritanceInfo = &inheritance;
+    worked(vkBeginCommandBuffer(handle, &info));
+}
+
+
 void planet::vk::command_buffer::end() { worked(vkEndCommandBuffer(handle)); }
 
 
-void planet::vk::command_buffer::submit() {
+void planet::vk::command_buffer::submit(VkFence const fence) {
     std::array buffers{handle};
     VkSubmitInfo info{};
     info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     info.commandBufferCount = buffers.size();
     info.pCommandBuffers = buffers.data();
-    vkQueueSubmit(queue, 1, &info, VK_NULL_HANDLE);
+    vkQueueSubmit(queue, 1, &info, fence);
+}
+
+
+/// ## `planet::vk::submission`
+
+
+planet::vk::submission::submission(command_buffer cb)
+: commands{std::move(cb)},
+  done{std::make_unique<vk::fence>(commands.device())} {
+    /// Fences are created signalled
+    done->reset();
+    commands.submit(done->get());
+}
+
+
+auto planet::vk::submission::operator=(submission &&s) -> submission & {
+    wait();
+    commands = std::move(s.commands);
+    done = std::move(s.done);
+    held = std::move(s.held);
+    return *this;
+}
+
+
+planet::vk::submission::~submission() { wait(); }
+
+
+bool planet::vk::submission::is_complete() const {
+    return not done or done->is_ready();
+}
+
+
+void planet::vk::submission::wait() {
+    if (done) {
+        auto const handle = done->get();
+        planet::vk::worked(vkWaitForFences(
+                commands.device.get(), 1, &handle, VK_TRUE,
+                std::numeric_limits<std::uint64_t>::max()));
+        held.clear();
+    }
 }
 
 
@@ -145,10 +203,25 @@ planet::vk::command_pool::command_pool(vk::device &d, vk::queue q)
     handle.create<vkCreateCommandPool>(device.get(), info);
 }
 
+planet::vk::command_pool::command_pool(
+        vk::device &d,
+        std::uint32_t const family,
+        VkQueue const q,
+        VkCommandPoolCreateFlags const flags)
+: family_queue{q}, device{d} {
+    VkCommandPoolCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    info.flags = flags;
+    info.queueFamilyIndex = family;
+    handle.create<vkCreateCommandPool>(device.get(), info);
+}
+
 
 VkQueue planet::vk::command_pool::command_queue() {
     if (queue) {
         return queue.get();
+    } else if (family_queue) {
+        return family_queue;
     } else {
         return device().graphics_queue;
     }
@@ -0,0 +1,52 @@
+#include <planet/log.hpp>
+#include <planet/vk/commands.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::submission", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Held resources are released once the GPU is done
+    auto const keeps = suite.test("keep-alive", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+        auto const staging = std::make_shared<int>(42);
+
+        auto submitted = planet::vk::command_buffer::single_use(pool)
+                                 .end_and_submit_async();
+        submitted.keep_alive(staging);
+        check(staging.use_count()) == 2;
+
+        submitted.wait();
+        check(submitted.is_complete()) == true;
+        check(staging.use_count()) == 1;
+    });
+
+
+    /// ## Destroying a submission waits for it
+    auto const destroys = suite.test("destroy-waits", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+        auto const staging = std::make_shared<int>(42);
+        {
+            auto submitted = planet::vk::command_buffer::single_use(pool)
+                                     .end_and_submit_async();
+            submitted.keep_alive(staging);
+        }
+        check(staging.use_count()) == 1;
+    });
+
+
+}
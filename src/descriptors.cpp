@@ -2,6 +2,8 @@
 #include <planet/vk/descriptors.hpp>
 #include <planet/vk/device.hpp>
 
+#include <algorithm>
+
 
 /// ## `planet::vk::detail`
 
@@ -22,10 +24,12 @@ void planet::vk::detail::throw_descriptor_sets_out_of_range(
 planet::vk::descriptor_pool::descriptor_pool(
         vk::device &d,
         std::span<VkDescriptorPoolSize const> sizes,
-        std::uint32_t const max)
+        std::uint32_t const max,
+        VkDescriptorPoolCreateFlags const flags)
 : device{d} {
     VkDescriptorPoolCreateInfo info{};
     info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    info.flags = flags;
     info.poolSizeCount = sizes.size();
     info.pPoolSizes = sizes.data();
     info.maxSets = max;
@@ -121,3 +125,99 @@ planet::vk::descriptor_sets::descriptor_sets(
             vkAllocateDescriptorSets(pool.device.get(), &allocInfo, sets.data()),
             loc);
 }
+
+
+/// ## `planet::vk::descriptor_allocator`
+
+
+planet::vk::descriptor_allocator::descriptor_allocator(
+        std::string_view const name,
+        vk::device &d,
+        VkDescriptorType const t,
+        std::uint32_t const initial_sets,
+        std::uint32_t const dps)
+: device{d},
+  type{t},
+  descriptors_per_set{dps},
+  c_pools_created{std::string{name} + "__pools_created"},
+  c_sets_peak{std::string{name} + "__sets_peak"} {
+    add_pool(std::max(initial_sets, 1u));
+}
+
+
+void planet::vk::descriptor_allocator::add_pool(std::uint32_t const capacity) {
+    ++c_pools_created;
+    std::array const sizes{VkDescriptorPoolSize{
+            .type = type, .descriptorCount = capacity * descriptors_per_set}};
+    pools.push_back({descriptor_pool{device.get(), sizes, capacity}, capacity});
+}
+
+
+VkDescriptorSet planet::vk::descriptor_allocator::allocate(
+        descriptor_set_layout const &layout, std::source_location const &loc) {
+    while (true) {
+        VkDescriptorSetAllocateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        info.descriptorPool = pools[current].pool.get();
+        info.descriptorSetCount = 1;
+        info.pSetLayouts = layout.address();
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        auto const result =
+                vkAllocateDescriptorSets(device.get(), &info, &set);
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY
+            or result == VK_ERROR_FRAGMENTED_POOL) {
+            if (++current == pools.size()) {
+                add_pool(pools.back().capacity * 2);
+            }
+        } else {
+            planet::vk::worked(result, loc);
+            c_sets_peak.value(++in_use);
+            return set;
+        }
+    }
+}
+
+
+void planet::vk::descriptor_allocator::reset() {
+    for (auto &p : pools) {
+        planet::vk::worked(
+                vkResetDescriptorPool(device.get(), p.pool.get(), {}));
+    }
+    current = 0;
+    in_use = 0;
+}
+
+
+/// ## `planet::vk::descriptor_writes`
+
+
+void planet::vk::descriptor_writes::write(
+        VkDescriptorSet const set,
+        std::uint32_t const binding,
+        VkDescriptorType const type,
+        VkDescriptorImageInfo const &image) {
+    VkWriteDescriptorSet wds{};
+    wds.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    wds.descriptorType = type;
+    wds.dstSet = set;
+    wds.dstBinding = binding;
+    wds.dstArrayElement = 0;
+    wds.descriptorCount = 1;
+    writes.push_back(wds);
+    images.push_back(image);
+}
+
+
+void planet::vk::descriptor_writes::flush(vk::device const &device) {
+    if (writes.empty()) { return; }
+    /// The image info pointers are only stable once nothing more is added
+    for (std::size_t index{}; auto &wds : writes) {
+        wds.pImageInfo = &images[index++];
+    }
+    vkUpdateDescriptorSets(
+            device.get(), static_cast<std::uint32_t>(writes.size()),
+            writes.data(), 0, nullptr);
+    writes.clear();
+    images.clear();
+}
@@ -0,0 +1,80 @@
+#include <planet/vk/engine/memory/frame-ring.hpp>
+
+#include <felspar/memory/sizes.hpp>
+
+
+/// ## `planet::vk::engine::memory::frame_ring`
+
+
+planet::vk::engine::memory::frame_ring::frame_ring(
+        std::string_view const n,
+        vk::device &d,
+        configuration const &c,
+        id::suffix const s)
+: id{n, s}, config{c}, allocator{std::string{name()} + "__chunks", d} {}
+
+
+auto planet::vk::engine::memory::frame_ring::allocate(
+        std::size_t const frame_index,
+        std::size_t const bytes,
+        std::size_t const alignment) -> span<std::byte> {
+    std::scoped_lock _{mutex};
+    ++c_allocations;
+    auto &part = partitions[frame_index];
+    while (true) {
+        if (part.current < part.chunks.size()) {
+            auto &ch = part.chunks[part.current];
+            auto const start =
+                    felspar::memory::aligned_offset(part.offset, alignment);
+            if (start + bytes <= ch.memory.byte_count()) {
+                part.offset = start + bytes;
+                part.used += bytes;
+                c_frame_bytes_peak.value(part.used);
+                return {ch.memory.get(), start,
+                        {ch.mapping.get() + start, bytes}};
+            }
+            /**
+             * Chunks are only ever appended, so an oversized chunk created for
+             * an earlier frame may turn up here. Move past anything too small
+             * and keep looking before creating another.
+             */
+            ++part.current;
+            part.offset = 0;
+        } else {
+            ++c_chunks_created;
+            buffer<std::byte> memory{
+                    allocator, std::max(bytes, config.chunk_size), config.usage,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+            auto mapping = memory.map();
+            part.chunks.push_back({std::move(memory), std::move(mapping)});
+        }
+    }
+}
+
+
+auto planet::vk::engine::memory::frame_ring::upload_indices(
+        std::size_t const frame_index,
+        std::span<std::uint32_t const> const indices,
+        std::size_t const vertex_count) -> index_span {
+    if (vertex_count > max_narrow_vertices) {
+        auto const wide = upload(frame_index, indices);
+        return {wide.buffer, wide.offset, VK_INDEX_TYPE_UINT32};
+    }
+    auto const narrow = allocate<std::uint16_t>(frame_index, indices.size());
+    auto *out = narrow.data.data();
+    for (auto const index : indices) {
+        *out++ = static_cast<std::uint16_t>(index);
+    }
+    return {narrow.buffer, narrow.offset, VK_INDEX_TYPE_UINT16};
+}
+
+
+void planet::vk::engine::memory::frame_ring::reset(
+        std::size_t const frame_index) noexcept {
+    std::scoped_lock _{mutex};
+    auto &part = partitions[frame_index];
+    part.current = 0;
+    part.offset = 0;
+    part.used = 0;
+}
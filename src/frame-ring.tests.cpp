@@ -0,0 +1,111 @@
+#include <planet/log.hpp>
+#include <planet/vk/device.hpp>
+#include <planet/vk/engine/memory/frame-ring.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("engine::memory::frame_ring", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Bump allocation within a frame
+    /**
+     * Allocations for the same frame come from the same chunk one after the
+     * other, and the data is written straight into mapped memory.
+     */
+    auto const bumps = suite.test("bumps", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::engine::memory::frame_ring ring{
+                "bumps", vk->device, {},
+                planet::telemetry::id::suffix::add};
+
+        std::array const items{1u, 2u, 3u, 4u};
+        auto const first = ring.upload(0, std::span{items});
+        auto const second = ring.allocate<std::uint32_t>(0, 4);
+
+        check(first.buffer) != VK_NULL_HANDLE;
+        check(first.buffer) == second.buffer;
+        check(first.offset) == 0u;
+        check(second.offset) == sizeof(items);
+        check(first.data[2]) == 3u;
+        check(ring.bytes_used(0)) == 2 * sizeof(items);
+        check(ring.bytes_used(1)) == 0u;
+    });
+
+
+    /// ## Resetting a frame recycles its memory
+    auto const recycles = suite.test("reset-recycles", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::engine::memory::frame_ring ring{
+                "recycles", vk->device, {.chunk_size = 1u << 10},
+                planet::telemetry::id::suffix::add};
+
+        auto const first = ring.allocate(1, 512, 16);
+        auto const other_frame = ring.allocate(2, 512, 16);
+        check(other_frame.buffer) != first.buffer;
+
+        ring.reset(1);
+        check(ring.bytes_used(1)) == 0u;
+        auto const again = ring.allocate(1, 512, 16);
+        check(again.buffer) == first.buffer;
+        check(again.offset) == first.offset;
+    });
+
+
+    /// ## Requests that don't fit move on to another chunk
+    auto const grows = suite.test("grows", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::engine::memory::frame_ring ring{
+                "grows", vk->device, {.chunk_size = 1u << 10},
+                planet::telemetry::id::suffix::add};
+
+        auto const small = ring.allocate(0, 768, 16);
+        auto const large = ring.allocate(0, 4u << 10, 16);
+        check(large.buffer) != small.buffer;
+        check(large.offset) == 0u;
+        check(large.byte_count()) == (4u << 10);
+
+        /// After a reset both chunks are used again without creating more
+        ring.reset(0);
+        check(ring.allocate(0, 768, 16).buffer) == small.buffer;
+        check(ring.allocate(0, 4u << 10, 16).buffer) == large.buffer;
+    });
+
+
+    /// ## Indices are narrowed when the vertices allow
+    auto const indices = suite.test("upload-indices", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        using ring_type = planet::vk::engine::memory::frame_ring;
+        ring_type ring{
+                "indices", vk->device, {}, planet::telemetry::id::suffix::add};
+
+        std::array const items{0u, 1u, 2u, 65535u};
+        auto const narrow = ring.upload_indices(
+                0, std::span{items}, ring_type::max_narrow_vertices);
+        check(narrow.type == VK_INDEX_TYPE_UINT16) == true;
+        check(narrow.buffer) != VK_NULL_HANDLE;
+        check(ring.bytes_used(0)) == items.size() * sizeof(std::uint16_t);
+
+        auto const wide = ring.upload_indices(
+                1, std::span{items}, ring_type::max_narrow_vertices + 1);
+        check(wide.type == VK_INDEX_TYPE_UINT32) == true;
+        check(ring.bytes_used(1)) == items.size() * sizeof(std::uint32_t);
+    });
+
+
+}
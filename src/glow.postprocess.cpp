@@ -448,6 +448,7 @@ void planet::vk::engine::postprocess::glow::update_descriptors() {
 void planet::vk::engine::postprocess::glow::render_subpass(
         render_parameters rp, std::uint32_t const image_index) {
     /// #### Downsample the `input_colours` to half size
+    auto timing = rp.renderer.gpu_profiler.scope(rp.cb, "glow_downsample");
     auto &input_image = input_colours.image[rp.current_frame];
     auto &downsized_image = downsized_input.image[rp.current_frame];
 
@@ -502,6 +503,8 @@ void planet::vk::engine::postprocess::glow::render_subpass(
 
 
     /// #### Perform horizontal then vertical blur
+    timing.end();
+    timing = rp.renderer.gpu_profiler.scope(rp.cb, "glow_horizontal_blur");
 
     VkRenderPassBeginInfo horizontal_info = {};
     horizontal_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -538,6 +541,8 @@ void planet::vk::engine::postprocess::glow::render_subpass(
     vkCmdEndRenderPass(rp.cb.get());
 
 
+    timing.end();
+    timing = rp.renderer.gpu_profiler.scope(rp.cb, "glow_vertical_blur");
     VkRenderPassBeginInfo vertical_info = {};
     vertical_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     vertical_info.renderPass = blur_render_pass.get();
@@ -571,6 +576,8 @@ void planet::vk::engine::postprocess::glow::render_subpass(
 
 
     /// #### Composite the two images together
+    timing.end();
+    timing = rp.renderer.gpu_profiler.scope(rp.cb, "glow_composite");
 
     rp.cb.pipeline_barrier(
             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
@@ -0,0 +1,239 @@
+#include <planet/vk/device.hpp>
+#include <planet/vk/engine/app.hpp>
+#include <planet/vk/engine/gpu_completion.hpp>
+
+#include <felspar/exceptions/runtime_error.hpp>
+
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <span>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+using namespace std::literals;
+
+
+/// ## `planet::vk::engine::gpu_completion`
+
+
+planet::vk::engine::gpu_completion::gpu_completion(engine::app &a) : app{a} {
+#ifndef _WIN32
+    std::array<int, 2> fds{};
+    if (::pipe(fds.data()) != 0) {
+        throw felspar::stdexcept::runtime_error{
+                "Could not create the GPU completion pipe"};
+    }
+    wake_read = fds[0];
+    wake_write = fds[1];
+    /// The event loop must never block reading from the pipe
+    ::fcntl(wake_read, F_SETFL, ::fcntl(wake_read, F_GETFL) | O_NONBLOCK);
+#endif
+    helper = std::thread{[this]() { work(); }};
+    dispatcher.post(*this, &gpu_completion::dispatch);
+}
+
+
+planet::vk::engine::gpu_completion::~gpu_completion() {
+    {
+        std::scoped_lock _{mutex};
+        stopping = true;
+    }
+    signal.notify_all();
+    helper.join();
+    dispatcher.destroy();
+#ifndef _WIN32
+    ::close(wake_read);
+    ::close(wake_write);
+#endif
+}
+
+
+auto planet::vk::engine::gpu_completion::wait(vk::fence const &fence)
+        -> fence_waiter {
+    return {*this, fence};
+}
+
+
+auto planet::vk::engine::gpu_completion::wait(vk::submission &submitted)
+        -> felspar::coro::task<duration> {
+    auto const taken = co_await wait(submitted.fence());
+    submitted.wait();
+    co_return taken;
+}
+
+
+auto planet::vk::engine::gpu_completion::wait(
+        vk::upload_engine::ticket const uploaded)
+        -> felspar::coro::task<duration> {
+    if (uploaded.is_complete()) { co_return duration{}; }
+    co_return co_await wait(uploaded.fence());
+}
+
+
+void planet::vk::engine::gpu_completion::work() {
+    while (true) {
+        waiter *current = nullptr;
+        {
+            std::unique_lock lock{mutex};
+            signal.wait(lock, [this]() { return stopping or queued.front; });
+            if (stopping) { return; }
+            current = queued.pop();
+            current->status = waiter::state::running;
+        }
+        try {
+            current->call();
+        } catch (...) { current->failed = std::current_exception(); }
+        {
+            std::scoped_lock _{mutex};
+            current->status = waiter::state::finished;
+            finished.push(current);
+        }
+        signal.notify_all();
+#ifndef _WIN32
+        std::byte const wake{};
+        [[maybe_unused]] auto const _ = ::write(wake_write, &wake, 1);
+#endif
+    }
+}
+
+
+felspar::coro::task<void> planet::vk::engine::gpu_completion::dispatch() {
+#ifndef _WIN32
+    std::array<std::byte, 64> buffer;
+#endif
+    while (true) {
+#ifndef _WIN32
+        co_await app.sdl.io.read_some(wake_read, std::span{buffer});
+#else
+        co_await app.sdl.io.sleep(1ms);
+#endif
+        /**
+         * Only one wait is taken off the list at a time, because a resumed
+         * coroutine may destroy another wait that has also finished.
+         */
+        while (true) {
+            waiter *done = nullptr;
+            {
+                std::scoped_lock _{mutex};
+                done = finished.pop();
+                if (not done) { break; }
+                done->status = waiter::state::idle;
+            }
+            done->continuation.resume();
+        }
+    }
+}
+
+
+/// ## `planet::vk::engine::gpu_completion::waiter`
+
+
+planet::vk::engine::gpu_completion::waiter::~waiter() {
+    std::unique_lock lock{owner.mutex};
+    owner.signal.wait(lock, [this]() { return status != state::running; });
+    if (status == state::queued) {
+        owner.queued.erase(this);
+    } else if (status == state::finished) {
+        owner.finished.erase(this);
+    }
+}
+
+
+void planet::vk::engine::gpu_completion::waiter::await_suspend(
+        std::coroutine_handle<> const h) {
+    continuation = h;
+    started = std::chrono::steady_clock::now();
+    {
+        std::scoped_lock _{owner.mutex};
+        status = state::queued;
+        owner.queued.push(this);
+    }
+    owner.signal.notify_all();
+}
+
+
+auto planet::vk::engine::gpu_completion::waiter::await_resume() -> duration {
+    if (ready) { return {}; }
+    if (auto const error = std::exchange(failed, {})) {
+        std::rethrow_exception(error);
+    }
+    return std::chrono::steady_clock::now() - started;
+}
+
+
+/// ## `planet::vk::engine::gpu_completion::fence_waiter`
+
+
+planet::vk::engine::gpu_completion::fence_waiter::fence_waiter(
+        gpu_completion &g, vk::fence const &f)
+: waiter{g, f.is_ready()}, fence{f} {}
+
+
+void planet::vk::engine::gpu_completion::fence_waiter::call() {
+    /**
+     * A bounded timeout means the wait notices the helper thread being
+     * stopped, so a fence that is never signalled can't stop it from being
+     * joined. Errors, like a lost device, are thrown back to the waiting
+     * coroutine.
+     */
+    constexpr std::uint64_t timeout = std::chrono::nanoseconds{100ms}.count();
+    auto const handle = fence.get();
+    while (true) {
+        auto const result = vkWaitForFences(
+                fence.device.get(), 1, &handle, VK_TRUE, timeout);
+        if (result != VK_TIMEOUT) {
+            planet::vk::worked(result);
+            return;
+        }
+        std::scoped_lock _{owner.mutex};
+        if (owner.stopping) {
+            throw felspar::stdexcept::runtime_error{
+                    "GPU completion stopped while waiting for a fence"};
+        }
+    }
+}
+
+
+/// ## `planet::vk::engine::gpu_completion::waiters`
+
+
+void planet::vk::engine::gpu_completion::waiters::push(
+        waiter *const w) noexcept {
+    w->next = nullptr;
+    if (back) {
+        back->next = w;
+    } else {
+        front = w;
+    }
+    back = w;
+}
+
+
+auto planet::vk::engine::gpu_completion::waiters::pop() noexcept -> waiter * {
+    auto *const w = front;
+    if (w) {
+        front = std::exchange(w->next, nullptr);
+        if (not front) { back = nullptr; }
+    }
+    return w;
+}
+
+
+void planet::vk::engine::gpu_completion::waiters::erase(
+        waiter *const w) noexcept {
+    waiter *previous = nullptr;
+    for (auto *at = front; at; previous = std::exchange(at, at->next)) {
+        if (at == w) {
+            (previous ? previous->next : front) = w->next;
+            if (back == w) { back = previous; }
+            w->next = nullptr;
+            return;
+        }
+    }
+}
@@ -0,0 +1,175 @@
+#include <planet/vk/device.hpp>
+#include <planet/vk/engine/gpu_profiler.hpp>
+#include <planet/vk/instance.hpp>
+
+#include <bit>
+
+
+/// ## `planet::vk::engine::gpu_profiler`
+
+
+planet::vk::engine::gpu_profiler::gpu_profiler(
+        std::string_view const n,
+        vk::device &d,
+        configuration const &c,
+        id::suffix const s)
+: id{n, s}, device{d}, config{c} {
+    auto const &surface = d.instance.surface;
+    auto const bits =
+            surface.queue_family_properties
+                    .at(surface.graphics_queue_family_index())
+                    .timestampValidBits;
+    if (bits == 0 or config.scopes_per_frame == 0) { return; }
+
+    period_ns = d.instance.gpu().properties.limits.timestampPeriod;
+    valid_mask =
+            bits >= 64 ? ~std::uint64_t{} : (std::uint64_t{1} << bits) - 1;
+    VkQueryPoolCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    info.queryCount = 2 * config.scopes_per_frame;
+    for (auto &f : frames) {
+        f.pool.create<vkCreateQueryPool>(device.get(), info);
+        f.timed.reserve(config.scopes_per_frame);
+    }
+    results.resize(info.queryCount);
+}
+
+
+planet::vk::engine::gpu_profiler::scope_timings::scope_timings(
+        std::string const &n)
+: trace_name{trace::intern(n)},
+  c_us{n + "__us"},
+  c_count{n + "__count"},
+  c_peak_us{n + "__peak_us"},
+  c_histogram{n + "__histogram_us"} {}
+
+
+auto planet::vk::engine::gpu_profiler::scope(
+        command_buffer &cb, std::string_view const n) -> marker {
+    if (not enabled()) { return {}; }
+    auto &f = frames[frame_index];
+    std::uint32_t query{};
+    {
+        std::scoped_lock _{mutex};
+        if (f.timed.size() >= config.scopes_per_frame) {
+            ++c_dropped;
+            return {};
+        }
+        auto found = scopes.find(n);
+        if (found == scopes.end()) {
+            std::string const full = name() + "__" + std::string{n};
+            found = scopes.emplace(
+                                  std::string{n},
+                                  std::make_unique<scope_timings>(full))
+                            .first;
+        }
+        query = 2 * static_cast<std::uint32_t>(f.timed.size());
+        f.timed.push_back(found->second.get());
+    }
+    vkCmdWriteTimestamp(
+            cb.get(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, f.pool.get(), query);
+    return {f.pool.get(), cb.get(), query};
+}
+
+
+void planet::vk::engine::gpu_profiler::start(
+        std::size_t const fi, command_buffer &cb) {
+    frame_index = fi;
+    if (not enabled()) { return; }
+    auto &f = frames[frame_index];
+    publish(f);
+    vkCmdResetQueryPool(
+            cb.get(), f.pool.get(), 0, 2 * config.scopes_per_frame);
+}
+
+
+void planet::vk::engine::gpu_profiler::publish(frame &f) {
+    if (trace::enabled() and not calibrated) { calibrate(); }
+    std::scoped_lock _{mutex};
+    if (f.timed.empty()) { return; }
+    auto const queries = static_cast<std::uint32_t>(2 * f.timed.size());
+    auto const fetched = vkGetQueryPoolResults(
+            device.get(), f.pool.get(), 0, queries,
+            queries * sizeof(results.front()), results.data(),
+            sizeof(results.front()),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    /// Not ready only means that some of the queries are missing
+    if (fetched != VK_NOT_READY) { worked(fetched); }
+
+    for (std::size_t index{}; auto *timings : f.timed) {
+        auto const &[began, began_available] = results[index++];
+        auto const &[ended, ended_available] = results[index++];
+        if (not began_available or not ended_available) {
+            ++c_dropped;
+            continue;
+        }
+        auto const ticks = (ended - began) & valid_mask;
+        timings->latest = std::chrono::nanoseconds{
+                static_cast<std::chrono::nanoseconds::rep>(
+                        static_cast<double>(ticks) * period_ns)};
+        auto const us = static_cast<std::size_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        timings->latest)
+                        .count());
+        timings->c_us += static_cast<std::int64_t>(us);
+        ++timings->c_count;
+        timings->c_peak_us.value(us);
+        timings->c_histogram.update(
+                std::bit_ceil(us), 1u, [](auto &n) { ++n; });
+        if (trace::enabled()) {
+            auto const since = static_cast<std::int64_t>(began & valid_mask)
+                    - static_cast<std::int64_t>(gpu_anchor);
+            auto const offset = std::chrono::duration<double, std::nano>{
+                    static_cast<double>(since) * period_ns};
+            trace::complete(
+                    timings->trace_name, "gpu",
+                    cpu_anchor
+                            + std::chrono::duration_cast<
+                                    trace::clock::duration>(offset),
+                    timings->latest, true);
+        }
+    }
+    f.timed.clear();
+    ++c_frames;
+}
+
+
+void planet::vk::engine::gpu_profiler::calibrate() {
+    if (not enabled()) { return; }
+    frame::handle_type query;
+    VkQueryPoolCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    info.queryCount = 1;
+    query.create<vkCreateQueryPool>(device.get(), info);
+
+    vk::command_pool pool{device(), device().instance.surface};
+    auto cb = command_buffer::single_use(pool);
+    vkCmdResetQueryPool(cb.get(), query.get(), 0, 1);
+    vkCmdWriteTimestamp(
+            cb.get(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, query.get(), 0);
+    auto const before = trace::clock::now();
+    std::move(cb).end_and_submit_async().wait();
+    auto const after = trace::clock::now();
+
+    std::uint64_t ticks{};
+    worked(vkGetQueryPoolResults(
+            device.get(), query.get(), 0, 1, sizeof(ticks), &ticks,
+            sizeof(ticks),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+    gpu_anchor = ticks & valid_mask;
+    cpu_anchor = before + (after - before) / 2;
+    calibrated = true;
+}
+
+
+auto planet::vk::engine::gpu_profiler::latest(std::string_view const n) const
+        -> std::chrono::nanoseconds {
+    std::scoped_lock _{mutex};
+    if (auto const found = scopes.find(n); found != scopes.end()) {
+        return found->second->latest;
+    } else {
+        return {};
+    }
+}
@@ -0,0 +1,80 @@
+#include <planet/log.hpp>
+#include <planet/vk/buffer.hpp>
+#include <planet/vk/engine/gpu_profiler.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("engine::gpu_profiler", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Timings are published when the frame index comes back around
+    /**
+     * The inner scope times filling a buffer that is large enough to take a
+     * measurable time, and the outer scope encloses it so can't be shorter.
+     */
+    auto const publishes = suite.test("publish", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::engine::gpu_profiler profiler{
+                "planet_vk_engine_gpu_profiler_tests", vk->device};
+        if (not profiler.enabled()) { return; }
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+        planet::vk::buffer<std::uint32_t> workload{
+                vk->device.startup_memory, 16u << 20,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+
+        auto cb = planet::vk::command_buffer::single_use(pool);
+        profiler.start(0, cb);
+        {
+            auto const outer = profiler.scope(cb, "outer");
+            auto const inner = profiler.scope(cb, "inner");
+            vkCmdFillBuffer(
+                    cb.get(), workload.get(), 0, VK_WHOLE_SIZE, 0x5a5a5a5a);
+        }
+        std::move(cb).end_and_submit_async().wait();
+        check(profiler.c_frames.value()) == 0;
+        check(profiler.latest("missing").count()) == 0;
+
+        auto next = planet::vk::command_buffer::single_use(pool);
+        profiler.start(0, next);
+        check(profiler.c_frames.value()) == 1;
+        check(profiler.c_dropped.value()) == 0;
+        auto const outer = profiler.latest("outer");
+        auto const inner = profiler.latest("inner");
+        check(inner > std::chrono::nanoseconds{}) == true;
+        check(outer >= inner) == true;
+        std::move(next).end_and_submit_async().wait();
+    });
+
+
+    /// ## Scopes past the per-frame limit aren't timed
+    auto const drops = suite.test("dropped", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::engine::gpu_profiler profiler{
+                "planet_vk_engine_gpu_profiler_tests", vk->device,
+                {.scopes_per_frame = 1}};
+        if (not profiler.enabled()) { return; }
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+
+        auto cb = planet::vk::command_buffer::single_use(pool);
+        profiler.start(1, cb);
+        profiler.scope(cb, "first").end();
+        profiler.scope(cb, "second").end();
+        check(profiler.c_dropped.value()) == 1;
+        std::move(cb).end_and_submit_async().wait();
+    });
+
+
+}
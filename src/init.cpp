@@ -205,14 +205,36 @@ planet::vk::device::device(
      * it be enabled when present; `required_device_extensions` appends it only
      * for such a device, so conformant Linux/Windows drivers are unaffected.
      * None of the features we enable above are gated by the portability subset,
-     * so a bare `VkPhysicalDeviceFeatures` (no `VkPhysicalDeviceFeatures2`
-     * `pNext` chain) is sufficient.
+     * so a bare `VkPhysicalDeviceFeatures` is sufficient for them.
      */
-    auto const device_extensions = required_device_extensions(
+    auto device_extensions = required_device_extensions(
             instance.gpu().extensions, extensions.device_extensions);
 
+    /**
+     * Descriptor indexing features are chained on through `pNext`, which is
+     * allowed alongside `pEnabledFeatures` as long as no
+     * `VkPhysicalDeviceFeatures2` is in the chain. Only the features that
+     * bindless textures need are turned on.
+     */
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features{};
+    descriptor_indexing_features.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    if (instance.gpu().supports_bindless_textures()) {
+        descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing =
+                VK_TRUE;
+        descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind =
+                VK_TRUE;
+        descriptor_indexing_features.descriptorBindingUpdateUnusedWhilePending =
+                VK_TRUE;
+        descriptor_indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
+        descriptor_indexing_features.runtimeDescriptorArray = VK_TRUE;
+        device_extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        bindless_textures = true;
+    }
+
     VkDeviceCreateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    if (bindless_textures) { info.pNext = &descriptor_indexing_features; }
     info.queueCreateInfoCount = queue_create_infos.size();
     info.pQueueCreateInfos = queue_create_infos.data();
     info.enabledExtensionCount = device_extensions.size();
@@ -221,6 +243,7 @@ planet::vk::device::device(
     planet::log::info("Creating device with extensions:", device_extensions);
     planet::vk::worked(
             vkCreateDevice(instance.gpu().get(), &info, nullptr, &handle));
+    pipeline_cache.create();
 
     vkGetDeviceQueue(handle, graphics_family, 0, &graphics_queue);
     vkGetDeviceQueue(handle, presentation_family, 0, &present_queue);
@@ -239,6 +262,8 @@ planet::vk::device::~device() {
     staging_memory.clear_without_check();
     startup_memory.clear_without_check();
     block_pool.clear();
+    pipeline_cache.reset();
+    shader_modules.clear();
     if (handle) {
         planet::log::debug("Destructing Vulkan device");
         wait_idle();
@@ -272,6 +297,21 @@ void planet::vk::device::wait_idle() const {
 }
 
 
+void planet::vk::device::observe_textures(texture_observer &o) {
+    std::scoped_lock _{texture_observers_mutex};
+    texture_observers.push_back(&o);
+}
+void planet::vk::device::stop_observing_textures(texture_observer &o) {
+    std::scoped_lock _{texture_observers_mutex};
+    std::erase(texture_observers, &o);
+}
+void planet::vk::device::texture_destroyed(
+        VkImageView const image_view, VkSampler const sampler) {
+    std::scoped_lock _{texture_observers_mutex};
+    for (auto *const o : texture_observers) { o->forget(image_view, sampler); }
+}
+
+
 /// ## `planet::vk::extensions`
 
 
@@ -493,6 +533,41 @@ planet::vk::physical_device::physical_device(VkPhysicalDevice h, VkSurfaceKHR)
     extensions = planet::vk::fetch_vector<
             vkEnumerateDeviceExtensionProperties, VkExtensionProperties>(
             handle, nullptr);
+
+    bool const has_descriptor_indexing =
+            properties.apiVersion >= VK_API_VERSION_1_1
+            and std::any_of(
+                    extensions.begin(), extensions.end(), [](auto const &ex) {
+                        return std::string_view{ex.extensionName}
+                        == VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME;
+                    });
+    if (has_descriptor_indexing) {
+        descriptor_indexing_features.sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        VkPhysicalDeviceFeatures2 features2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &descriptor_indexing_features,
+                .features = {}};
+        vkGetPhysicalDeviceFeatures2(handle, &features2);
+
+        descriptor_indexing_properties.sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 properties2{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &descriptor_indexing_properties,
+                .properties = {}};
+        vkGetPhysicalDeviceProperties2(handle, &properties2);
+    }
+}
+
+
+bool planet::vk::physical_device::supports_bindless_textures() const noexcept {
+    auto const &f = descriptor_indexing_features;
+    return f.shaderSampledImageArrayNonUniformIndexing
+            and f.descriptorBindingSampledImageUpdateAfterBind
+            and f.descriptorBindingUpdateUnusedWhilePending
+            and f.descriptorBindingPartiallyBound
+            and f.runtimeDescriptorArray;
 }
 
 
@@ -0,0 +1,242 @@
+#include <planet/vk/engine/renderer.hpp>
+#include <planet/vk/engine/pipeline/instanced_sprite.hpp>
+
+#include <algorithm>
+
+
+/// ## `planet::vk::engine::pipeline::instanced_sprite`
+
+
+namespace {
+    using instance_type =
+            planet::vk::engine::pipeline::instanced_sprite::instance_type;
+
+    constexpr auto binding_description = std::array{
+            VkVertexInputBindingDescription{
+                    .binding = 0,
+                    .stride = sizeof(instance_type),
+                    .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE}};
+
+    /// The transform takes up four locations, one per column
+    constexpr auto attribute_description = std::array{
+            VkVertexInputAttributeDescription{
+                    .location = 0,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, transform)},
+            VkVertexInputAttributeDescription{
+                    .location = 1,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, transform)
+                            + 4 * sizeof(float)},
+            VkVertexInputAttributeDescription{
+                    .location = 2,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, transform)
+                            + 8 * sizeof(float)},
+            VkVertexInputAttributeDescription{
+                    .location = 3,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, transform)
+                            + 12 * sizeof(float)},
+            VkVertexInputAttributeDescription{
+                    .location = 4,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, colour)},
+            VkVertexInputAttributeDescription{
+                    .location = 5,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, position)},
+            VkVertexInputAttributeDescription{
+                    .location = 6,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, uv)},
+            VkVertexInputAttributeDescription{
+                    .location = 7,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32_SFLOAT,
+                    .offset = offsetof(instance_type, z_height)},
+            VkVertexInputAttributeDescription{
+                    .location = 8,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32_UINT,
+                    .offset = offsetof(instance_type, texture_slot)}};
+
+    static_assert(sizeof(planet::affine::matrix3d) == 16 * sizeof(float));
+}
+
+
+planet::vk::engine::pipeline::instanced_sprite::instanced_sprite(
+        std::string_view const n,
+        engine::renderer &r,
+        std::string_view const vs,
+        std::uint32_t const mtpf,
+        id::suffix const suffix)
+: id{n, suffix},
+  textures{name(), r.app.device, mtpf},
+  pipeline{create_pipeline(r, vs)},
+  bindless{r.bindless ? &*r.bindless : nullptr} {}
+
+
+planet::vk::graphics_pipeline
+        planet::vk::engine::pipeline::instanced_sprite::create_pipeline(
+                engine::renderer &r, std::string_view const vertex_shader) {
+    return planet::vk::engine::create_graphics_pipeline(
+            {.app = r.app,
+             .renderer = r,
+             .vertex_shader = {vertex_shader},
+             .fragment_shader =
+                     {r.bindless
+                              ? "planet-vk-engine/sprite.instanced.bindless.frag.spirv"
+                              : "planet-vk-engine/sprite.frag.spirv"},
+             .binding_descriptions = binding_description,
+             .attribute_descriptions = attribute_description,
+             .pipeline_layout = pipeline_layout{
+                     r.app.device,
+                     std::array{
+                             r.coordinates_ubo_layout().get(),
+                             r.bindless ? r.bindless->layout.get()
+                                        : textures.layout.get()}}});
+}
+
+
+auto planet::vk::engine::pipeline::instanced_sprite::make_instance(
+        affine::rectangle2d const &uv,
+        location const &loc,
+        planet::colour const &colour) noexcept -> instance_type {
+    /// This is the same quad that `sprite::draw` builds its vertices from
+    auto const pos = affine::rectangle2d{
+            affine::point2d{0, loc.size.height} - loc.centre,
+            affine::extents2d{loc.size.width, -loc.size.height}};
+    auto const pos_br = pos.bottom_right();
+    auto const uv_br = uv.bottom_right();
+    return {.transform = sprite::make_transform(loc).transform,
+            .colour = colour,
+            .position =
+                    {pos.top_left.x(), pos.top_left.y(), pos_br.x(),
+                     pos_br.y()},
+            .uv = {uv.top_left.x(), uv.top_left.y(), uv_br.x(), uv_br.y()},
+            .z_height = loc.z_height};
+}
+
+
+void planet::vk::engine::pipeline::instanced_sprite::draw(
+        std::pair<vk::texture const &, affine::rectangle2d> texture,
+        location const &loc,
+        planet::colour const &colour) {
+    instances.push_back(
+            &texture.first, make_instance(texture.second, loc, colour));
+    ++instance_count;
+}
+
+
+void planet::vk::engine::pipeline::instanced_sprite::render(
+        render_parameters rp) {
+    if (bindless) {
+        render_bindless(rp);
+        return;
+    }
+
+    auto const texture_count = instances.non_empty_count();
+    if (texture_count == 0) { return; }
+
+    textures.textures_in_frame.value(texture_count);
+    c_instances_in_frame.value(instance_count);
+
+    /**
+     * All of the instances for the frame go into a single allocation, with
+     * the sprites for each texture next to each other so that each texture
+     * can be drawn starting at its own `first_instance`.
+     */
+    auto const buffer = rp.renderer.frame_uploads.allocate<instance_type>(
+            rp.current_frame, instance_count);
+    std::array buffers{buffer.buffer};
+    std::array offset{buffer.offset};
+    vkCmdBindVertexBuffers(
+            rp.cb.get(), 0, buffers.size(), buffers.data(), offset.data());
+
+    for (std::uint32_t texture_index{};
+         auto const &[texture, batch] : instances.non_empty_vectors()) {
+        textures.write(
+                rp.current_frame, texture_index++,
+                {.sampler = texture->sampler.get(),
+                 .imageView = texture->image_view.get(),
+                 .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+    }
+    textures.flush();
+
+    std::uint32_t texture_index = 0;
+    std::uint32_t first_instance = 0;
+    for (auto const &[texture, batch] : instances.non_empty_vectors()) {
+        std::ranges::copy(batch, buffer.data.begin() + first_instance);
+
+        auto const set = textures.set(rp.current_frame, texture_index);
+        vkCmdBindDescriptorSets(
+                rp.cb.get(), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                pipeline.layout.get(), 1, 1, &set, 0, nullptr);
+
+        auto const count = static_cast<std::uint32_t>(batch.size());
+        static constexpr std::uint32_t first_vertex = 0;
+        vkCmdDraw(
+                rp.cb.get(), vertices_per_sprite, count, first_vertex,
+                first_instance);
+        ++c_draw_calls;
+
+        first_instance += count;
+        ++texture_index;
+    }
+
+    // Clear out data from this frame
+    instances.clear();
+    instance_count = 0;
+}
+
+
+/// ### Rendering with bindless textures
+/**
+ * Each instance is tagged with its texture's slot as it is copied into the
+ * instance buffer, so everything can be drawn with one call.
+ */
+void planet::vk::engine::pipeline::instanced_sprite::render_bindless(
+        render_parameters &rp) {
+    if (instance_count == 0) { return; }
+    c_instances_in_frame.value(instance_count);
+
+    auto const buffer = rp.renderer.frame_uploads.allocate<instance_type>(
+            rp.current_frame, instance_count);
+    auto out = buffer.data.begin();
+    for (auto const &[texture, batch] : instances.non_empty_vectors()) {
+        auto const slot = bindless->slot_for(*texture);
+        for (auto const &instance : batch) {
+            *out = instance;
+            out->texture_slot = slot;
+            ++out;
+        }
+    }
+
+    std::array buffers{buffer.buffer};
+    std::array offset{buffer.offset};
+    vkCmdBindVertexBuffers(
+            rp.cb.get(), 0, buffers.size(), buffers.data(), offset.data());
+    auto const set = bindless->set();
+    vkCmdBindDescriptorSets(
+            rp.cb.get(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.layout.get(),
+            1, 1, &set, 0, nullptr);
+
+    static constexpr std::uint32_t first_vertex = 0;
+    static constexpr std::uint32_t first_instance = 0;
+    vkCmdDraw(
+            rp.cb.get(), vertices_per_sprite,
+            static_cast<std::uint32_t>(instance_count), first_vertex,
+            first_instance);
+    ++c_draw_calls;
+
+    instances.clear();
+    instance_count = 0;
+}
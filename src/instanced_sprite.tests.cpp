@@ -0,0 +1,136 @@
+#include <planet/vk/engine/pipeline/instanced_sprite.hpp>
+
+#include <felspar/test.hpp>
+
+#include <cstring>
+
+
+namespace {
+
+
+    using pipeline = planet::vk::engine::pipeline::instanced_sprite;
+
+
+    auto const suite =
+            felspar::testsuite("engine::pipeline::instanced_sprite");
+
+
+    /// ## Instance data describes the same quad as `sprite`
+    /**
+     * The default rotation centre is the middle of the sprite, so the corners
+     * are symmetric about the origin in sprite space.
+     */
+    auto const corners = suite.test("corners", [](auto check) {
+        auto const instance = pipeline::make_instance(
+                {{0.25f, 0.5f}, planet::affine::extents2d{0.5f, 0.25f}},
+                {.offset = {3, 4}, .size = {2, 1}, .z_height = 0.5f},
+                planet::colour::white);
+
+        check(instance.position[0]) == -1.0f;
+        check(instance.position[1]) == 0.5f;
+        check(instance.position[2]) == 1.0f;
+        check(instance.position[3]) == -0.5f;
+
+        check(instance.uv[0]) == 0.25f;
+        check(instance.uv[1]) == 0.5f;
+        check(instance.uv[2]) == 0.75f;
+        check(instance.uv[3]) == 0.75f;
+
+        check(instance.z_height) == 0.5f;
+    });
+
+
+    /// ## The rotation centre moves the quad
+    auto const centre = suite.test("centre", [](auto check) {
+        auto const instance = pipeline::make_instance(
+                {{0, 0}, planet::affine::extents2d{1, 1}},
+                {.size = {2, 1}, .centre = {0, 0}}, planet::colour::white);
+
+        check(instance.position[0]) == 0.0f;
+        check(instance.position[1]) == 1.0f;
+        check(instance.position[2]) == 2.0f;
+        check(instance.position[3]) == 0.0f;
+    });
+
+
+
+    /// ## Both sprite pipelines draw the same triangles
+    /**
+     * Builds the six corners the way `sprite.instanced.*.vert` does from the
+     * instance, and the way `sprite` does through the shared quad indices.
+     * The triangles must be the same corners with the same winding, and both
+     * must be moved into place by the same transform.
+     */
+    auto const triangles = suite.test("same-corners", [](auto check) {
+        planet::affine::rectangle2d const uv{
+                {0.25f, 0.5f}, planet::affine::extents2d{0.5f, 0.25f}};
+        pipeline::location const loc{
+                .offset = {3, 4},
+                .size = {2, 1},
+                .rotation = 0.125f,
+                .z_height = 0.5f};
+        auto const instance =
+                pipeline::make_instance(uv, loc, planet::colour::white);
+        auto const vertices = planet::vk::engine::pipeline::sprite::
+                make_vertices(uv, loc, planet::colour::white);
+
+        struct corner {
+            float x, y, u, v;
+            bool operator==(corner const &) const = default;
+        };
+        /// The same table as in the instanced vertex shaders
+        constexpr std::array instanced_corner{0, 2, 1, 0, 3, 2};
+        std::array<corner, 6> instanced, indexed;
+        for (std::size_t index{}; index < 6; ++index) {
+            auto const c = instanced_corner[index];
+            bool const right = c < 2, bottom = c == 0 or c == 3;
+            instanced[index] = {
+                    instance.position[right ? 2 : 0],
+                    instance.position[bottom ? 3 : 1],
+                    instance.uv[right ? 2 : 0], instance.uv[bottom ? 3 : 1]};
+            auto const &v = vertices[planet::vk::engine::quad_index_buffer::
+                                             pattern[index]];
+            indexed[index] = {v.p.x(), v.p.y(), v.uv.x(), v.uv.y()};
+        }
+
+        /// Triangles may start at any corner, as long as they wind the same
+        for (std::size_t triangle{}; triangle < 2; ++triangle) {
+            auto const *const a = instanced.data() + 3 * triangle;
+            auto const *const b = indexed.data() + 3 * triangle;
+            bool matched = false;
+            for (std::size_t shift{}; shift < 3; ++shift) {
+                matched = matched
+                        or (a[0] == b[shift] and a[1] == b[(shift + 1) % 3]
+                            and a[2] == b[(shift + 2) % 3]);
+            }
+            check(matched) == true;
+        }
+
+        auto const transform =
+                planet::vk::engine::pipeline::sprite::make_transform(loc);
+        check(std::memcmp(
+                &instance.transform, &transform.transform,
+                sizeof(instance.transform)))
+                == 0;
+    });
+
+
+    /// ## Screen sprites at the origin are drawn where they were
+    /**
+     * `sprite.screen.vert` used to ignore the transform, so every screen
+     * sprite was drawn at the origin without its rotation. Sprites whose
+     * location has no offset or rotation get the identity transform, so
+     * applying it leaves them exactly where they were.
+     */
+    auto const screen = suite.test("screen-unchanged", [](auto check) {
+        auto const transform =
+                planet::vk::engine::pipeline::sprite::make_transform(
+                        {.size = {2, 1}, .z_height = 0.5f});
+        planet::affine::matrix3d const identity{};
+        check(std::memcmp(
+                &transform.transform, &identity, sizeof(identity)))
+                == 0;
+    });
+
+
+}
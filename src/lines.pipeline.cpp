@@ -7,7 +7,8 @@
 
 
 planet::vk::engine::pipeline::lines::lines(parameters p)
-: pipeline{planet::vk::engine::create_graphics_pipeline(
+: id{p.name, p.use_name_suffix},
+  pipeline{planet::vk::engine::create_graphics_pipeline(
           {.app = p.renderer.app,
            .renderer = p.renderer,
            .vertex_shader = p.vertex_shader,
@@ -26,6 +27,11 @@ namespace {
             "planet_vk_engine_pipeline_lines__render_vertices"};
     planet::telemetry::counter index_count{
             "planet_vk_engine_pipeline_lines__render_indices"};
+    /// Batches drawn with 16 and 32 bit indices
+    planet::telemetry::counter index16_batches{
+            "planet_vk_engine_pipeline_lines__render_index16_batches"};
+    planet::telemetry::counter index32_batches{
+            "planet_vk_engine_pipeline_lines__render_index32_batches"};
 }
 void planet::vk::engine::pipeline::lines::render(render_parameters rp) {
     if (this_frame.empty()) { return; }
@@ -33,26 +39,24 @@ void planet::vk::engine::pipeline::lines::render(render_parameters rp) {
     vertex_count += this_frame.vertices.size();
     index_count += this_frame.indices.size();
 
-    auto &vertex_buffer = vertex_buffers[rp.current_frame];
-    vertex_buffer = {
-            rp.renderer.per_frame_memory, this_frame.vertices,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-    auto &index_buffer = index_buffers[rp.current_frame];
-    index_buffer = {
-            rp.renderer.per_frame_memory, this_frame.indices,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-
-    std::array buffers{vertex_buffer.get()};
-    std::array offset{VkDeviceSize{}};
+    auto const vertex_buffer = rp.renderer.frame_uploads.upload(
+            rp.current_frame, this_frame.vertices);
+    auto const index_buffer = rp.renderer.frame_uploads.upload_indices(
+            rp.current_frame, this_frame.indices, this_frame.vertices.size());
+    if (index_buffer.type == VK_INDEX_TYPE_UINT16) {
+        ++index16_batches;
+    } else {
+        ++index32_batches;
+    }
+
+    std::array buffers{vertex_buffer.buffer};
+    std::array offset{vertex_buffer.offset};
 
     vkCmdBindVertexBuffers(
             rp.cb.get(), 0, buffers.size(), buffers.data(), offset.data());
     vkCmdBindIndexBuffer(
-            rp.cb.get(), index_buffer.get(), 0, VK_INDEX_TYPE_UINT32);
+            rp.cb.get(), index_buffer.buffer, index_buffer.offset,
+            index_buffer.type);
     vkCmdDrawIndexed(
             rp.cb.get(), static_cast<uint32_t>(this_frame.indices.size()), 1, 0,
             0, 0);
@@ -2,6 +2,7 @@
 #include <planet/vk/device.hpp>
 #include <planet/vk/instance.hpp>
 #include <planet/vk/memory.hpp>
+#include <planet/vk/trace.hpp>
 
 #include <felspar/memory/sizes.hpp>
 
@@ -84,6 +85,10 @@ namespace {
             "planet_vk_device_memory_allocator__free_blocks"};
     /** Whole blocks idling in allocator-local free lists, device-wide. */
 
+    /// #### Device-wide sum of every allocator's `c_bytes_reclaimed`
+    planet::telemetry::counter c_global_bytes_reclaimed{
+            "planet_vk_device_memory_allocator__bytes_reclaimed"};
+
     /// #### Peak of `c_global_bytes_held`
     planet::telemetry::max c_global_bytes_held_peak{
             "planet_vk_device_memory_allocator__bytes_held_peak"};
@@ -197,10 +202,11 @@ planet::vk::device_memory_allocator::device_memory_allocator(
   pools(d.instance.gpu().memory_properties.memoryTypeCount),
   device{d},
   config{c},
-  // The remaining counters are constructed via NSDMI in the header; these two
+  // The remaining counters are constructed via NSDMI in the header; these
   // stay here because their `c_global_*` parents are file-local to this `.cpp`.
   c_bytes_held{name() + "__bytes_held", c_global_bytes_held},
-  c_free_blocks{name() + "__free_blocks", c_global_free_blocks} {
+  c_free_blocks{name() + "__free_blocks", c_global_free_blocks},
+  c_bytes_reclaimed{name() + "__bytes_reclaimed", c_global_bytes_reclaimed} {
     ++c_allocators_created;
 }
 
@@ -219,6 +225,11 @@ planet::vk::device_memory planet::vk::device_memory_allocator::allocate(
     auto const bytes = felspar::memory::block_size(bytes_requested, alignment);
     auto &pool = pools[memory_type_index];
     std::scoped_lock _{pool.mtx};
+    if (config.split
+        and config.strategy == device_memory_strategy::free_ranges) {
+        return allocate_from_free_ranges(
+                pool, bytes, memory_type_index, alignment);
+    }
     /**
      * The current splitting block must have room for `bytes` *after* its offset
      * is realigned to `alignment` -- otherwise carve from a fresh block. A
@@ -228,28 +239,11 @@ planet::vk::device_memory planet::vk::device_memory_allocator::allocate(
     if (not pool.splitting.can_split(bytes, alignment)) {
         pool.splitting.reset();
         auto const allocating = std::max(bytes, config.allocation_block_size);
-        device_memory_allocation::handle_type handle;
-        if (allocating > config.allocation_block_size
-            or pool.free_memory.empty()) {
-            ++c_block_allocation_from_device_pool;
-            c_device_pool_block_sizes.update(allocating, 1u, bump);
-            c_global_device_pool_block_sizes.update(allocating, 1u, bump);
-            c_bytes_held += static_cast<std::int64_t>(allocating);
-            c_bytes_held_peak.value(
-                    static_cast<std::uint64_t>(c_bytes_held.value()));
-            c_global_bytes_held_peak.value(
-                    static_cast<std::uint64_t>(c_global_bytes_held.value()));
-            handle = device().block_pool.acquire(
-                    device, memory_type_index, allocating);
-        } else {
-            handle = std::move(pool.free_memory.back());
-            pool.free_memory.pop_back();
-            --c_free_blocks;
-            ++c_block_allocation_from_free_list;
-        }
         pool.splitting = {
                 new device_memory_allocation(
-                        this, std::move(handle), memory_type_index, allocating),
+                        this,
+                        acquire_block(pool, memory_type_index, allocating),
+                        memory_type_index, allocating),
                 {},
                 allocating};
     }
@@ -269,11 +263,122 @@ planet::vk::device_memory planet::vk::device_memory_allocator::allocate(
 }
 
 
+planet::vk::device_memory_allocation::handle_type
+        planet::vk::device_memory_allocator::acquire_block(
+                pool &pool,
+                std::uint32_t const memory_type_index,
+                std::size_t const allocating) {
+    if (allocating > config.allocation_block_size or pool.free_memory.empty()) {
+        trace::scope const tracing{
+                "device_memory_allocator::acquire_block", "memory"};
+        ++c_block_allocation_from_device_pool;
+        c_device_pool_block_sizes.update(allocating, 1u, bump);
+        c_global_device_pool_block_sizes.update(allocating, 1u, bump);
+        c_bytes_held += static_cast<std::int64_t>(allocating);
+        c_bytes_held_peak.value(
+                static_cast<std::uint64_t>(c_bytes_held.value()));
+        c_global_bytes_held_peak.value(
+                static_cast<std::uint64_t>(c_global_bytes_held.value()));
+        return device().block_pool.acquire(
+                device, memory_type_index, allocating);
+    } else {
+        auto handle = std::move(pool.free_memory.back());
+        pool.free_memory.pop_back();
+        --c_free_blocks;
+        ++c_block_allocation_from_free_list;
+        return handle;
+    }
+}
+
+
+planet::vk::device_memory
+        planet::vk::device_memory_allocator::allocate_from_free_ranges(
+                pool &pool,
+                std::size_t const bytes,
+                std::uint32_t const memory_type_index,
+                std::size_t const alignment) {
+    /// Every range handed out must be non-empty so it can be given back
+    auto const reserving = std::max<std::size_t>(bytes, 1u);
+    if (reserving > config.allocation_block_size) {
+        /**
+         * Oversized requests get a block of their own. It has no free ranges,
+         * so when the memory is released the block goes straight back to the
+         * shared pool just as it does for the slab strategy.
+         */
+        return {new device_memory_allocation(
+                        this, acquire_block(pool, memory_type_index, reserving),
+                        memory_type_index, reserving),
+                {},
+                reserving};
+    }
+    for (auto *const allocation : pool.ranged) {
+        if (auto const offset =
+                    allocation->free_ranges->acquire(reserving, alignment)) {
+            ++c_free_range_allocations;
+            return {device_memory_allocation::increment(allocation), *offset,
+                    reserving};
+        }
+    }
+    auto *const allocation = new device_memory_allocation(
+            this,
+            acquire_block(
+                    pool, memory_type_index, config.allocation_block_size),
+            memory_type_index, config.allocation_block_size);
+    allocation->free_ranges = std::make_unique<device_memory_free_ranges>(
+            config.allocation_block_size);
+    /// The pool keeps the ownership count the block was created with
+    allocation->ranged_index = pool.ranged.size();
+    pool.ranged.push_back(allocation);
+    auto const offset = allocation->free_ranges->acquire(reserving, alignment);
+    return {device_memory_allocation::increment(allocation), offset.value(),
+            reserving};
+}
+
+
+void planet::vk::device_memory_allocator::reclaim(
+        device_memory_allocation *const allocation,
+        std::size_t const offset,
+        std::size_t const bytes) {
+    /**
+     * Once `clear_without_check` has run there are no pools left to track
+     * the free ranges in, and the block is freed when its last owner lets
+     * go of it.
+     */
+    if (bytes == 0 or allocation->memory_type_index >= pools.size()) {
+        return;
+    }
+    auto &pool = pools[allocation->memory_type_index];
+    std::scoped_lock _{pool.mtx};
+    allocation->free_ranges->release(offset, bytes);
+    c_bytes_reclaimed += static_cast<std::int64_t>(bytes);
+    /**
+     * The caller still holds its own ownership count, so dropping the pool's
+     * count here never frees the block while the lock is held. Keep the last
+     * block around though so that alternating allocate/release calls don't
+     * bounce a block between here and the free list. A block that has
+     * already been dropped keeps `not_ranged`, so its count only drops once.
+     */
+    auto const index = allocation->ranged_index;
+    if (index != device_memory_allocation::not_ranged
+        and allocation->free_ranges->all_free() and pool.ranged.size() > 1u) {
+        pool.ranged[index] = pool.ranged.back();
+        pool.ranged[index]->ranged_index = index;
+        pool.ranged.pop_back();
+        allocation->ranged_index = device_memory_allocation::not_ranged;
+        ++c_free_range_blocks_retired;
+        auto *held = allocation;
+        device_memory_allocation::decrement(held);
+    }
+}
+
+
 void planet::vk::device_memory_allocator::deallocate(
         device_memory_allocation::handle_type h,
         std::uint32_t const memory_type_index,
         std::size_t const size) {
-    if (size <= config.allocation_block_size) {
+    /// After `clear_without_check` the blocks go straight back to the device
+    if (size <= config.allocation_block_size
+        and memory_type_index < pools.size()) {
         auto &pool = pools[memory_type_index];
         std::scoped_lock _{pool.mtx};
         pool.free_memory.push_back(std::move(h));
@@ -304,6 +409,14 @@ void planet::vk::device_memory_allocator::clear_without_check() {
          * with the rest. This is why the reset must run before the drain.
          */
         p.splitting.reset();
+        /**
+         * Drop the pool's ownership of the `free_ranges` blocks too. Any that
+         * are no longer in use end up in the free list ready for the drain.
+         */
+        for (auto *allocation : std::exchange(p.ranged, {})) {
+            allocation->ranged_index = device_memory_allocation::not_ranged;
+            device_memory_allocation::decrement(allocation);
+        }
         /**
          * Hand every whole block in the local free list back to the shared
          * device pool rather than dropping it. Dropping would free the block to
@@ -354,6 +467,11 @@ void planet::vk::device_memory::bind_image_memory(VkImage const image_handle) {
 }
 
 
+void planet::vk::device_memory::release_range() {
+    allocation->allocator->reclaim(allocation, offset, byte_count);
+}
+
+
 planet::vk::device_memory::mapping planet::vk::device_memory::map_memory(
         VkDeviceSize const extra_offset, VkDeviceSize const size) {
     return {allocation, offset + extra_offset, size};
@@ -379,6 +497,11 @@ planet::vk::device_memory planet::vk::device_memory::split(
     device_memory first{
             device_memory_allocation::increment(allocation), aligned_offset,
             bytes};
+    /// Free range blocks take the alignment padding back for re-use
+    if (allocation->free_ranges and aligned_offset > offset) {
+        allocation->allocator->reclaim(
+                allocation, offset, aligned_offset - offset);
+    }
     byte_count -= growth;
     offset += growth;
     return first;
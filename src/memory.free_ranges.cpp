@@ -0,0 +1,160 @@
+#include <planet/vk/memory_free_ranges.hpp>
+
+#include <felspar/exceptions/logic_error.hpp>
+#include <felspar/memory/sizes.hpp>
+
+#include <bit>
+
+
+/// ## `planet::vk::device_memory_free_ranges`
+
+
+planet::vk::device_memory_free_ranges::device_memory_free_ranges(
+        std::size_t const bytes)
+: block_size{bytes}, free_bytes{bytes} {
+    heads.fill(none);
+    if (bytes) { insert(0u, bytes); }
+}
+
+
+auto planet::vk::device_memory_free_ranges::bin_for(
+        std::size_t const bytes) noexcept -> bin_index {
+    std::size_t const first = std::bit_width(bytes) - 1u;
+    if (first >= second_level_bits) {
+        return {first,
+                (bytes >> (first - second_level_bits)) - second_levels};
+    } else {
+        return {first,
+                (bytes << (second_level_bits - first)) - second_levels};
+    }
+}
+
+
+auto planet::vk::device_memory_free_ranges::bin_at_least(
+        std::size_t const bytes) noexcept -> std::optional<bin_index> {
+    std::size_t const first = std::bit_width(bytes) - 1u;
+    if (first >= second_level_bits) {
+        /**
+         * Round up to the start of the next bin so that every range filed in
+         * the bin found can hold `bytes`, not just the larger ones.
+         */
+        std::size_t const round = (std::size_t{1} << (first - second_level_bits))
+                - 1u;
+        if (bytes > none - round) { return {}; }
+        return bin_for(bytes + round);
+    } else {
+        return bin_for(bytes);
+    }
+}
+
+
+std::optional<std::size_t> planet::vk::device_memory_free_ranges::acquire(
+        std::size_t const bytes, std::size_t const alignment) {
+    if (not bytes) {
+        throw felspar::stdexcept::logic_error{
+                "Cannot acquire an empty range of GPU memory"};
+    }
+    auto const search = [this](std::size_t const needed)
+            -> std::optional<std::size_t> {
+        auto const bin = bin_at_least(needed);
+        if (not bin) { return {}; }
+        auto first = bin->first;
+        auto second_map = second_level_maps[first]
+                bitand (~std::uint32_t{} << bin->second);
+        if (not second_map) {
+            auto const first_map = first + 1u < first_levels
+                    ? first_level_map bitand (~std::uint64_t{} << (first + 1u))
+                    : std::uint64_t{};
+            if (not first_map) { return {}; }
+            first = std::countr_zero(first_map);
+            second_map = second_level_maps[first];
+        }
+        return heads[first * second_levels + std::countr_zero(second_map)];
+    };
+    auto const fits = [&](std::size_t const offset) {
+        auto const aligned = felspar::memory::aligned_offset(offset, alignment);
+        return aligned + bytes <= offset + starts.at(offset).bytes;
+    };
+
+    /**
+     * The first range of a large enough bin usually already sits on a suitable
+     * boundary. If it doesn't, search again with room for the worst case
+     * alignment padding, which any range found is then guaranteed to fit.
+     */
+    auto found = search(bytes);
+    if (found and not fits(*found)) {
+        found = alignment > 1u and bytes <= none - (alignment - 1u)
+                ? search(bytes + alignment - 1u)
+                : std::nullopt;
+    }
+    if (not found) { return {}; }
+
+    auto const offset = *found;
+    auto const available = starts.at(offset).bytes;
+    auto const aligned = felspar::memory::aligned_offset(offset, alignment);
+    remove(offset);
+    if (aligned > offset) { insert(offset, aligned - offset); }
+    if (auto const tail = offset + available - (aligned + bytes); tail) {
+        insert(aligned + bytes, tail);
+    }
+    free_bytes -= bytes;
+    return aligned;
+}
+
+
+void planet::vk::device_memory_free_ranges::release(
+        std::size_t offset, std::size_t bytes) {
+    if (not bytes) { return; }
+    if (offset + bytes > block_size or starts.contains(offset)) {
+        throw felspar::stdexcept::logic_error{
+                "Released GPU memory range is not allocated from this block"};
+    }
+    free_bytes += bytes;
+    if (auto const left = ends.find(offset); left != ends.end()) {
+        auto const start = left->second;
+        bytes += starts.at(start).bytes;
+        remove(start);
+        offset = start;
+    }
+    if (auto const right = starts.find(offset + bytes); right != starts.end()) {
+        auto const extra = right->second.bytes;
+        remove(right->first);
+        bytes += extra;
+    }
+    insert(offset, bytes);
+}
+
+
+void planet::vk::device_memory_free_ranges::insert(
+        std::size_t const offset, std::size_t const bytes) {
+    auto const bin = bin_for(bytes);
+    auto &head = heads[bin.first * second_levels + bin.second];
+    starts[offset] = {bytes, none, head};
+    if (head != none) { starts.at(head).previous = offset; }
+    head = offset;
+    ends[offset + bytes] = offset;
+    second_level_maps[bin.first] |= std::uint32_t{1} << bin.second;
+    first_level_map |= std::uint64_t{1} << bin.first;
+}
+
+
+void planet::vk::device_memory_free_ranges::remove(std::size_t const offset) {
+    auto const pos = starts.find(offset);
+    auto const r = pos->second;
+    auto const bin = bin_for(r.bytes);
+    auto &head = heads[bin.first * second_levels + bin.second];
+    if (r.previous != none) {
+        starts.at(r.previous).next = r.next;
+    } else {
+        head = r.next;
+    }
+    if (r.next != none) { starts.at(r.next).previous = r.previous; }
+    if (head == none) {
+        second_level_maps[bin.first] &= ~(std::uint32_t{1} << bin.second);
+        if (not second_level_maps[bin.first]) {
+            first_level_map &= ~(std::uint64_t{1} << bin.first);
+        }
+    }
+    ends.erase(offset + r.bytes);
+    starts.erase(pos);
+}
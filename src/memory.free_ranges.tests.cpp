@@ -0,0 +1,105 @@
+#include <planet/vk/memory_free_ranges.hpp>
+
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::device_memory_free_ranges");
+
+
+    /// ## Acquiring ranges
+
+
+    /// ### A fresh index hands out the block from the start
+    auto const fresh = suite.test("fresh", [](auto check) {
+        planet::vk::device_memory_free_ranges ranges{4u << 10};
+        check(ranges.all_free()) == true;
+        check(ranges.range_count()) == 1u;
+
+        check(ranges.acquire(1u << 10, 1u).value()) == 0u;
+        check(ranges.acquire(1u << 10, 1u).value()) == (1u << 10);
+        check(ranges.bytes_free()) == (2u << 10);
+    });
+
+
+    /// ### Requests that cannot fit return no value
+    auto const exhausted = suite.test("exhausted", [](auto check) {
+        planet::vk::device_memory_free_ranges ranges{4u << 10};
+        check(ranges.acquire(4u << 10, 1u << 10).value()) == 0u;
+        check(ranges.acquire(1u, 1u).has_value()) == false;
+        check(ranges.bytes_free()) == 0u;
+    });
+
+
+    /// ### Alignment padding stays free
+    /**
+     * A 1 byte allocation moves the next 1 KiB aligned request up to offset
+     * 1024. The padding between them is still available to a later small
+     * request.
+     */
+    auto const padding = suite.test("alignment-padding", [](auto check) {
+        planet::vk::device_memory_free_ranges ranges{4u << 10};
+        check(ranges.acquire(1u, 1u).value()) == 0u;
+        check(ranges.acquire(1u << 10, 1u << 10).value()) == (1u << 10);
+        check(ranges.bytes_free()) == (4u << 10) - (1u << 10) - 1u;
+        auto const small = ranges.acquire(512u, 256u).value();
+        check(small) == 256u;
+    });
+
+
+    /// ## Releasing ranges
+
+
+    /// ### A freed range in the middle of a block is reused
+    auto const reuse = suite.test("reuse-freed-middle", [](auto check) {
+        planet::vk::device_memory_free_ranges ranges{4u << 10};
+        auto const first = ranges.acquire(1u << 10, 1u).value();
+        auto const middle = ranges.acquire(1u << 10, 1u).value();
+        auto const last = ranges.acquire(2u << 10, 1u).value();
+        check(ranges.bytes_free()) == 0u;
+
+        ranges.release(middle, 1u << 10);
+        check(ranges.acquire(1u << 10, 1u).value()) == middle;
+
+        ranges.release(first, 1u << 10);
+        ranges.release(last, 2u << 10);
+        check(ranges.range_count()) == 2u;
+    });
+
+
+    /// ### Neighbouring free ranges coalesce
+    auto const coalesce = suite.test("coalesce", [](auto check) {
+        planet::vk::device_memory_free_ranges ranges{3u << 10};
+        auto const a = ranges.acquire(1u << 10, 1u).value();
+        auto const b = ranges.acquire(1u << 10, 1u).value();
+        auto const c = ranges.acquire(1u << 10, 1u).value();
+
+        ranges.release(a, 1u << 10);
+        ranges.release(c, 1u << 10);
+        check(ranges.range_count()) == 2u;
+        ranges.release(b, 1u << 10);
+        check(ranges.range_count()) == 1u;
+        check(ranges.all_free()) == true;
+
+        /// The whole block is one range again
+        check(ranges.acquire(3u << 10, 1u).value()) == 0u;
+    });
+
+
+    /// ### Releasing a range that isn't allocated is an error
+    auto const bad = suite.test("bad-release", [](auto check) {
+        planet::vk::device_memory_free_ranges ranges{4u << 10};
+        check([&]() {
+            ranges.release(0u, 1u << 10);
+        }).throws(std::logic_error{
+                "Released GPU memory range is not allocated from this block"});
+        check([&]() {
+            ranges.release(4u << 10, 1u);
+        }).throws(std::logic_error{
+                "Released GPU memory range is not allocated from this block"});
+    });
+
+
+}
@@ -104,6 +104,136 @@ namespace {
             });
 
 
+    /// ## The `free_ranges` strategy
+
+
+    /// ### Memory freed from the middle of a full block is reused
+    /**
+     * Three 4 KiB allocations fill a 12 KiB block. Under the slab strategy a
+     * fourth allocation would need a new block, even once the middle one has
+     * been freed. With `free_ranges` the freed middle is handed out again.
+     */
+    auto const reuses = suite.test("free-ranges-reuses-freed", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+        auto &vulkan = *vk;
+        auto const mti = any_memory_type(vulkan);
+        auto const before = vulkan.device.block_pool.driver_blocks_allocated();
+
+        planet::vk::device_memory_allocator_configuration config;
+        config.allocation_block_size = 12u << 10; // 12 KiB
+        config.strategy = planet::vk::device_memory_strategy::free_ranges;
+
+        planet::vk::device_memory_allocator allocator{
+                "free-ranges-reuses", vulkan.device, config};
+
+        auto first = allocator.allocate(4u << 10, mti, 1u << 10);
+        auto middle = allocator.allocate(4u << 10, mti, 1u << 10);
+        auto last = allocator.allocate(4u << 10, mti, 1u << 10);
+        check(vulkan.device.block_pool.driver_blocks_allocated())
+                == before + 1u;
+
+        auto const block = middle.get();
+        middle.reset();
+        auto again = allocator.allocate(4u << 10, mti, 1u << 10);
+        check(again.size()) == (4u << 10);
+        check(again.get()) == block;
+        check(vulkan.device.block_pool.driver_blocks_allocated())
+                == before + 1u;
+    });
+
+
+    /// ### Alignment padding left by a split is handed out again
+    /**
+     * A 4 KiB allocation fills the block. Splitting a 1 KiB aligned piece off
+     * after a 512 byte one leaves 512 bytes of padding, which a later
+     * allocation can then use without needing a new block.
+     */
+    auto const padding =
+            suite.test("free-ranges-split-padding", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+        auto &vulkan = *vk;
+        auto const mti = any_memory_type(vulkan);
+        auto const before = vulkan.device.block_pool.driver_blocks_allocated();
+
+        planet::vk::device_memory_allocator_configuration config;
+        config.allocation_block_size = 4u << 10;
+        config.strategy = planet::vk::device_memory_strategy::free_ranges;
+        planet::vk::device_memory_allocator allocator{
+                "free-ranges-padding", vulkan.device, config};
+
+        auto whole = allocator.allocate(4u << 10, mti, 1u << 10);
+        auto const block = whole.get();
+        auto const start = whole.split(512, 1);
+        auto const aligned = whole.split(1u << 10, 1u << 10);
+        check(whole.size()) == (2u << 10);
+
+        auto const reused = allocator.allocate(512, mti, 512);
+        check(reused.get()) == block;
+        check(vulkan.device.block_pool.driver_blocks_allocated())
+                == before + 1u;
+    });
+
+
+    /// ### A block leaves the free range set only once
+    /**
+     * Splitting off the whole of an allocation leaves an empty remainder that
+     * still shares the block. Once the block has been dropped from the set for
+     * being all free, releasing the remainder must not drop it again.
+     */
+    auto const once = suite.test("free-ranges-retires-once", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+        auto &vulkan = *vk;
+        auto const mti = any_memory_type(vulkan);
+        auto const before = vulkan.device.block_pool.driver_blocks_allocated();
+
+        planet::vk::device_memory_allocator_configuration config;
+        config.allocation_block_size = 4u << 10;
+        config.strategy = planet::vk::device_memory_strategy::free_ranges;
+        planet::vk::device_memory_allocator allocator{
+                "free-ranges-once", vulkan.device, config};
+
+        auto first = allocator.allocate(4u << 10, mti, 1u << 10);
+        auto const second = allocator.allocate(4u << 10, mti, 1u << 10);
+        auto const third = allocator.allocate(4u << 10, mti, 1u << 10);
+        auto all = first.split(4u << 10, 1);
+        check(first.size()) == 0u;
+        all.reset();
+        first.reset();
+
+        /// The first block is back on the free list and is used again
+        auto const again = allocator.allocate(4u << 10, mti, 1u << 10);
+        check(again.size()) == (4u << 10);
+        check(vulkan.device.block_pool.driver_blocks_allocated())
+                == before + 3u;
+    });
+
+
+    /// ### Memory can be released after the allocator has been cleared
+    auto const cleared = suite.test("free-ranges-after-clear", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+        auto &vulkan = *vk;
+        auto const mti = any_memory_type(vulkan);
+        auto const before = vulkan.device.block_pool.driver_blocks_allocated();
+
+        planet::vk::device_memory_allocator_configuration config;
+        config.allocation_block_size = 12u << 10;
+        config.strategy = planet::vk::device_memory_strategy::free_ranges;
+        planet::vk::device_memory_allocator allocator{
+                "free-ranges-cleared", vulkan.device, config};
+
+        auto memory = allocator.allocate(4u << 10, mti, 1u << 10);
+        allocator.clear_without_check();
+        memory.reset();
+        check(vulkan.device.block_pool.driver_blocks_allocated())
+                == before + 1u;
+    });
+
+
 }
 
 
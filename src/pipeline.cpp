@@ -4,6 +4,8 @@
 #include <planet/vk/render_pass.hpp>
 #include <planet/vk/shader_module.hpp>
 
+#include <chrono>
+
 
 /// ## `planet::vk::pipeline_layout`
 
@@ -61,7 +63,9 @@ planet::vk::graphics_pipeline::graphics_pipeline(
     info.layout = layout.get();
 
     VkPipeline ph = VK_NULL_HANDLE;
+    auto const started = std::chrono::steady_clock::now();
     planet::vk::worked(vkCreateGraphicsPipelines(
-            device.get(), VK_NULL_HANDLE, 1, &info, nullptr, &ph));
+            device.get(), d.pipeline_cache.get(), 1, &info, nullptr, &ph));
+    d.pipeline_cache.created(std::chrono::steady_clock::now() - started);
     handle = handle_type::bind(device.get(), ph);
 }
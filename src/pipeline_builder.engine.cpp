@@ -0,0 +1,93 @@
+#include <planet/log.hpp>
+#include <planet/vk/engine/pipeline_builder.hpp>
+
+#include <algorithm>
+
+
+using namespace std::literals;
+
+
+/// ## `planet::vk::engine::pipeline_builder`
+
+
+planet::vk::engine::pipeline_builder::pipeline_builder(
+        engine::app &a, std::size_t const threads)
+: app{a} {
+    auto const count = std::max<std::size_t>(threads, 1);
+    workers.reserve(count);
+    for (std::size_t index{}; index < count; ++index) {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+
+
+planet::vk::engine::pipeline_builder::~pipeline_builder() {
+    {
+        std::scoped_lock _{mutex};
+        stopping = true;
+    }
+    signal.notify_all();
+    for (auto &worker : workers) { worker.join(); }
+}
+
+
+auto planet::vk::engine::pipeline_builder::build(
+        graphics_pipeline_parameters parameters,
+        std::source_location const &loc)
+        -> std::future<graphics_pipeline> {
+    auto vertex_shader = shader_module_for(app, parameters.vertex_shader);
+    auto fragment_shader = shader_module_for(app, parameters.fragment_shader);
+    std::packaged_task<graphics_pipeline()> task{
+            [parameters = std::move(parameters),
+             vertex_shader = std::move(vertex_shader),
+             fragment_shader = std::move(fragment_shader), loc]() mutable {
+                return create_graphics_pipeline(
+                        std::move(parameters), std::move(vertex_shader),
+                        std::move(fragment_shader), loc);
+            }};
+    auto future = task.get_future();
+    {
+        std::scoped_lock _{mutex};
+        queue.push_back(std::move(task));
+    }
+    signal.notify_one();
+    return future;
+}
+
+
+auto planet::vk::engine::pipeline_builder::build(
+        std::vector<graphics_pipeline_parameters> parameters,
+        std::source_location const &loc)
+        -> std::vector<std::future<graphics_pipeline>> {
+    std::vector<std::future<graphics_pipeline>> futures;
+    futures.reserve(parameters.size());
+    for (auto &p : parameters) { futures.push_back(build(std::move(p), loc)); }
+    return futures;
+}
+
+
+auto planet::vk::engine::pipeline_builder::ready(
+        std::future<graphics_pipeline> future)
+        -> felspar::coro::task<graphics_pipeline> {
+    constexpr auto wait_time = 1ms;
+    while (future.wait_for(0s) != std::future_status::ready) {
+        co_await app.sdl.io.sleep(wait_time);
+    }
+    co_return future.get();
+}
+
+
+void planet::vk::engine::pipeline_builder::work() {
+    while (true) {
+        std::packaged_task<graphics_pipeline()> task;
+        {
+            std::unique_lock lock{mutex};
+            signal.wait(lock, [this]() { return stopping or not queue.empty(); });
+            if (queue.empty()) { return; }
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        /// Exceptions end up in the future
+        task();
+    }
+}
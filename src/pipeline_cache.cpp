@@ -0,0 +1,133 @@
+#include <planet/log.hpp>
+#include <planet/vk/device.hpp>
+#include <planet/vk/instance.hpp>
+#include <planet/vk/pipeline_cache.hpp>
+
+#include <felspar/exceptions/runtime_error.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+
+/// ## `planet::vk::pipeline_cache`
+
+
+planet::vk::pipeline_cache::pipeline_cache(vk::device &d) : device{d} {}
+
+
+void planet::vk::pipeline_cache::create(
+        std::span<std::byte const> initial_data) {
+    if (not initial_data.empty() and not is_compatible(initial_data)) {
+        ++c_rejected;
+        initial_data = {};
+    }
+    VkPipelineCacheCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.initialDataSize = initial_data.size();
+    info.pInitialData = initial_data.data();
+    handle.create<vkCreatePipelineCache>(device.get(), info);
+    warm = not initial_data.empty();
+}
+
+
+bool planet::vk::pipeline_cache::is_compatible(
+        std::span<std::byte const> const data) const noexcept {
+    VkPipelineCacheHeaderVersionOne header{};
+    if (data.size() < sizeof(header)) { return false; }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    auto const &properties = device.instance.gpu().properties;
+    return header.headerSize >= sizeof(header)
+            and header.headerSize <= data.size()
+            and header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            and header.vendorID == properties.vendorID
+            and header.deviceID == properties.deviceID
+            and std::ranges::equal(
+                    header.pipelineCacheUUID, properties.pipelineCacheUUID);
+}
+
+
+bool planet::vk::pipeline_cache::load(std::filesystem::path const &filename) {
+    std::ifstream file{filename, std::ios::binary};
+    if (not file) {
+        planet::log::info("No pipeline cache found at", filename.string());
+        return false;
+    }
+    std::vector<std::byte> bytes(std::filesystem::file_size(filename));
+    file.read(
+            reinterpret_cast<char *>(bytes.data()),
+            static_cast<std::streamsize>(bytes.size()));
+    bytes.resize(static_cast<std::size_t>(file.gcount()));
+    if (not is_compatible(bytes)) {
+        ++c_rejected;
+        planet::log::info(
+                "Ignoring pipeline cache from another GPU or driver",
+                filename.string());
+        return false;
+    }
+
+    pipeline_cache loaded{device};
+    loaded.create(bytes);
+    VkPipelineCache const source = loaded.get();
+    planet::vk::worked(
+            vkMergePipelineCaches(device.get(), get(), 1, &source));
+    warm = true;
+    planet::log::info(
+            "Loaded pipeline cache", filename.string(), "bytes", bytes.size());
+    return true;
+}
+
+
+std::vector<std::byte> planet::vk::pipeline_cache::data() const {
+    std::size_t size{};
+    planet::vk::worked(
+            vkGetPipelineCacheData(device.get(), get(), &size, nullptr));
+    std::vector<std::byte> bytes(size);
+    planet::vk::worked(vkGetPipelineCacheData(
+            device.get(), get(), &size, bytes.data()));
+    bytes.resize(size);
+    return bytes;
+}
+
+
+void planet::vk::pipeline_cache::save(
+        std::filesystem::path const &filename) const {
+    auto const bytes = data();
+    if (filename.has_parent_path()) {
+        std::filesystem::create_directories(filename.parent_path());
+    }
+
+    auto temporary = filename;
+    temporary += ".tmp";
+    {
+        std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+        file.write(
+                reinterpret_cast<char const *>(bytes.data()),
+                static_cast<std::streamsize>(bytes.size()));
+        if (not file) {
+            throw felspar::stdexcept::runtime_error{
+                    "Could not write pipeline cache to "
+                    + temporary.string()};
+        }
+    }
+    std::filesystem::rename(temporary, filename);
+    planet::log::info(
+            "Saved pipeline cache", filename.string(), "bytes", bytes.size());
+}
+
+
+void planet::vk::pipeline_cache::created(
+        std::chrono::steady_clock::duration const taken) {
+    auto const us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            taken)
+                            .count();
+    std::scoped_lock _{timing_mutex};
+    if (warm) {
+        ++c_warm_pipelines;
+        c_warm_us += us;
+    } else {
+        ++c_cold_pipelines;
+        c_cold_us += us;
+    }
+}
@@ -0,0 +1,53 @@
+#include <planet/log.hpp>
+#include <planet/vk/device.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::pipeline_cache", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Only data for this GPU is accepted
+    auto const header = suite.test("header", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        auto bytes = vk->device.pipeline_cache.data();
+        check(vk->device.pipeline_cache.is_compatible(bytes)) == true;
+
+        check(vk->device.pipeline_cache.is_compatible({})) == false;
+        auto truncated = bytes;
+        truncated.resize(8);
+        check(vk->device.pipeline_cache.is_compatible(truncated)) == false;
+
+        /// The UUID starts after four 32 bit header fields
+        bytes[16] = ~bytes[16];
+        check(vk->device.pipeline_cache.is_compatible(bytes)) == false;
+    });
+
+
+    /// ## Saved caches can be loaded again
+    auto const round_trip = suite.test("round-trip", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        auto const filename = std::filesystem::temp_directory_path()
+                / "planet-vk-tests" / "pipeline.cache";
+        std::filesystem::remove(filename);
+        check(vk->device.pipeline_cache.load(filename)) == false;
+
+        vk->device.pipeline_cache.save(filename);
+        check(std::filesystem::exists(filename)) == true;
+        check(vk->device.pipeline_cache.load(filename)) == true;
+        std::filesystem::remove(filename);
+    });
+
+
+}
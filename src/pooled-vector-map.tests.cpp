@@ -820,4 +820,142 @@ namespace {
             });
 
 
+    using flat_map = planet::vk::engine::memory::flat_pooled_vector_map<
+            int, std::vector<float>>;
+
+
+    auto const flat = s.test(
+            "flat map",
+            [](auto check) {
+                flat_map m;
+                check(m.empty()) == true;
+                m.push_back(1, 1.0f);
+                m.emplace_back(1, 2.0f);
+                m.push_back(2, 3.0f);
+                check(m.empty()) == false;
+                check(m.non_empty_count()) == 2u;
+                auto gen = m.non_empty_vectors();
+                auto [key1, vec1] = *gen.next();
+                check(key1) == 1;
+                check(vec1.size()) == 2u;
+                check(vec1[1]) == 2.0f;
+                auto [key2, vec2] = *gen.next();
+                check(key2) == 2;
+                check(vec2[0]) == 3.0f;
+                check(gen.next()).is_falsey();
+            },
+            [](auto check) {
+                flat_map m;
+                m.push_back(1, 1.0f);
+                m.push_back(2, 2.0f);
+                m.clear(); // First clear - vectors emptied, keys remain
+                check(m.non_empty_count()) == 0u;
+                check(m.contains(1)) == true;
+                check(m.contains(2)) == true;
+                m.push_back(2, 2.0f);
+                m.clear(); // Only the unused key is removed
+                check(m.contains(1)) == false;
+                check(m.contains(2)) == true;
+                m.clear();
+                check(m.contains(2)) == false;
+                check(m.empty()) == true;
+                bool yielded = false;
+                for ([[maybe_unused]] auto [key, vec] : m.non_empty_vectors()) {
+                    yielded = true;
+                }
+                check(yielded) == false;
+            },
+            [](auto check) {
+                /// A new key takes over a dropped key's vector
+                flat_map m;
+                for (int index{}; index < 100; ++index) {
+                    m.push_back(1, static_cast<float>(index));
+                }
+                m.clear();
+                m.clear();
+                check(m.contains(1)) == false;
+                m.push_back(2, 1.0f);
+                auto [key, vec] = *m.non_empty_vectors().next();
+                check(key) == 2;
+                check(vec.size()) == 1u;
+                check(vec.capacity() >= 100u) == true;
+            },
+            [](auto check) {
+                /// The table grows and keeps finding every key
+                flat_map m;
+                for (int key{}; key < 1000; ++key) {
+                    m.push_back(key, static_cast<float>(key));
+                }
+                check(m.non_empty_count()) == 1000u;
+                for (int key{}; key < 1000; key += 2) {
+                    m.push_back(key, static_cast<float>(key));
+                }
+                m.clear();
+                for (int key{}; key < 1000; key += 2) {
+                    m.push_back(key, static_cast<float>(key));
+                }
+                m.clear();
+                for (int key{}; key < 1000; ++key) {
+                    check(m.contains(key)) == (key % 2 == 0);
+                }
+                check(m.contains(1000)) == false;
+                for (int key{}; key < 1000; key += 4) {
+                    m.push_back(key, static_cast<float>(key));
+                }
+                std::size_t count = 0;
+                for (auto [key, vec] : m.non_empty_vectors()) {
+                    check(vec.size()) == 1u;
+                    check(vec[0]) == static_cast<float>(key);
+                    ++count;
+                }
+                check(count) == 250u;
+            });
+
+
+    /// ## Same batches as the `std::map` instantiation
+    /**
+     * Each frame draws a number of items spread over the textures, walks the
+     * batches and clears them, which is what the pipelines do. Every batch
+     * is recorded so that the two maps can be compared. The timings for this
+     * workload are in `planet-vk-bench`.
+     */
+    template<typename Map>
+    std::map<int const *, std::vector<float>>
+            frames(std::vector<int> const &textures) {
+        constexpr std::size_t frame_count = 20, items_per_texture = 20;
+        std::map<int const *, std::vector<float>> batches;
+        Map m;
+        for (std::size_t frame{}; frame < frame_count; ++frame) {
+            for (std::size_t item{}; item < items_per_texture; ++item) {
+                for (std::size_t index{}; index < textures.size(); ++index) {
+                    /// Step through the textures out of order
+                    auto const &t =
+                            textures[(index * 7 + item) % textures.size()];
+                    m.push_back(&t, static_cast<float>(item));
+                }
+            }
+            for (auto [key, vec] : m.non_empty_vectors()) {
+                auto &batch = batches[key];
+                batch.insert(batch.end(), vec.begin(), vec.end());
+            }
+            m.clear();
+        }
+        return batches;
+    }
+
+
+    auto const equivalence = s.test("equivalence", [](auto check) {
+        using tree_type = planet::vk::engine::memory::pooled_vector_map<
+                std::map<int const *, std::vector<float>>>;
+        using flat_type = planet::vk::engine::memory::flat_pooled_vector_map<
+                int const *, std::vector<float>>;
+        for (std::size_t const count : {10u, 100u, 1000u}) {
+            std::vector<int> const textures(count);
+            auto const tree = frames<tree_type>(textures);
+            auto const flat = frames<flat_type>(textures);
+            check(flat.size()) == count;
+            check(flat == tree) == true;
+        }
+    });
+
 }
@@ -0,0 +1,178 @@
+#include <planet/vk/engine/quad_index_buffer.hpp>
+
+#include <felspar/exceptions/logic_error.hpp>
+
+#include <algorithm>
+#include <type_traits>
+
+
+namespace {
+    /// The vertex numbers of `2^30` quads still fit in 32 bits
+    constexpr std::size_t max_wide_quads = std::size_t{1} << 30;
+
+    void check_limit(std::size_t const needed, std::size_t const limit) {
+        if (needed > limit) {
+            throw felspar::stdexcept::logic_error{
+                    "Too many quads for a single quad index buffer"};
+        }
+    }
+}
+
+
+/// ## `planet::vk::engine::quad_index_buffer`
+
+
+planet::vk::engine::quad_index_buffer::quad_index_buffer(
+        std::string_view const n, vk::device &d)
+: id{n, id::suffix::suppress},
+  allocator{std::string{name()} + "__memory", d},
+  pool{d, d.instance.surface} {}
+
+
+VkIndexType planet::vk::engine::quad_index_buffer::bind(
+        command_buffer &cb, std::size_t const needed) {
+    if (needed <= max_narrow_quads) {
+        vkCmdBindIndexBuffer(
+                cb.get(), buffer_for(narrow, needed, max_narrow_quads), 0,
+                VK_INDEX_TYPE_UINT16);
+        return VK_INDEX_TYPE_UINT16;
+    } else {
+        vkCmdBindIndexBuffer(
+                cb.get(), buffer_for(wide, needed, max_wide_quads), 0,
+                VK_INDEX_TYPE_UINT32);
+        return VK_INDEX_TYPE_UINT32;
+    }
+}
+
+
+void planet::vk::engine::quad_index_buffer::reserve(std::size_t const quads) {
+    std::scoped_lock _{mutex};
+    if (quads <= max_narrow_quads) {
+        narrow.wanted = std::max(narrow.wanted, quads);
+    } else {
+        check_limit(quads, max_wide_quads);
+        wide.wanted = std::max(wide.wanted, quads);
+    }
+}
+
+
+void planet::vk::engine::quad_index_buffer::next_frame() {
+    std::scoped_lock _{mutex};
+    ++frames;
+    std::erase_if(retired, [this](auto const &r) {
+        return r.release_after <= frames;
+    });
+    upload(narrow, max_narrow_quads);
+    upload(wide, max_wide_quads);
+}
+
+
+template<typename Index>
+VkBuffer planet::vk::engine::quad_index_buffer::buffer_for(
+        indices<Index> &current,
+        std::size_t const needed,
+        std::size_t const limit) {
+    if (needed <= current.quads.load(std::memory_order_acquire)) {
+        return current.handle.load(std::memory_order_acquire);
+    }
+
+    std::scoped_lock _{mutex};
+    auto const quads = current.quads.load(std::memory_order_relaxed);
+    if (needed > quads) {
+        check_limit(needed, limit);
+        auto const capacity =
+                std::min(std::max({needed, 2 * quads, minimum_quads}), limit);
+        /**
+         * The indices are written straight into host visible memory, because
+         * submitting a copy here could clash with the frame's own submission
+         * and would stall the recording.
+         */
+        std::vector<Index> pattern_indices(capacity * indices_per_quad);
+        fill<Index>(pattern_indices);
+        replace(current,
+                buffer<Index>{
+                        allocator, std::span<Index const>{pattern_indices},
+                        VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT},
+                capacity);
+        current.device_local = false;
+    }
+    return current.handle.load(std::memory_order_relaxed);
+}
+
+
+template<typename Index>
+void planet::vk::engine::quad_index_buffer::upload(
+        indices<Index> &current, std::size_t const limit) {
+    auto const quads = current.quads.load(std::memory_order_relaxed);
+    auto capacity = quads;
+    if (current.wanted > quads) {
+        capacity = std::min(
+                std::max({current.wanted, 2 * quads, minimum_quads}), limit);
+    }
+    current.wanted = {};
+    if (capacity == 0 or (current.device_local and capacity == quads)) {
+        return;
+    }
+
+    std::vector<Index> pattern_indices(capacity * indices_per_quad);
+    fill<Index>(pattern_indices);
+    buffer<Index> staging{
+            allocator, std::span<Index const>{pattern_indices},
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+    buffer<Index> local{
+            allocator, pattern_indices.size(),
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+
+    auto cb = command_buffer::single_use(pool);
+    VkBufferCopy region{};
+    region.size = staging.byte_count();
+    vkCmdCopyBuffer(cb.get(), staging.get(), local.get(), 1, &region);
+    /// Frames submitted to the queue after the copy may read the indices
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDEX_READ_BIT;
+    vkCmdPipelineBarrier(
+            cb.get(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0,
+            nullptr);
+    auto copy = std::move(cb).end_and_submit_async();
+    copy.keep_alive(std::move(staging));
+    retired.push_back(
+            {.release_after = frames + max_frames_in_flight,
+             .copy = std::move(copy)});
+
+    replace(current, std::move(local), capacity);
+    current.device_local = true;
+    ++c_uploads;
+}
+
+
+template<typename Index>
+void planet::vk::engine::quad_index_buffer::replace(
+        indices<Index> &current,
+        buffer<Index> replacement,
+        std::size_t const quads) {
+    /// Frames still in flight, and this one, may already have bound the old
+    if (current.memory) {
+        retired_buffer r{.release_after = frames + max_frames_in_flight};
+        if constexpr (std::is_same_v<Index, std::uint16_t>) {
+            r.narrow = std::move(current.memory);
+        } else {
+            r.wide = std::move(current.memory);
+        }
+        retired.push_back(std::move(r));
+    }
+    if (quads > current.quads.load(std::memory_order_relaxed)) {
+        ++c_grown;
+        c_capacity.value(quads);
+    }
+    current.memory = std::move(replacement);
+    current.handle.store(current.memory.get(), std::memory_order_release);
+    current.quads.store(quads, std::memory_order_release);
+}
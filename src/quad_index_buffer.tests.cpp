@@ -0,0 +1,132 @@
+#include <planet/log.hpp>
+#include <planet/vk/engine/quad_index_buffer.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    using quad_index_buffer = planet::vk::engine::quad_index_buffer;
+
+
+    auto const suite = felspar::testsuite("engine::quad_index_buffer", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Each quad uses its own four vertices
+    auto const fills = suite.test("fill", [](auto check) {
+        std::array<std::uint32_t, 3 * quad_index_buffer::indices_per_quad>
+                indices{};
+        quad_index_buffer::fill<std::uint32_t>(indices);
+        check(indices[0]) == 0u;
+        check(indices[1]) == 1u;
+        check(indices[2]) == 2u;
+        check(indices[3]) == 0u;
+        check(indices[4]) == 2u;
+        check(indices[5]) == 3u;
+        check(indices[6]) == 4u;
+        check(indices[11]) == 7u;
+        check(indices[17]) == 11u;
+
+        quad_index_buffer::fill<std::uint32_t>(indices, 10);
+        check(indices[0]) == 40u;
+        check(indices[17]) == 51u;
+    });
+
+
+    /// ## The last narrow quad still fits in 16 bits
+    auto const narrow = suite.test("fill narrow", [](auto check) {
+        std::array<std::uint16_t, quad_index_buffer::indices_per_quad>
+                indices{};
+        quad_index_buffer::fill<std::uint16_t>(
+                indices, quad_index_buffer::max_narrow_quads - 1);
+        check(indices[0]) == 65532u;
+        check(indices[2]) == 65534u;
+        check(indices[5]) == 65535u;
+    });
+
+
+    /// ## The buffer grows geometrically
+    auto const grows = suite.test("grow", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        quad_index_buffer quads{
+                "planet_vk_engine_quad_index_buffer_tests", vk->device};
+        check(quads.narrow_capacity()) == 0u;
+        check(quads.wide_capacity()) == 0u;
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+
+        auto cb = planet::vk::command_buffer::single_use(pool);
+        check(quads.bind(cb, 10) == VK_INDEX_TYPE_UINT16) == true;
+        check(quads.narrow_capacity()) == quad_index_buffer::minimum_quads;
+        quads.bind(cb, quad_index_buffer::minimum_quads);
+        check(quads.c_grown.value()) == 1;
+
+        quads.bind(cb, quad_index_buffer::minimum_quads + 1);
+        check(quads.narrow_capacity())
+                == 2 * quad_index_buffer::minimum_quads;
+        quads.bind(cb, 5 * quad_index_buffer::minimum_quads);
+        check(quads.narrow_capacity())
+                == 5 * quad_index_buffer::minimum_quads;
+        check(quads.c_grown.value()) == 3;
+
+        /// Narrow growth stops at the 16 bit limit
+        check(quads.bind(cb, quad_index_buffer::max_narrow_quads)
+              == VK_INDEX_TYPE_UINT16)
+                == true;
+        check(quads.narrow_capacity()) == quad_index_buffer::max_narrow_quads;
+        check(quads.wide_capacity()) == 0u;
+
+        /// Past it batches move to the wide buffer
+        check(quads.bind(cb, quad_index_buffer::max_narrow_quads + 1)
+              == VK_INDEX_TYPE_UINT32)
+                == true;
+        check(quads.wide_capacity())
+                == quad_index_buffer::max_narrow_quads + 1;
+        check(quads.c_grown.value()) == 5;
+        std::move(cb).end_and_submit_async().wait();
+
+        check(quads.c_uploads.value()) == 0;
+
+        /// The next frame moves both buffers into device local memory once
+        for (std::size_t frame{};
+             frame < planet::vk::engine::max_frames_in_flight; ++frame) {
+            quads.next_frame();
+        }
+        check(quads.narrow_capacity()) == quad_index_buffer::max_narrow_quads;
+        check(quads.c_uploads.value()) == 2;
+        check(quads.c_grown.value()) == 5;
+    });
+
+
+    /// ## Reserved space is made before the frame that uses it
+    auto const reserves = suite.test("reserve", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        quad_index_buffer quads{
+                "planet_vk_engine_quad_index_buffer_tests", vk->device};
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+
+        quads.reserve(3000);
+        check(quads.narrow_capacity()) == 0u;
+        quads.next_frame();
+        check(quads.narrow_capacity()) == 3000u;
+        check(quads.c_uploads.value()) == 1;
+        check(quads.c_grown.value()) == 1;
+
+        auto cb = planet::vk::command_buffer::single_use(pool);
+        quads.bind(cb, 3000);
+        check(quads.c_grown.value()) == 1;
+        std::move(cb).end_and_submit_async().wait();
+        quads.next_frame();
+        check(quads.c_uploads.value()) == 1;
+    });
+
+
+}
@@ -2,6 +2,7 @@
 #include <planet/telemetry/counter.hpp>
 #include <planet/telemetry/rate.hpp>
 #include <planet/vk/engine/renderer.hpp>
+#include <planet/vk/trace.hpp>
 
 #include <algorithm>
 #include <cstring>
@@ -119,6 +120,7 @@ planet::vk::engine::renderer::renderer(engine::app &a)
   coordinates{app.device.startup_memory, {}} {
     reset_screen_coordinates();
     swap_chain.create_frame_buffers(postprocess.present_render_pass);
+    start_frames.post(*this, &renderer::starter);
 }
 
 
@@ -166,32 +168,63 @@ void planet::vk::engine::renderer::reset_world_coordinates(
 
 void planet::vk::engine::renderer::set_viewport(
         affine::rectangle2d const &rect) noexcept {
-    auto &cb = command_buffers[fif_image_index];
-    VkViewport viewport = {};
-    viewport.x = static_cast<float>(rect.top_left.x());
-    viewport.y = static_cast<float>(rect.top_left.y() + rect.extents.height);
-    viewport.width = static_cast<float>(rect.extents.width);
-    viewport.height = -static_cast<float>(rect.extents.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(cb.get(), 0, 1, &viewport);
+    viewport_rectangle = rect;
+    if (not secondaries) { record_viewport(command_buffers[fif_image_index]); }
 }
 
 
 void planet::vk::engine::renderer::set_scissor(
         affine::rectangle2d const &rect) noexcept {
-    auto &cb = command_buffers[fif_image_index];
+    scissor_rectangle = rect;
+    if (not secondaries) { record_scissor(command_buffers[fif_image_index]); }
+}
+
+
+void planet::vk::engine::renderer::record_viewport_and_scissor(
+        command_buffer &cb) noexcept {
+    record_viewport(cb);
+    record_scissor(cb);
+}
+void planet::vk::engine::renderer::record_viewport(
+        command_buffer &cb) noexcept {
+    auto const &vp = viewport_rectangle;
+    VkViewport viewport = {};
+    viewport.x = static_cast<float>(vp.top_left.x());
+    viewport.y = static_cast<float>(vp.top_left.y() + vp.extents.height);
+    viewport.width = static_cast<float>(vp.extents.width);
+    viewport.height = -static_cast<float>(vp.extents.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cb.get(), 0, 1, &viewport);
+}
+void planet::vk::engine::renderer::record_scissor(
+        command_buffer &cb) noexcept {
+    auto const &sc = scissor_rectangle;
     VkRect2D scissor = {};
     scissor.offset = {
-            static_cast<int32_t>(rect.top_left.x()),
-            static_cast<int32_t>(rect.top_left.y())};
+            static_cast<int32_t>(sc.top_left.x()),
+            static_cast<int32_t>(sc.top_left.y())};
     scissor.extent = {
-            static_cast<uint32_t>(rect.extents.width),
-            static_cast<uint32_t>(rect.extents.height)};
+            static_cast<uint32_t>(sc.extents.width),
+            static_cast<uint32_t>(sc.extents.height)};
     vkCmdSetScissor(cb.get(), 0, 1, &scissor);
 }
 
 
+void planet::vk::engine::renderer::record_secondary(std::size_t const threads) {
+    for (auto &f : fence) {
+        std::array waitfor{f.get()};
+        vkWaitForFences(
+                app.device.get(), waitfor.size(), waitfor.data(), VK_TRUE,
+                UINT64_MAX);
+    }
+    secondaries.reset();
+    if (threads) {
+        secondaries.emplace(app.device, app.instance.surface, threads);
+    }
+}
+
+
 namespace {
     planet::telemetry::counter c_recreate_swapchain{
             "planet_vk_engine_renderer__recreate_swapchain_count"};
@@ -231,6 +264,7 @@ bool planet::vk::engine::renderer::recreate_swap_chain(
      * extents are not the same as the old ones. In all cases we have to replace
      * the frame buffers.
      */
+    trace::scope const tracing{"renderer::recreate_swap_chain", "renderer"};
     ++c_recreate_swapchain;
     auto const images = swap_chain.recreate(extents);
     /**
@@ -300,55 +334,152 @@ bool planet::vk::engine::renderer::recreate_swap_chain(
 
 /// #### `start`
 namespace {
+    /**
+     * The rates count the waits, and the `_us` counters the total time spent
+     * waiting in microseconds.
+     */
     planet::telemetry::real_time_rate c_fence_wait{
             "planet_vk_engine_renderer_fence_wait", 500ms};
+    planet::telemetry::counter c_fence_wait_us{
+            "planet_vk_engine_renderer_fence_wait_us"};
     planet::telemetry::real_time_rate c_acquire_wait{
             "planet_vk_engine_renderer_acquire_next_image_wait", 500ms};
+    planet::telemetry::counter c_acquire_wait_us{
+            "planet_vk_engine_renderer_acquire_next_image_wait_us"};
+
+    auto as_us(planet::vk::engine::gpu_completion::duration const d) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(d)
+                .count();
+    }
 }
-felspar::coro::task<std::size_t>
+planet::vk::engine::renderer::start_awaitable
         planet::vk::engine::renderer::start(VkClearValue const colour) {
-    constexpr auto wait_time = 5ms;
-    // Wait for the previous version of this frame number to finish
-    while (not fence[fif_image_index].is_ready()) {
-        c_fence_wait.tick();
-        co_await app.sdl.io.sleep(wait_time);
+    return {*this, colour};
+}
+
+
+planet::vk::engine::renderer::start_awaitable::~start_awaitable() {
+    /// The frame still starts, but nothing is resumed once it has
+    if (mine and renderer.start_requester == mine) {
+        renderer.start_requester = {};
     }
+}
+std::coroutine_handle<>
+        planet::vk::engine::renderer::start_awaitable::await_suspend(
+                std::coroutine_handle<> const h) {
+    if (renderer.starting or not renderer.starter_handle) {
+        throw felspar::stdexcept::logic_error{
+                "The renderer is already starting a frame"};
+    }
+    mine = h;
+    renderer.starting = true;
+    renderer.start_requester = h;
+    renderer.start_colour = colour;
+    return renderer.starter_handle;
+}
+std::size_t planet::vk::engine::renderer::start_awaitable::await_resume() {
+    if (auto failed = std::exchange(renderer.start_failure, {})) {
+        std::rethrow_exception(failed);
+    }
+    return renderer.fif_image_index;
+}
 
-    // Get an image from the swap chain
-    scfb_image_index = 0;
-    while (true) {
-        auto result = vkAcquireNextImageKHR(
-                app.device.get(), swap_chain.get(), {},
-                img_avail_semaphore[fif_image_index].get(), VK_NULL_HANDLE,
-                &scfb_image_index);
-        if (result == VK_TIMEOUT or result == VK_NOT_READY) {
-            /**
-             * Whilst we wait for the frame to become available we'll sleep
-             * here. That allows coroutines for handling IO and game logic to
-             * run whilst we wait.
-             */
-            c_acquire_wait.tick();
-            co_await app.sdl.io.sleep(wait_time);
-        } else if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-            /**
-             * A successful rebuild lets the next acquire proceed at once. When
-             * the rebuild is skipped -- a minimised window has no drawable to
-             * build against -- re-acquiring would immediately report out of
-             * date again, so sleep to avoid spinning until the window has a
-             * usable size once more.
-             */
-            if (not recreate_swap_chain(result)) {
-                co_await app.sdl.io.sleep(wait_time);
-            }
-        } else if (result == VK_SUBOPTIMAL_KHR) {
-            swap_chain_suboptimal = true;
-            break;
-        } else if (result == VK_SUCCESS) {
-            break;
+
+/// The `starter` waits here between frames
+struct planet::vk::engine::renderer::start_request {
+    engine::renderer &renderer;
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<>
+            await_suspend(std::coroutine_handle<> const h) noexcept {
+        renderer.starter_handle = h;
+        renderer.starting = false;
+        if (auto requester = std::exchange(renderer.start_requester, {})) {
+            return requester;
         } else {
-            planet::vk::worked(result);
+            return std::noop_coroutine();
         }
     }
+    void await_resume() const noexcept {}
+};
+
+
+felspar::coro::task<void> planet::vk::engine::renderer::starter() {
+    constexpr auto wait_time = 5ms;
+    while (true) {
+        co_await start_request{*this};
+        start_failure = {};
+        try {
+            // Wait for the previous version of this frame number to finish
+            if (not fence[fif_image_index].is_ready()) {
+                trace::scope const tracing{"renderer::fence_wait", "renderer"};
+                c_fence_wait.tick();
+                c_fence_wait_us += as_us(
+                        co_await gpu_completion.wait(fence[fif_image_index]));
+            }
+
+            // Get an image from the swap chain
+            trace::scope acquiring{"renderer::acquire", "renderer"};
+            if (swap_chain.offscreen()) {
+                /// Each frame in flight has an off-screen image of its own
+                scfb_image_index = static_cast<std::uint32_t>(fif_image_index);
+            } else {
+                scfb_image_index = 0;
+                auto const acquire = [this](std::uint64_t const timeout) {
+                    return vkAcquireNextImageKHR(
+                            app.device.get(), swap_chain.get(), timeout,
+                            img_avail_semaphore[fif_image_index].get(),
+                            VK_NULL_HANDLE, &scfb_image_index);
+                };
+                while (true) {
+                    auto result = acquire(0);
+                    if (result == VK_TIMEOUT or result == VK_NOT_READY) {
+                        /**
+                         * Whilst we wait for the frame to become available
+                         * the acquire blocks on the helper thread instead.
+                         * That allows coroutines for handling IO and game
+                         * logic to run whilst we wait. The timeout is bounded
+                         * so that a window that stops presenting can't hold
+                         * the helper thread forever.
+                         */
+                        constexpr std::uint64_t timeout =
+                                std::chrono::nanoseconds{100ms}.count();
+                        c_acquire_wait.tick();
+                        c_acquire_wait_us += as_us(co_await gpu_completion.run(
+                                [&]() { result = acquire(timeout); }));
+                    }
+                    if (result == VK_TIMEOUT or result == VK_NOT_READY) {
+                        continue;
+                    } else if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+                        /**
+                         * A successful rebuild lets the next acquire proceed
+                         * at once. When the rebuild is skipped -- a minimised
+                         * window has no drawable to build against --
+                         * re-acquiring would immediately report out of date
+                         * again, so sleep to avoid spinning until the window
+                         * has a usable size once more.
+                         */
+                        if (not recreate_swap_chain(result)) {
+                            co_await app.sdl.io.sleep(wait_time);
+                        }
+                    } else if (result == VK_SUBOPTIMAL_KHR) {
+                        swap_chain_suboptimal = true;
+                        break;
+                    } else if (result == VK_SUCCESS) {
+                        break;
+                    } else {
+                        planet::vk::worked(result);
+                    }
+                }
+            }
+
+            acquiring.end();
+            begin_frame(start_colour);
+        } catch (...) { start_failure = std::current_exception(); }
+    }
+}
+void planet::vk::engine::renderer::begin_frame(VkClearValue const colour) {
+    trace::scope const tracing{"renderer::start", "renderer"};
 
     /**
      * We need to wait for the image before we can run the commands to draw to
@@ -357,11 +488,19 @@ felspar::coro::task<std::size_t>
     fence[fif_image_index].reset();
 
     /// Resume any processing waiting for the frames to cycle around
-    for (auto h : render_cycle_coroutines.front()) { h.resume(); }
-    render_cycle_coroutines.front().clear();
-    std::rotate(
-            render_cycle_coroutines.begin(),
-            render_cycle_coroutines.begin() + 1, render_cycle_coroutines.end());
+    /// The handles are swapped out first so that a resumed coroutine erasing
+    /// itself doesn't change the vector being walked. A waiter destroyed by an
+    /// earlier one nulls its handle here instead.
+    render_cycle_resuming.swap(render_cycle_coroutines[render_cycle_front]);
+    for (auto h : render_cycle_resuming) {
+        if (h) { h.resume(); }
+    }
+    render_cycle_resuming.clear();
+    render_cycle_front =
+            (render_cycle_front + 1) % render_cycle_coroutines.size();
+    frame_uploads.reset(fif_image_index);
+    quad_indices.next_frame();
+    if (bindless) { bindless->next_frame(); }
     prestart_barrier.signal(fif_image_index);
 
     /// Start to record command buffers
@@ -371,6 +510,7 @@ felspar::coro::task<std::size_t>
     VkCommandBufferBeginInfo begin_info = {};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     planet::vk::worked(vkBeginCommandBuffer(cb.get(), &begin_info));
+    gpu_profiler.start(fif_image_index, cb);
 
     VkRenderPassBeginInfo render_pass_info = {};
     render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -387,15 +527,28 @@ felspar::coro::task<std::size_t>
     render_pass_info.clearValueCount = clear_values.size();
     render_pass_info.pClearValues = clear_values.data();
 
+    if (secondaries) {
+        secondaries->start(
+                fif_image_index,
+                {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                 .pNext = nullptr,
+                 .renderPass = scene_render_pass.get(),
+                 .subpass = 0,
+                 .framebuffer = scene_frame_buffers.at(fif_image_index).get(),
+                 .occlusionQueryEnable = VK_FALSE,
+                 .queryFlags = {},
+                 .pipelineStatistics = {}});
+    }
+    scene_timing = gpu_profiler.scope(cb, "scene");
     vkCmdBeginRenderPass(
-            cb.get(), &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+            cb.get(), &render_pass_info,
+            secondaries ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                        : VK_SUBPASS_CONTENTS_INLINE);
 
     coordinates.copy_to_gpu_memory(fif_image_index);
 
     app.baseplate.start_frame_reset();
     frame_time.checkpoint();
-
-    co_return fif_image_index;
 }
 
 
@@ -404,7 +557,13 @@ auto planet::vk::engine::renderer::bind(
         planet::vk::graphics_pipeline &pl,
         std::span<ubo::coherent_details const *const> const ubos)
         -> planet::vk::engine::render_parameters {
-    auto &cb = command_buffers[fif_image_index];
+    return bind(command_buffers[fif_image_index], pl, ubos);
+}
+auto planet::vk::engine::renderer::bind(
+        command_buffer &cb,
+        planet::vk::graphics_pipeline &pl,
+        std::span<ubo::coherent_details const *const> const ubos)
+        -> planet::vk::engine::render_parameters {
     vkCmdBindPipeline(cb.get(), VK_PIPELINE_BIND_POINT_GRAPHICS, pl.get());
     for (std::uint32_t set{}; auto const &ds : ubos) {
         vkCmdBindDescriptorSets(
@@ -423,9 +582,12 @@ namespace {
             "planet_vk_engine_renderer_frame_rate", 500ms};
 }
 void planet::vk::engine::renderer::submit_and_present() {
+    trace::scope const tracing{"renderer::submit_and_present", "renderer"};
     auto &cb = command_buffers[fif_image_index];
 
+    if (secondaries) { secondaries->execute(cb); }
     vkCmdEndRenderPass(cb.get());
+    scene_timing.end();
 
     /**
      * The scene pass is complete. Now we have to set up the presentation pass,
@@ -436,6 +598,8 @@ void planet::vk::engine::renderer::submit_and_present() {
 
     planet::vk::worked(vkEndCommandBuffer(cb.get()));
 
+    /// Off-screen images are neither acquired nor presented
+    bool const present = not swap_chain.offscreen();
     std::array<VkSemaphore, 1> const wait_semaphores = {
             img_avail_semaphore[fif_image_index].get()};
     std::array<VkSemaphore, 1> const signal_semaphores = {
@@ -445,39 +609,51 @@ void planet::vk::engine::renderer::submit_and_present() {
     std::array command_buffer{cb.get()};
     VkSubmitInfo submit_info = {};
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.waitSemaphoreCount = wait_semaphores.size();
-    submit_info.pWaitSemaphores = wait_semaphores.data();
-    submit_info.pWaitDstStageMask = wait_stages.data();
+    if (present) {
+        submit_info.waitSemaphoreCount = wait_semaphores.size();
+        submit_info.pWaitSemaphores = wait_semaphores.data();
+        submit_info.pWaitDstStageMask = wait_stages.data();
+        submit_info.signalSemaphoreCount = signal_semaphores.size();
+        submit_info.pSignalSemaphores = signal_semaphores.data();
+    }
     submit_info.commandBufferCount = command_buffer.size();
     submit_info.pCommandBuffers = command_buffer.data();
-    submit_info.signalSemaphoreCount = signal_semaphores.size();
-    submit_info.pSignalSemaphores = signal_semaphores.data();
+    trace::scope submitting{"renderer::submit", "renderer"};
     planet::vk::worked(vkQueueSubmit(
             app.device.graphics_queue, 1, &submit_info,
             fence[fif_image_index].get()));
+    submitting.end();
 
-    /// Finally, present the updated image in the swap chain
-    std::array<VkSwapchainKHR, 1> present_chain = {swap_chain.get()};
-    VkPresentInfoKHR present_info = {};
-    present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    present_info.waitSemaphoreCount = signal_semaphores.size();
-    present_info.pWaitSemaphores = signal_semaphores.data();
-    present_info.swapchainCount = present_chain.size();
-    present_info.pSwapchains = present_chain.data();
-    present_info.pImageIndices = &scfb_image_index;
-    auto const presented =
-            vkQueuePresentKHR(app.device.present_queue, &present_info);
-    if (presented == VK_ERROR_OUT_OF_DATE_KHR or presented == VK_SUBOPTIMAL_KHR
-        or swap_chain_suboptimal) {
-        /**
-         * Keep the request pending until a swap chain sized for the current
-         * surface actually exists. A minimised window has its rebuild skipped,
-         * so leaving the flag set has the next present try again rather than
-         * dropping the request on the floor.
-         */
-        swap_chain_suboptimal = not recreate_swap_chain(presented);
+    if (not present) {
+        if (swap_chain_suboptimal) {
+            swap_chain_suboptimal = not recreate_swap_chain(VK_SUCCESS);
+        }
     } else {
-        worked(presented);
+        /// Finally, present the updated image in the swap chain
+        std::array<VkSwapchainKHR, 1> present_chain = {swap_chain.get()};
+        VkPresentInfoKHR present_info = {};
+        present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        present_info.waitSemaphoreCount = signal_semaphores.size();
+        present_info.pWaitSemaphores = signal_semaphores.data();
+        present_info.swapchainCount = present_chain.size();
+        present_info.pSwapchains = present_chain.data();
+        present_info.pImageIndices = &scfb_image_index;
+        trace::scope presenting{"renderer::present", "renderer"};
+        auto const presented =
+                vkQueuePresentKHR(app.device.present_queue, &present_info);
+        presenting.end();
+        if (presented == VK_ERROR_OUT_OF_DATE_KHR
+            or presented == VK_SUBOPTIMAL_KHR or swap_chain_suboptimal) {
+            /**
+             * Keep the request pending until a swap chain sized for the
+             * current surface actually exists. A minimised window has its
+             * rebuild skipped, so leaving the flag set has the next present
+             * try again rather than dropping the request on the floor.
+             */
+            swap_chain_suboptimal = not recreate_swap_chain(presented);
+        } else {
+            worked(presented);
+        }
     }
 
     fif_image_index = (fif_image_index + 1) % max_frames_in_flight;
@@ -494,6 +670,9 @@ planet::vk::engine::renderer::render_cycle_awaitable::~render_cycle_awaitable()
         for (auto &frame : renderer.render_cycle_coroutines) {
             std::erase(frame, mine);
         }
+        std::ranges::replace(
+                renderer.render_cycle_resuming, mine,
+                std::coroutine_handle<>{});
     }
 }
 
@@ -501,7 +680,7 @@ planet::vk::engine::renderer::render_cycle_awaitable::~render_cycle_awaitable()
 void planet::vk::engine::renderer::render_cycle_awaitable::await_suspend(
         std::coroutine_handle<> h) {
     mine = h;
-    renderer.render_cycle_coroutines.back().push_back(h);
+    renderer.render_cycle_back().push_back(h);
 }
 
 
@@ -512,22 +691,41 @@ planet::vk::graphics_pipeline planet::vk::engine::create_graphics_pipeline(
         graphics_pipeline_parameters parameters,
         std::source_location const &loc) {
     auto &app = parameters.app;
+    auto vertex_shader = shader_module_for(app, parameters.vertex_shader);
+    auto fragment_shader = shader_module_for(app, parameters.fragment_shader);
+    return create_graphics_pipeline(
+            std::move(parameters), std::move(vertex_shader),
+            std::move(fragment_shader), loc);
+}
+
+
+auto planet::vk::engine::shader_module_for(
+        app &a, shader_parameters const &shader)
+        -> shader_modules::module_ptr {
+    if (auto found = a.device.shader_modules.find(shader.spirv_filename)) {
+        return found;
+    } else {
+        return a.device.shader_modules.add(
+                shader.spirv_filename,
+                a.asset_manager.file_data(shader.spirv_filename));
+    }
+}
+
+
+planet::vk::graphics_pipeline planet::vk::engine::create_graphics_pipeline(
+        graphics_pipeline_parameters parameters,
+        shader_modules::module_ptr const vertex_shader,
+        shader_modules::module_ptr const fragment_shader,
+        std::source_location const &loc) {
+    auto &app = parameters.app;
 
     /// Shaders
-    planet::vk::shader_module vertex_shader_module{
-            app.device,
-            app.asset_manager.file_data(
-                    parameters.vertex_shader.spirv_filename)};
-    planet::vk::shader_module fragment_shader_module{
-            app.device,
-            app.asset_manager.file_data(
-                    parameters.fragment_shader.spirv_filename)};
     std::array shader_stages{
-            vertex_shader_module.shader_stage_info(
+            vertex_shader->shader_stage_info(
                     VK_SHADER_STAGE_VERTEX_BIT,
                     parameters.vertex_shader.entry_point,
                     parameters.vertex_shader.specialisation),
-            fragment_shader_module.shader_stage_info(
+            fragment_shader->shader_stage_info(
                     VK_SHADER_STAGE_FRAGMENT_BIT,
                     parameters.fragment_shader.entry_point,
                     parameters.fragment_shader.specialisation)};
@@ -0,0 +1,224 @@
+#include <planet/log.hpp>
+#include <planet/vk/engine.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <felspar/test.hpp>
+
+#include <SDL3/SDL_hints.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("engine::renderer", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Heap allocation counting
+    /**
+     * Only allocations made by the thread running the frame, and only while
+     * the counting window is open, are counted. Driver and helper threads are
+     * free to do what they want.
+     */
+    thread_local bool counting = false;
+    thread_local std::size_t allocations = 0;
+
+
+    constexpr std::size_t warm_up_frames = 10;
+    constexpr std::size_t counted_frames = 30;
+
+
+    /// ## Render a small scene with the frame loop pipelines
+    /**
+     * The window opens before `start` is awaited and closes after
+     * `submit_and_present`, so the whole frame is covered. The warm-up frames
+     * let the pools, batches and driver caches reach their steady state sizes.
+     */
+    felspar::coro::task<int> steady_state(
+            planet::vk::engine::app &app,
+            planet::vk::engine::renderer &renderer) {
+        planet::vk::command_pool pool{app.device, app.instance.surface};
+        planet::vk::device_memory_allocator memory{
+                "planet_vk_engine_renderer_tests", app.device};
+        std::uint32_t const size = 8;
+        std::vector<std::vector<std::byte>> pixels(
+                4, std::vector<std::byte>(4 * size * size, std::byte{0x80}));
+        planet::vk::texture_batch batch{memory, pool};
+        for (auto const &p : pixels) {
+            batch.add({.pixels = p, .width = size, .height = size});
+        }
+        auto const textures = batch.create();
+
+        planet::vk::engine::pipeline::textured_quad quads{
+                {.renderer = renderer,
+                 .vertex_shader{"planet-vk-engine/texture.screen.vert.spirv"}}};
+        planet::vk::engine::pipeline::mesh mesh{
+                {.renderer = renderer,
+                 .vertex_shader{"planet-vk-engine/mesh.world.vert.spirv"}}};
+        planet::vk::engine::pipeline::lines lines{{.renderer = renderer}};
+        std::vector<planet::vertex::coloured> const vertices{
+                {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+                {{0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+                {{0.0f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}}};
+        std::vector<std::uint32_t> const triangle{0, 1, 2}, segment{0, 1};
+
+        for (std::size_t frame{}; frame < warm_up_frames + counted_frames;
+             ++frame) {
+            counting = frame >= warm_up_frames;
+            co_await renderer.start(planet::colour::black);
+            for (std::size_t index{}; index < 64; ++index) {
+                auto const x = static_cast<float>(8 * (index % 8));
+                auto const y = static_cast<float>(8 * (index / 8));
+                planet::affine::rectangle2d const at{
+                        {x, y}, planet::affine::extents2d{8.0f, 8.0f}};
+                quads.draw(textures[index % textures.size()], at);
+            }
+            mesh.this_frame.draw(vertices, triangle);
+            lines.this_frame.draw(vertices, segment);
+            renderer.full_screen(
+                    [&]() { renderer.render(quads, mesh, lines); });
+            renderer.submit_and_present();
+            counting = false;
+        }
+        app.device.wait_idle();
+        co_return static_cast<int>(allocations);
+    }
+
+
+    /// ## Run a coroutine with an off-screen renderer
+    /**
+     * Returns what the coroutine returns, or zero without running it where
+     * `VK_EXT_headless_surface` is unavailable.
+     */
+    int offscreen(felspar::coro::task<int> (*co_main)(
+            planet::vk::engine::app &, planet::vk::engine::renderer &)) {
+        /// No window is opened, so any display the machine has isn't needed
+        SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+        auto const exe = std::filesystem::exists("/proc/self/exe")
+                ? std::filesystem::read_symlink("/proc/self/exe").string()
+                : std::string{"renderer.tests"};
+        char const *argv[] = {exe.c_str()};
+
+        planet::version const v{
+                "planet-vk-engine-tests", "planet/planet-vk-engine-tests",
+                "0.1", 1};
+        felspar::io::poll_warden warden{};
+        planet::sdl::init sdl{warden, v};
+        try {
+            planet::vk::engine::app app{
+                    1, argv, sdl, v,
+                    planet::vk::engine::app::offscreen{{256.0f, 256.0f}}};
+            return app.run(co_main);
+        } catch (planet::vk::headless_not_available const &) { return 0; }
+    }
+
+
+    /// ## No heap allocations once the frame loop is warmed up
+    /// Between `start` returning and `submit_and_present`, see `steady_state`
+    auto const zero = suite.test("no-allocations", [](auto check) {
+        check(offscreen(steady_state)) == 0;
+    });
+
+
+    /// ## Other GPU waits alongside the frame loop
+    /**
+     * `start` waits on the frame fences through the renderer's
+     * `gpu_completion`. Other coroutines waiting through it at the same time
+     * must neither disturb those waits nor be disturbed by them. Each test
+     * renders frames until its wait has finished, and fails if that takes
+     * more than `max_frames`.
+     */
+    constexpr std::size_t max_frames = 200;
+
+    felspar::coro::eager<>::task_type await_submission(
+            planet::vk::engine::renderer &renderer,
+            planet::vk::command_pool &pool,
+            planet::vk::buffer<std::uint32_t> &workload,
+            bool &finished) {
+        auto cb = planet::vk::command_buffer::single_use(pool);
+        vkCmdFillBuffer(
+                cb.get(), workload.get(), 0, VK_WHOLE_SIZE, 0x5a5a5a5a);
+        auto submitted = std::move(cb).end_and_submit_async();
+        co_await renderer.gpu_completion.wait(submitted);
+        finished = true;
+    }
+    felspar::coro::task<int> alongside_submission(
+            planet::vk::engine::app &app,
+            planet::vk::engine::renderer &renderer) {
+        planet::vk::command_pool pool{app.device, app.instance.surface};
+        planet::vk::buffer<std::uint32_t> workload{
+                app.device.startup_memory, 16u << 20,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+        bool finished = false;
+        felspar::coro::eager<> waiting{
+                await_submission(renderer, pool, workload, finished)};
+        for (std::size_t frame{}; not finished and frame < max_frames;
+             ++frame) {
+            co_await renderer.start(planet::colour::black);
+            renderer.full_screen([] {});
+            renderer.submit_and_present();
+        }
+        app.device.wait_idle();
+        co_return finished ? 0 : 1;
+    }
+    auto const submission = suite.test("await-submission", [](auto check) {
+        check(offscreen(alongside_submission)) == 0;
+    });
+
+
+    felspar::coro::eager<>::task_type await_ticket(
+            planet::vk::engine::renderer &renderer,
+            planet::vk::upload_engine::ticket const uploaded,
+            bool &finished) {
+        co_await renderer.gpu_completion.wait(uploaded);
+        finished = uploaded.is_complete();
+    }
+    felspar::coro::task<int> alongside_ticket(
+            planet::vk::engine::app &app,
+            planet::vk::engine::renderer &renderer) {
+        planet::vk::upload_engine uploads{app.device, app.instance.surface};
+        std::vector<std::uint32_t> const values(4u << 20, 42u);
+        planet::vk::buffer<std::uint32_t> destination{
+                app.device.startup_memory, values.size(),
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+        uploads.copy(
+                std::span<std::uint32_t const>{values}, destination,
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+        bool finished = false;
+        felspar::coro::eager<> waiting{
+                await_ticket(renderer, uploads.submit(), finished)};
+        for (std::size_t frame{}; not finished and frame < max_frames;
+             ++frame) {
+            co_await renderer.start(planet::colour::black);
+            renderer.full_screen([] {});
+            renderer.submit_and_present();
+        }
+        app.device.wait_idle();
+        co_return finished ? 0 : 1;
+    }
+    auto const ticket = suite.test("await-ticket", [](auto check) {
+        check(offscreen(alongside_ticket)) == 0;
+    });
+
+}
+
+
+/// ## Count heap allocations
+void *operator new(std::size_t const bytes) {
+    if (counting) { ++allocations; }
+    if (auto *const p = std::malloc(bytes ? bytes : 1)) {
+        return p;
+    } else {
+        throw std::bad_alloc{};
+    }
+}
+void operator delete(void *const p) noexcept { std::free(p); }
+void operator delete(void *const p, std::size_t) noexcept { std::free(p); }
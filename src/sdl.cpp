@@ -151,8 +151,16 @@ planet::vk::sdl::window::window(planet::sdl::init &sdl, const char *const name)
 }
 
 
+planet::vk::sdl::window::window(
+        planet::sdl::init &, affine::extents2d const fixed_size)
+: pw{nullptr}, desktop_size{fixed_size}, window_size{fixed_size} {
+    planet::log::info("Off-screen window", window_size);
+}
+
+
 void planet::vk::sdl::window::store_geometry(
         planet::sdl::configuration &config) const noexcept {
+    if (offscreen()) { return; }
     /**
      * Only a windowed window has a position and size worth remembering; the
      * full-screen modes cover the display, so leave the saved windowed geometry
@@ -173,6 +181,7 @@ void planet::vk::sdl::window::store_geometry(
 
 auto planet::vk::sdl::window::refresh_window_dimensions()
         -> affine::extents2d const & {
+    if (offscreen()) { return window_size; }
     int ww{}, wh{};
     SDL_GetWindowSizeInPixels(pw.get(), &ww, &wh);
     window_size = {float(ww), float(wh)};
@@ -199,6 +208,51 @@ auto planet::vk::sdl::window::refresh_window_dimensions()
 /// ## Font and texture writing
 
 
+
+namespace {
+    std::size_t add_surface(
+            planet::vk::texture_batch &batch,
+            planet::sdl::surface const &surface,
+            bool const mip_levels,
+            planet::vk::sdl::create_parameters const cp_args) {
+        if (surface.get()->format != SDL_PIXELFORMAT_ARGB8888) {
+            throw felspar::stdexcept::logic_error{
+                    "Unexpected pixel format: "
+                    + std::string{
+                            SDL_GetPixelFormatName(surface.get()->format)}};
+        }
+        std::size_t const pitch = surface.get()->pitch;
+        return batch.add(
+                {.pixels =
+                         {reinterpret_cast<std::byte const *>(
+                                  surface.get()->pixels),
+                          pitch * surface.height()},
+                 .width = static_cast<std::uint32_t>(surface.width()),
+                 .height = static_cast<std::uint32_t>(surface.height()),
+                 .pitch = pitch,
+                 .mip_levels = mip_levels,
+                 .scale = surface.fit,
+                 .address_mode = cp_args.address_mode,
+                 .filter = cp_args.filter,
+                 .border_color = cp_args.border_color});
+    }
+}
+
+
+std::size_t planet::vk::sdl::add_texture_with_mip_levels(
+        texture_batch &batch,
+        planet::sdl::surface const &surface,
+        create_parameters const cp_args) {
+    return add_surface(batch, surface, true, cp_args);
+}
+std::size_t planet::vk::sdl::add_texture_without_mip_levels(
+        texture_batch &batch,
+        planet::sdl::surface const &surface,
+        create_parameters const cp_args) {
+    return add_surface(batch, surface, false, cp_args);
+}
+
+
 planet::vk::texture planet::vk::sdl::create_texture_without_mip_levels(
         device_memory_allocator &image_allocator,
         command_pool &cp,
@@ -214,41 +268,9 @@ planet::vk::texture planet::vk::sdl::create_texture_without_mip_levels(
         command_pool &cp,
         planet::sdl::surface const &surface,
         create_parameters const cp_args) {
-    if (surface.get()->format != SDL_PIXELFORMAT_ARGB8888) {
-        throw felspar::stdexcept::logic_error{
-                "Unexpected pixel format: "
-                + std::string{SDL_GetPixelFormatName(surface.get()->format)}};
-    }
-
-    std::size_t const byte_count = surface.height() * surface.width() * 4;
-
-    buffer<std::byte> staging{
-            staging_allocator.device().staging_memory, byte_count,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-
-    auto mapped{staging.map()};
-    std::byte *const dest_base = mapped.get();
-    std::byte const *const src_base =
-            reinterpret_cast<std::byte const *>(surface.get()->pixels);
-    std::size_t const line_bytes = surface.width() * 4;
-    for (std::size_t line{}; line < surface.height(); ++line) {
-        std::size_t const dest_offset = line * line_bytes;
-        std::size_t const src_offset = line * surface.get()->pitch;
-        std::memcpy(dest_base + dest_offset, src_base + src_offset, line_bytes);
-    }
-
-    return planet::vk::texture::create_without_mip_levels_from(
-            {.allocator = image_allocator,
-             .command_pool = cp,
-             .buffer = staging,
-             .width = static_cast<std::uint32_t>(surface.width()),
-             .height = static_cast<std::uint32_t>(surface.height()),
-             .scale = surface.fit,
-             .address_mode = cp_args.address_mode,
-             .filter = cp_args.filter,
-             .border_color = cp_args.border_color});
+    texture_batch batch{staging_allocator, image_allocator, cp};
+    add_texture_without_mip_levels(batch, surface, cp_args);
+    return std::move(batch.create().front());
 }
 
 
@@ -267,39 +289,7 @@ planet::vk::texture planet::vk::sdl::create_texture_with_mip_levels(
         command_pool &cp,
         planet::sdl::surface const &surface,
         create_parameters const cp_args) {
-    if (surface.get()->format != SDL_PIXELFORMAT_ARGB8888) {
-        throw felspar::stdexcept::logic_error{
-                "Unexpected pixel format: "
-                + std::string{SDL_GetPixelFormatName(surface.get()->format)}};
-    }
-
-    std::size_t const byte_count = surface.height() * surface.width() * 4;
-
-    buffer<std::byte> staging{
-            staging_allocator.device().staging_memory, byte_count,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-
-    auto mapped{staging.map()};
-    std::byte *const dest_base = mapped.get();
-    std::byte const *const src_base =
-            reinterpret_cast<std::byte const *>(surface.get()->pixels);
-    std::size_t const line_bytes = surface.width() * 4;
-    for (std::size_t line{}; line < surface.height(); ++line) {
-        std::size_t const dest_offset = line * line_bytes;
-        std::size_t const src_offset = line * surface.get()->pitch;
-        std::memcpy(dest_base + dest_offset, src_base + src_offset, line_bytes);
-    }
-
-    return planet::vk::texture::create_with_mip_levels_from(
-            {.allocator = image_allocator,
-             .command_pool = cp,
-             .buffer = staging,
-             .width = static_cast<std::uint32_t>(surface.width()),
-             .height = static_cast<std::uint32_t>(surface.height()),
-             .scale = surface.fit,
-             .address_mode = cp_args.address_mode,
-             .filter = cp_args.filter,
-             .border_color = cp_args.border_color});
+    texture_batch batch{staging_allocator, image_allocator, cp};
+    add_texture_with_mip_levels(batch, surface, cp_args);
+    return std::move(batch.create().front());
 }
@@ -0,0 +1,143 @@
+#include <planet/vk/device.hpp>
+#include <planet/vk/engine/secondary_recorder.hpp>
+
+#include <algorithm>
+
+
+/// ## `planet::vk::engine::secondary_recorder`
+
+
+planet::vk::engine::secondary_recorder::secondary_recorder(
+        vk::device &d, vk::surface const &s, std::size_t const threads)
+: pools{d, s, max_frames_in_flight} {
+    auto const count = std::max<std::size_t>(threads, 1);
+    workers.reserve(count - 1);
+    for (std::size_t index{1}; index < count; ++index) {
+        workers.emplace_back([this]() { work(); });
+    }
+}
+
+
+planet::vk::engine::secondary_recorder::~secondary_recorder() {
+    {
+        std::scoped_lock _{mutex};
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) { worker.join(); }
+}
+
+
+void planet::vk::engine::secondary_recorder::start(
+        std::size_t const fi, VkCommandBufferInheritanceInfo const ii) {
+    frame_index = fi;
+    inheritance = ii;
+    pools.retire(frame_index);
+    order.clear();
+}
+
+
+void planet::vk::engine::secondary_recorder::record(
+        std::span<job const> const js) {
+    if (js.empty()) { return; }
+    auto const base = order.size();
+    order.resize(base + js.size(), VK_NULL_HANDLE);
+    c_recorded += js.size();
+
+    if (workers.empty()) {
+        for (std::size_t index{}; index < js.size(); ++index) {
+            record_one(js[index], base + index);
+        }
+        count_allocations();
+        return;
+    }
+
+    std::size_t current{};
+    {
+        std::scoped_lock _{mutex};
+        jobs = js;
+        first = base;
+        next = 0;
+        remaining = js.size();
+        failure = {};
+        current = ++generation;
+    }
+    wake.notify_all();
+    take_jobs(current);
+
+    std::unique_lock lock{mutex};
+    done.wait(lock, [this]() { return remaining == 0; });
+    jobs = {};
+    count_allocations();
+    if (failure) { std::rethrow_exception(std::exchange(failure, {})); }
+}
+
+
+void planet::vk::engine::secondary_recorder::execute(command_buffer &primary) {
+    if (not order.empty()) {
+        vkCmdExecuteCommands(primary.get(), order.size(), order.data());
+    }
+}
+
+
+void planet::vk::engine::secondary_recorder::count_allocations() {
+    /// Only the calling thread touches the telemetry
+    std::size_t const total = pools.c_allocated.value();
+    c_allocated += total - std::exchange(allocated, total);
+}
+
+
+void planet::vk::engine::secondary_recorder::work() {
+    std::size_t seen{};
+    while (true) {
+        {
+            std::unique_lock lock{mutex};
+            wake.wait(lock, [&]() { return stopping or generation != seen; });
+            if (stopping) { return; }
+            seen = generation;
+        }
+        take_jobs(seen);
+    }
+}
+
+
+void planet::vk::engine::secondary_recorder::take_jobs(
+        std::size_t const batch) {
+    while (true) {
+        job const *taken = nullptr;
+        std::size_t slot{};
+        {
+            std::scoped_lock _{mutex};
+            /**
+             * A batch can't finish while one of its jobs is still being
+             * recorded, so checking the generation here is enough to stop a
+             * late waking worker from taking jobs from the wrong batch.
+             */
+            if (generation != batch or next >= jobs.size()) { return; }
+            taken = &jobs[next];
+            slot = first + next++;
+        }
+        std::exception_ptr error;
+        try {
+            record_one(*taken, slot);
+        } catch (...) { error = std::current_exception(); }
+        {
+            std::scoped_lock _{mutex};
+            if (error and not failure) { failure = error; }
+            if (--remaining == 0) { done.notify_one(); }
+        }
+    }
+}
+
+
+void planet::vk::engine::secondary_recorder::record_one(
+        job const &j, std::size_t const slot) {
+    auto &cb = pools.allocate(frame_index, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    cb.begin(
+            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+                    | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+            inheritance);
+    j(cb);
+    cb.end();
+    order[slot] = cb.get();
+}
@@ -0,0 +1,218 @@
+#include <planet/log.hpp>
+#include <planet/vk/engine/secondary_recorder.hpp>
+#include <planet/vk/frame_buffer.hpp>
+#include <planet/vk/headless.hpp>
+#include <planet/vk/render_pass.hpp>
+
+#include <felspar/test.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("engine::secondary_recorder", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## A render pass and frame buffer to record into
+    struct target {
+        static constexpr std::uint32_t size = 64;
+
+        planet::vk::image image;
+        planet::vk::image_view view;
+        planet::vk::render_pass render_pass;
+        planet::vk::frame_buffer frame_buffer;
+
+        target(planet::vk::device &device)
+        : image{device.startup_memory,
+                size,
+                size,
+                1,
+                VK_SAMPLE_COUNT_1_BIT,
+                VK_FORMAT_R8G8B8A8_UNORM,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT},
+          view{image, VK_IMAGE_ASPECT_COLOR_BIT},
+          render_pass{[&]() {
+              VkAttachmentDescription attachment{
+                      .flags = {},
+                      .format = VK_FORMAT_R8G8B8A8_UNORM,
+                      .samples = VK_SAMPLE_COUNT_1_BIT,
+                      .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                      .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                      .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                      .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                      .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+              VkAttachmentReference reference{
+                      .attachment = 0,
+                      .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+              VkSubpassDescription subpass{};
+              subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+              subpass.colorAttachmentCount = 1;
+              subpass.pColorAttachments = &reference;
+              VkRenderPassCreateInfo info{};
+              info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+              info.attachmentCount = 1;
+              info.pAttachments = &attachment;
+              info.subpassCount = 1;
+              info.pSubpasses = &subpass;
+              return planet::vk::render_pass{device, info};
+          }()},
+          frame_buffer{[&]() {
+              std::array attachments{view.get()};
+              VkFramebufferCreateInfo info{};
+              info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+              info.renderPass = render_pass.get();
+              info.attachmentCount = attachments.size();
+              info.pAttachments = attachments.data();
+              info.width = size;
+              info.height = size;
+              info.layers = 1;
+              return planet::vk::frame_buffer{device, info};
+          }()} {}
+
+        VkCommandBufferInheritanceInfo inheritance() const {
+            return {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                    .pNext = nullptr,
+                    .renderPass = render_pass.get(),
+                    .subpass = 0,
+                    .framebuffer = frame_buffer.get(),
+                    .occlusionQueryEnable = VK_FALSE,
+                    .queryFlags = {},
+                    .pipelineStatistics = {}};
+        }
+
+        /// ### Execute what was recorded and wait for the GPU
+        void submit(
+                planet::vk::command_pool &pool,
+                planet::vk::engine::secondary_recorder &recorder) {
+            auto cb = planet::vk::command_buffer::single_use(pool);
+            VkClearValue clear{};
+            VkRenderPassBeginInfo info{};
+            info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            info.renderPass = render_pass.get();
+            info.framebuffer = frame_buffer.get();
+            info.renderArea.extent = {size, size};
+            info.clearValueCount = 1;
+            info.pClearValues = &clear;
+            vkCmdBeginRenderPass(
+                    cb.get(), &info,
+                    VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            recorder.execute(cb);
+            vkCmdEndRenderPass(cb.get());
+            std::move(cb).end_and_submit_async().wait();
+        }
+    };
+
+
+    /// ### Stand in for a pipeline's commands
+    /**
+     * Dynamic state can be recorded without a pipeline bound, which lets the
+     * test record a realistic number of commands without needing shaders.
+     */
+    planet::vk::engine::secondary_recorder::job
+            pipeline_job(std::size_t const commands) {
+        return [commands](planet::vk::command_buffer &cb) {
+            for (std::size_t index{}; index < commands; ++index) {
+                VkViewport viewport{
+                        0.0f, 0.0f, float(target::size), float(target::size),
+                        0.0f, 1.0f};
+                vkCmdSetViewport(cb.get(), 0, 1, &viewport);
+                VkRect2D scissor{{0, 0}, {target::size, target::size}};
+                vkCmdSetScissor(cb.get(), 0, 1, &scissor);
+            }
+        };
+    }
+
+
+    /// ## Every job gets a buffer, and buffers are re-used
+    auto const records = suite.test("record", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        target t{vk->device};
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+        planet::vk::engine::secondary_recorder recorder{
+                vk->device, vk->instance.surface, 3};
+        check(recorder.thread_count()) == 3u;
+
+        std::vector jobs(16, pipeline_job(4));
+        for (std::size_t frame{}; frame < 6; ++frame) {
+            recorder.start(
+                    frame % planet::vk::engine::max_frames_in_flight,
+                    t.inheritance());
+            recorder.record(jobs);
+            recorder.record(std::span{jobs}.first(4));
+            check(recorder.recorded()) == 20u;
+            t.submit(pool, recorder);
+        }
+        /// Each frame index holds at most one buffer per job
+        auto const allocated = recorder.c_allocated.value();
+        check(allocated) <= decltype(allocated)(
+                20 * planet::vk::engine::max_frames_in_flight);
+    });
+
+
+    /// ## Exceptions from jobs reach the caller
+    auto const throws = suite.test("throws", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        target t{vk->device};
+        planet::vk::engine::secondary_recorder recorder{
+                vk->device, vk->instance.surface, 2};
+        recorder.start(0, t.inheritance());
+
+        std::vector jobs(8, pipeline_job(1));
+        jobs[5] = [](planet::vk::command_buffer &) {
+            throw std::runtime_error{"Job failed"};
+        };
+        check([&]() {
+            recorder.record(jobs);
+        }).throws(std::runtime_error{"Job failed"});
+    });
+
+
+    /// ## A single thread records on the caller
+    /**
+     * With more threads every job is still recorded exactly once.
+     */
+    auto const threads = suite.test("threads", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        target t{vk->device};
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+        auto const caller = std::this_thread::get_id();
+        for (std::size_t const count : {1u, 4u}) {
+            planet::vk::engine::secondary_recorder recorder{
+                    vk->device, vk->instance.surface, count};
+            std::vector<std::thread::id> ran(32);
+            std::vector<planet::vk::engine::secondary_recorder::job> jobs;
+            for (std::size_t index{}; index < ran.size(); ++index) {
+                jobs.push_back([&ran, index](planet::vk::command_buffer &cb) {
+                    pipeline_job(2)(cb);
+                    ran[index] = std::this_thread::get_id();
+                });
+            }
+            recorder.start(0, t.inheritance());
+            recorder.record(jobs);
+            check(recorder.recorded()) == ran.size();
+            t.submit(pool, recorder);
+
+            for (auto const id : ran) {
+                check(id != std::thread::id{}) == true;
+                if (count == 1) { check(id == caller) == true; }
+            }
+        }
+    });
+
+}
@@ -1,6 +1,8 @@
 #include <planet/vk/device.hpp>
 #include <planet/vk/shader_module.hpp>
 
+#include <algorithm>
+
 
 /// ## `planet::vk::shader_module`
 
@@ -19,7 +21,7 @@ planet::vk::shader_module::shader_module(
 VkPipelineShaderStageCreateInfo planet::vk::shader_module::shader_stage_info(
         VkShaderStageFlagBits const flags,
         char const *entry,
-        VkSpecializationInfo const *const specialisation) {
+        VkSpecializationInfo const *const specialisation) const {
     VkPipelineShaderStageCreateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     info.stage = flags;
@@ -28,3 +30,70 @@ VkPipelineShaderStageCreateInfo planet::vk::shader_module::shader_stage_info(
     info.pSpecializationInfo = specialisation;
     return info;
 }
+
+
+/// ## `planet::vk::shader_modules`
+
+
+namespace {
+    /// FNV-1a, which is plenty for telling shaders apart
+    std::uint64_t hash(std::span<std::byte const> const bytes) {
+        std::uint64_t h = 14695981039346656037ull;
+        for (auto const b : bytes) {
+            h ^= static_cast<std::uint64_t>(b);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+}
+
+
+planet::vk::shader_modules::shader_modules(vk::device &d) : device{d} {}
+
+
+auto planet::vk::shader_modules::find(std::string_view const name)
+        -> module_ptr {
+    std::scoped_lock _{mutex};
+    if (auto const found = by_name.find(name); found != by_name.end()) {
+        ++c_hits;
+        return found->second;
+    } else {
+        return {};
+    }
+}
+
+
+auto planet::vk::shader_modules::add(
+        std::string_view const name, std::vector<std::byte> spirv)
+        -> module_ptr {
+    auto const h = hash(spirv);
+    std::scoped_lock _{mutex};
+    auto [begin, end] = by_hash.equal_range(h);
+    auto const same = std::find_if(begin, end, [&](auto const &candidate) {
+        return std::ranges::equal(candidate.second->code(), spirv);
+    });
+    module_ptr module;
+    if (same != end) {
+        ++c_shared;
+        module = same->second;
+    } else {
+        ++c_created;
+        module = std::make_shared<shader_module const>(device, std::move(spirv));
+        by_hash.emplace(h, module);
+    }
+    by_name.insert_or_assign(std::string{name}, module);
+    return module;
+}
+
+
+void planet::vk::shader_modules::clear() {
+    std::scoped_lock _{mutex};
+    by_name.clear();
+    by_hash.clear();
+}
+
+
+std::size_t planet::vk::shader_modules::size() const {
+    std::scoped_lock _{mutex};
+    return by_hash.size();
+}
@@ -0,0 +1,74 @@
+#include <planet/log.hpp>
+#include <planet/vk/device.hpp>
+#include <planet/vk/headless.hpp>
+
+#include <felspar/test.hpp>
+
+#include <array>
+#include <cstring>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::shader_modules", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ### The smallest vertex shader, an empty `main`
+    std::vector<std::byte> empty_vertex_shader(std::uint32_t const id_bound) {
+        std::array const words{
+                0x07230203u, 0x00010000u, 0u, id_bound, 0u,
+                // OpCapability Shader
+                (2u << 16) | 17u, 1u,
+                // OpMemoryModel Logical GLSL450
+                (3u << 16) | 14u, 0u, 1u,
+                // OpEntryPoint Vertex %4 "main"
+                (5u << 16) | 15u, 0u, 4u, 0x6e69616du, 0u,
+                // %1 = OpTypeVoid
+                (2u << 16) | 19u, 1u,
+                // %2 = OpTypeFunction %1
+                (3u << 16) | 33u, 2u, 1u,
+                // %4 = OpFunction %1 None %2
+                (5u << 16) | 54u, 1u, 4u, 0u, 2u,
+                // %3 = OpLabel
+                (2u << 16) | 248u, 3u,
+                // OpReturn, OpFunctionEnd
+                (1u << 16) | 253u, (1u << 16) | 56u};
+        std::vector<std::byte> bytes(sizeof(words));
+        std::memcpy(bytes.data(), words.data(), bytes.size());
+        return bytes;
+    }
+
+
+    /// ## Modules are shared by name and by content
+    auto const sharing = suite.test("sharing", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        auto &modules = vk->device.shader_modules;
+        check(modules.find("a.vert")) == nullptr;
+
+        auto const a = modules.add("a.vert", empty_vertex_shader(5));
+        check(modules.find("a.vert")) == a;
+        check(modules.c_hits.value()) == 1;
+
+        /// The same code under another name gets the same module
+        auto const b = modules.add("b.vert", empty_vertex_shader(5));
+        check(b) == a;
+        check(modules.c_shared.value()) == 1;
+
+        /// Different code gets its own module
+        auto const c = modules.add("c.vert", empty_vertex_shader(6));
+        check(c) != a;
+        check(modules.size()) == 2u;
+
+        modules.clear();
+        check(modules.find("a.vert")) == nullptr;
+        check(a->get()) != VK_NULL_HANDLE;
+    });
+
+
+}
@@ -0,0 +1,16 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) in vec2 tex_uv;
+layout(location = 1) in vec4 hint_colour;
+layout(location = 2) flat in uint texture_index;
+
+layout(location = 0) out vec4 colour;
+layout(location = 1) out vec4 glow;
+
+void main() {
+    colour = texture(textures[nonuniformEXT(texture_index)], tex_uv) * hint_colour;
+    glow = vec4(0.0, 0.0, 0.0, colour.a);
+}
@@ -0,0 +1,36 @@
+#version 450
+
+layout(location = 0) in mat4 transform;
+layout(location = 4) in vec4 tint;
+layout(location = 5) in vec4 corners;
+layout(location = 6) in vec4 tex_corners;
+layout(location = 7) in float z_height;
+layout(location = 8) in uint slot;
+
+layout(set = 0, binding = 0) uniform CoordinateSpace {
+    mat4 world;
+    mat4 pixel;
+} coordinates;
+
+layout(location = 0) out vec2 uv;
+layout(location = 1) out vec4 colour;
+layout(location = 2) flat out uint texture_index;
+
+/// Quad corner for each vertex, in the same order `sprite` indexes them
+const int corner[6] = int[](0, 2, 1, 0, 3, 2);
+
+void main() {
+    int c = corner[gl_VertexIndex];
+    bool right = c < 2;
+    bool bottom = c == 0 || c == 3;
+    vec4 position = vec4(
+            right ? corners.z : corners.x,
+            bottom ? corners.w : corners.y,
+            z_height, 1.0);
+    gl_Position = coordinates.pixel * transform * position;
+    uv = vec2(
+            right ? tex_corners.z : tex_corners.x,
+            bottom ? tex_corners.w : tex_corners.y);
+    colour = tint;
+    texture_index = slot;
+}
@@ -13,7 +13,8 @@ planet::vk::engine::pipeline::sprite::sprite(
         id::suffix const suffix)
 : id{n, suffix},
   textures{name(), r.app.device, mtpf},
-  pipeline{create_pipeline(r, vs)} {}
+  pipeline{create_pipeline(r, vs)},
+  bindless{r.bindless ? &*r.bindless : nullptr} {}
 
 
 planet::vk::graphics_pipeline
@@ -23,6 +24,29 @@ planet::vk::graphics_pipeline
     pc.offset = 0;
     pc.size = sizeof(push_constant);
     pc.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    if (r.bindless) {
+        /// The texture slot follows the transform, see `textured.bindless.frag`
+        VkPushConstantRange slot;
+        slot.offset = sizeof(push_constant);
+        slot.size = sizeof(std::uint32_t);
+        slot.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        return planet::vk::engine::create_graphics_pipeline(
+                {.app = r.app,
+                 .renderer = r,
+                 .vertex_shader = {vertex_shader},
+                 .fragment_shader =
+                         {"planet-vk-engine/textured.bindless.frag.spirv"},
+                 .binding_descriptions = vertex::binding_description<
+                         textures_type::vertex_type>(),
+                 .attribute_descriptions = vertex::attribute_description<
+                         textures_type::vertex_type>(),
+                 .pipeline_layout = pipeline_layout{
+                         r.app.device,
+                         std::array{
+                                 r.coordinates_ubo_layout().get(),
+                                 r.bindless->layout.get()},
+                         std::array{pc, slot}}});
+    }
     return planet::vk::engine::create_graphics_pipeline(
             {.app = r.app,
              .renderer = r,
@@ -41,39 +65,55 @@ planet::vk::graphics_pipeline
 }
 
 
-void planet::vk::engine::pipeline::sprite::draw(
-        std::pair<vk::texture const &, affine::rectangle2d> texture,
+auto planet::vk::engine::pipeline::sprite::make_vertices(
+        affine::rectangle2d const &uv,
         location const &loc,
-        planet::colour const &colour) {
+        planet::colour const &colour) noexcept -> std::array<vertex_type, 4> {
     auto const pos = affine::rectangle2d{
             affine::point2d{0, loc.size.height} - loc.centre,
             affine::extents2d{loc.size.width, -loc.size.height}};
-    std::size_t const quad_index = textures.vertices.size();
-
-    textures.vertices.push_back(
-            {{pos.bottom_right().x(), pos.bottom_right().y(), loc.z_height},
-             colour,
-             {texture.second.bottom_right().x(),
-              texture.second.bottom_right().y()}});
-    textures.vertices.push_back(
-            {{pos.bottom_right().x(), pos.top_left.y(), loc.z_height},
-             colour,
-             {texture.second.bottom_right().x(), texture.second.top_left.y()}});
-    textures.vertices.push_back(
-            {{pos.top_left.x(), pos.top_left.y(), loc.z_height},
-             colour,
-             {texture.second.top_left.x(), texture.second.top_left.y()}});
-    textures.vertices.push_back(
-            {{pos.top_left.x(), pos.bottom_right().y(), loc.z_height},
-             colour,
-             {texture.second.top_left.x(), texture.second.bottom_right().y()}});
-
-    textures.indices.push_back(quad_index);
-    textures.indices.push_back(quad_index + 2);
-    textures.indices.push_back(quad_index + 1);
-    textures.indices.push_back(quad_index);
-    textures.indices.push_back(quad_index + 3);
-    textures.indices.push_back(quad_index + 2);
+    auto const pos_br = pos.bottom_right();
+    auto const uv_br = uv.bottom_right();
+
+    /**
+     * The corners go round the quad in the order that gives the triangles of
+     * the shared `quad_indices` the same winding as the sprite's.
+     */
+    return {vertex_type{
+                    {pos.top_left.x(), pos.top_left.y(), loc.z_height},
+                    colour,
+                    {uv.top_left.x(), uv.top_left.y()}},
+            vertex_type{
+                    {pos_br.x(), pos.top_left.y(), loc.z_height},
+                    colour,
+                    {uv_br.x(), uv.top_left.y()}},
+            vertex_type{
+                    {pos_br.x(), pos_br.y(), loc.z_height},
+                    colour,
+                    {uv_br.x(), uv_br.y()}},
+            vertex_type{
+                    {pos.top_left.x(), pos_br.y(), loc.z_height},
+                    colour,
+                    {uv.top_left.x(), uv_br.y()}}};
+}
+
+
+auto planet::vk::engine::pipeline::sprite::make_transform(
+        location const &loc) noexcept -> push_constant {
+    return {planet::affine::matrix3d{
+            planet::affine::matrix2d::translate(
+                    {loc.offset.xh, loc.offset.yh, loc.offset.h})
+            * planet::affine::matrix2d::rotate(loc.rotation)}};
+}
+
+
+void planet::vk::engine::pipeline::sprite::draw(
+        std::pair<vk::texture const &, affine::rectangle2d> texture,
+        location const &loc,
+        planet::colour const &colour) {
+    auto const corners = make_vertices(texture.second, loc, colour);
+    textures.vertices.insert(
+            textures.vertices.end(), corners.begin(), corners.end());
 
     textures.descriptors.emplace_back();
     textures.descriptors.back().imageLayout =
@@ -81,34 +121,30 @@ void planet::vk::engine::pipeline::sprite::draw(
     textures.descriptors.back().imageView = texture.first.image_view.get();
     textures.descriptors.back().sampler = texture.first.sampler.get();
 
-    transforms.push_back({planet::affine::matrix3d{
-            planet::affine::matrix2d::translate(
-                    {loc.offset.xh, loc.offset.yh, loc.offset.h})
-            * planet::affine::matrix2d::rotate(loc.rotation)}});
+    transforms.push_back(make_transform(loc));
 }
 
 
 void planet::vk::engine::pipeline::sprite::render(render_parameters rp) {
+    if (bindless) {
+        render_bindless(rp);
+        return;
+    }
     if (not textures.bind(
-                rp.renderer.per_frame_memory, rp.current_frame, rp.cb)) {
+                rp.renderer.frame_uploads, rp.renderer.quad_indices,
+                rp.current_frame, rp.cb)) {
         return;
     }
-    for (std::size_t index{}; auto const &tx : textures.descriptors) {
-        VkWriteDescriptorSet wds{};
-        wds.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        wds.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        wds.dstSet = textures.ubo.sets[rp.current_frame][index];
-        wds.dstBinding = 0;
-        wds.dstArrayElement = 0;
-        wds.descriptorCount = 1;
-        wds.pImageInfo = &tx;
-        vkUpdateDescriptorSets(
-                rp.renderer.app.device.get(), 1, &wds, 0, nullptr);
+    for (std::uint32_t index{}; auto const &tx : textures.descriptors) {
+        textures.ubo.write(rp.current_frame, index++, tx);
+    }
+    textures.ubo.flush();
 
+    for (std::uint32_t index{}; index < textures.descriptors.size(); ++index) {
+        auto const set = textures.ubo.set(rp.current_frame, index);
         vkCmdBindDescriptorSets(
                 rp.cb.get(), VK_PIPELINE_BIND_POINT_GRAPHICS,
-                pipeline.layout.get(), 1, 1,
-                &textures.ubo.sets[rp.current_frame][index], 0, nullptr);
+                pipeline.layout.get(), 1, 1, &set, 0, nullptr);
 
         vkCmdPushConstants(
                 rp.cb.get(), pipeline.layout.get(), VK_SHADER_STAGE_VERTEX_BIT,
@@ -121,11 +157,48 @@ void planet::vk::engine::pipeline::sprite::render(render_parameters rp) {
         vkCmdDrawIndexed(
                 rp.cb.get(), index_count, instance_count, index * index_count,
                 vertex_offset, first_instance);
+    }
+
+    // Clear out data from this frame
+    textures.clear();
+    transforms.clear();
+}
+
+
+void planet::vk::engine::pipeline::sprite::render_bindless(
+        render_parameters &rp) {
+    if (not textures.bind(
+                rp.renderer.frame_uploads, rp.renderer.quad_indices,
+                rp.current_frame, rp.cb)) {
+        return;
+    }
+
+    auto const set = bindless->set();
+    vkCmdBindDescriptorSets(
+            rp.cb.get(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.layout.get(),
+            1, 1, &set, 0, nullptr);
+
+    for (std::uint32_t index{}; auto const &tx : textures.descriptors) {
+        auto const slot = bindless->slot_for(tx.imageView, tx.sampler);
+        vkCmdPushConstants(
+                rp.cb.get(), pipeline.layout.get(), VK_SHADER_STAGE_VERTEX_BIT,
+                0, sizeof(push_constant), &transforms[index]);
+        vkCmdPushConstants(
+                rp.cb.get(), pipeline.layout.get(),
+                VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(push_constant),
+                sizeof(slot), &slot);
+
+        static constexpr std::uint32_t index_count = 6;
+        static constexpr std::uint32_t instance_count = 1;
+        static constexpr std::int32_t vertex_offset = 0;
+        static constexpr std::uint32_t first_instance = 0;
+        vkCmdDrawIndexed(
+                rp.cb.get(), index_count, instance_count, index * index_count,
+                vertex_offset, first_instance);
 
         ++index;
     }
 
-    // Clear out data from this frame
     textures.clear();
     transforms.clear();
 }
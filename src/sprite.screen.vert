@@ -9,11 +9,15 @@ layout(set = 0, binding = 0) uniform CoordinateSpace {
     mat4 pixel;
 } coordinates;
 
+layout(push_constant) uniform PushConstants {
+    mat4 transform;
+} push_constant;
+
 layout(location = 0) out vec2 uv;
 layout(location = 1) out vec4 colour;
 
 void main() {
-    gl_Position = coordinates.pixel * position;
+    gl_Position = coordinates.pixel * push_constant.transform * position;
     uv = tex_uv;
     colour = tex_colour;
 }
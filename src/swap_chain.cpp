@@ -3,6 +3,8 @@
 #include <planet/vk/instance.hpp>
 #include <planet/vk/swap_chain.hpp>
 
+#include <felspar/exceptions/logic_error.hpp>
+
 #include <algorithm>
 #include <array>
 
@@ -11,6 +13,7 @@
 
 
 std::uint32_t planet::vk::swap_chain::create(VkExtent2D const wsize) {
+    if (offscreen()) { return create_offscreen(wsize); }
     frame_buffers.clear();
     image_views.clear();
     images.clear();
@@ -80,10 +83,48 @@ std::uint32_t planet::vk::swap_chain::create(VkExtent2D const wsize) {
     return images.size();
 }
 std::uint32_t planet::vk::swap_chain::create(affine::extents2d const wsize) {
+    if (offscreen()) {
+        return create_offscreen(
+                {static_cast<std::uint32_t>(wsize.uzwidth()),
+                 static_cast<std::uint32_t>(wsize.uzheight())});
+    }
     return create(swap_chain::calculate_extents(device, wsize));
 }
 
 
+std::uint32_t
+        planet::vk::swap_chain::create_offscreen(VkExtent2D const wsize) {
+    if (owned_count == 0) {
+        throw felspar::stdexcept::logic_error{
+                "An off-screen swap chain needs at least one image"};
+    }
+    frame_buffers.clear();
+    image_views.clear();
+    images.clear();
+    owned_images.clear();
+
+    image_format = device().instance.surface.best_format.format;
+    extents = wsize;
+    owned_images.reserve(owned_count);
+    for (std::uint32_t index{}; index < owned_count; ++index) {
+        auto &image = owned_images.emplace_back(
+                *allocator, extents.width, extents.height, 1,
+                VK_SAMPLE_COUNT_1_BIT, image_format, VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+                        bitor VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        images.push_back(image.get());
+        image_views.emplace_back(*this, image.get());
+    }
+
+    planet::log::info(
+            "Created off-screen swap chain with", images.size(),
+            "images and extents", wsize.width, "x", wsize.height);
+
+    return images.size();
+}
+
+
 VkExtent2D planet::vk::swap_chain::calculate_extents(
         vk::device const &device, affine::extents2d const ex) {
     auto const &capabilities = device.instance.surface.capabilities;
@@ -111,6 +152,8 @@ VkAttachmentDescription planet::vk::swap_chain::attachment_description() const {
     ca.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     ca.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     ca.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    ca.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    /// Off-screen images are read back rather than presented
+    ca.finalLayout = offscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                 : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
     return ca;
 }
@@ -0,0 +1,80 @@
+#include <planet/log.hpp>
+#include <planet/vk/headless.hpp>
+#include <planet/vk/swap_chain.hpp>
+
+#include <felspar/test.hpp>
+
+#include <stdexcept>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::swap_chain", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Off-screen images need no presentation
+    auto const offscreen = suite.test("offscreen", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::device_memory_allocator memory{
+                "planet_vk_swap_chain_tests", vk->device};
+        planet::vk::swap_chain sc{
+                vk->device, memory, VkExtent2D{64, 32}, 3};
+        check(sc.offscreen()) == true;
+        check(sc.get() == VK_NULL_HANDLE) == true;
+        check(sc.images.size()) == 3u;
+        check(sc.image_views.size()) == 3u;
+        check(sc.extents.width) == 64u;
+        check(sc.extents.height) == 32u;
+        check(sc.transfer == planet::vk::transfer_source::available) == true;
+        check(sc.attachment_description().finalLayout)
+                == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        /// A render pass that writes the images can have frame buffers
+        auto const attachment = sc.attachment_description();
+        VkAttachmentReference const reference{
+                .attachment = 0,
+                .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &reference;
+        VkRenderPassCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        info.attachmentCount = 1;
+        info.pAttachments = &attachment;
+        info.subpassCount = 1;
+        info.pSubpasses = &subpass;
+        planet::vk::render_pass const rp{vk->device, info};
+        sc.create_frame_buffers(rp);
+        check(sc.frame_buffers.size()) == 3u;
+
+        check(sc.recreate(VkExtent2D{16, 8})) == 3u;
+        check(sc.extents.width) == 16u;
+        check(sc.extents.height) == 8u;
+        check(sc.frame_buffers.empty()) == true;
+        check(sc.offscreen()) == true;
+    });
+
+
+    /// ## There must be at least one image
+    auto const empty = suite.test("no-images", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::device_memory_allocator memory{
+                "planet_vk_swap_chain_tests", vk->device};
+        check([&]() {
+            planet::vk::swap_chain sc{
+                    vk->device, memory, VkExtent2D{64, 32}, 0};
+        }).throws(std::logic_error{
+                "An off-screen swap chain needs at least one image"});
+    });
+
+
+}
@@ -3,8 +3,14 @@
 #include <planet/vk/device.hpp>
 #include <planet/vk/instance.hpp>
 #include <planet/vk/texture.hpp>
+#include <planet/vk/trace.hpp>
 
+#include <felspar/exceptions/logic_error.hpp>
+#include <felspar/memory/sizes.hpp>
+
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 
 /// ## `planet::vk::sampler`
@@ -80,9 +86,10 @@ namespace {
     void copy_from(
             planet::vk::command_buffer &cb,
             planet::vk::image &image,
-            planet::vk::buffer<std::byte> const &buffer) {
+            planet::vk::buffer<std::byte> const &buffer,
+            VkDeviceSize const offset = {}) {
         VkBufferImageCopy region{};
-        region.bufferOffset = 0;
+        region.bufferOffset = offset;
         region.bufferRowLength = 0;
         region.bufferImageHeight = 0;
         region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -172,13 +179,23 @@ namespace {
                          .destination_access_mask = VK_ACCESS_SHADER_READ_BIT,
                          .base_mip_level = mip_levels - 1})});
     }
+    std::uint32_t mip_levels_for(
+            std::uint32_t const width, std::uint32_t const height) {
+        auto const mhw = std::max(width, height);
+        return 1 + std::floor(std::log2(mhw));
+    }
 }
 
 
 planet::vk::texture planet::vk::texture::create_with_mip_levels_from(
         texture::parameters args) {
-    auto const mhw = std::max(args.width, args.height);
-    std::uint32_t const mip_levels = 1 + std::floor(std::log2(mhw));
+    auto upload = upload_with_mip_levels_from(args);
+    upload.submission.wait();
+    return std::move(upload.texture);
+}
+planet::vk::texture_upload planet::vk::texture::upload_with_mip_levels_from(
+        texture::parameters args) {
+    std::uint32_t const mip_levels = mip_levels_for(args.width, args.height);
 
     vk::texture texture;
 
@@ -201,7 +218,7 @@ planet::vk::texture planet::vk::texture::create_with_mip_levels_from(
             mip_levels);
     copy_from(cb, texture.image, args.buffer);
     generate_mip_maps(cb, texture.image, mip_levels);
-    cb.end_and_submit();
+    auto submission = std::move(cb).end_and_submit_async();
 
     texture.image_view = {texture.image, VK_IMAGE_ASPECT_COLOR_BIT};
 
@@ -212,12 +229,19 @@ planet::vk::texture planet::vk::texture::create_with_mip_levels_from(
              .filter = args.filter,
              .border_color = args.border_color}};
 
-    return texture;
+    return {std::move(texture), std::move(submission)};
 }
 
 
 planet::vk::texture planet::vk::texture::create_without_mip_levels_from(
         texture::parameters args) {
+    auto upload = upload_without_mip_levels_from(args);
+    upload.submission.wait();
+    return std::move(upload.texture);
+}
+planet::vk::texture_upload
+        planet::vk::texture::upload_without_mip_levels_from(
+                texture::parameters args) {
     vk::texture texture;
 
     texture.fit = args.scale;
@@ -244,7 +268,7 @@ planet::vk::texture planet::vk::texture::create_without_mip_levels_from(
                     {.new_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                      .source_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT,
                      .destination_access_mask = VK_ACCESS_SHADER_READ_BIT})});
-    cb.end_and_submit();
+    auto submission = std::move(cb).end_and_submit_async();
 
     texture.image_view = {texture.image, VK_IMAGE_ASPECT_COLOR_BIT};
 
@@ -254,10 +278,174 @@ planet::vk::texture planet::vk::texture::create_without_mip_levels_from(
              .filter = args.filter,
              .border_color = args.border_color}};
 
-    return texture;
+    return {std::move(texture), std::move(submission)};
+}
+
+
+planet::vk::texture &planet::vk::texture::operator=(texture &&t) {
+    release();
+    image = std::move(t.image);
+    image_view = std::move(t.image_view);
+    sampler = std::move(t.sampler);
+    fit = t.fit;
+    return *this;
+}
+planet::vk::texture::~texture() { release(); }
+void planet::vk::texture::release() noexcept {
+    if (image_view.get() and sampler.get()) {
+        sampler.device().texture_destroyed(image_view.get(), sampler.get());
+    }
 }
 
 
 planet::vk::texture::operator bool() const noexcept {
     return image.get() and image_view.get() and sampler.get();
 }
+
+
+/// ## `planet::vk::texture_batch`
+
+
+planet::vk::texture_batch::texture_batch(
+        device_memory_allocator &i, vk::command_pool &cp)
+: texture_batch{i.device->staging_memory, i, cp} {}
+planet::vk::texture_batch::texture_batch(
+        device_memory_allocator &s,
+        device_memory_allocator &i,
+        vk::command_pool &cp)
+: staging{s}, images{i}, command_pool{cp} {}
+
+
+std::size_t planet::vk::texture_batch::add(image_data data) {
+    std::size_t const row_bytes = std::size_t{data.width} * 4;
+    if (not data.pitch) { data.pitch = row_bytes; }
+    if (not data.width or not data.height or data.pitch < row_bytes
+        or data.pixels.size() < data.pitch * (data.height - 1) + row_bytes) {
+        throw felspar::stdexcept::logic_error{
+                "The texture's pixel data doesn't cover its size"};
+    }
+    pending.push_back(data);
+    return pending.size() - 1;
+}
+
+
+auto planet::vk::texture_batch::submit() -> upload {
+    if (pending.empty()) { return {}; }
+    trace::scope const tracing{"texture_batch::submit", "upload"};
+
+    /**
+     * Every image gets its own offset in the one staging buffer. Vulkan needs
+     * these to be a multiple of the texel size and of four, and the GPU may
+     * prefer a larger alignment still.
+     */
+    std::size_t const alignment = std::max<std::size_t>(
+            16,
+            images.device()
+                    .instance.gpu()
+                    .properties.limits.optimalBufferCopyOffsetAlignment);
+    std::vector<VkDeviceSize> offsets;
+    offsets.reserve(pending.size());
+    std::size_t byte_count{};
+    for (auto const &p : pending) {
+        byte_count = felspar::memory::aligned_offset(byte_count, alignment);
+        offsets.push_back(byte_count);
+        byte_count += std::size_t{p.width} * p.height * 4;
+    }
+
+    buffer<std::byte> pixels{
+            staging, byte_count, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+    {
+        auto mapped{pixels.map()};
+        for (std::size_t index{}; index < pending.size(); ++index) {
+            auto const &p = pending[index];
+            std::size_t const line_bytes = std::size_t{p.width} * 4;
+            std::byte *const dest_base = mapped.get() + offsets[index];
+            for (std::size_t line{}; line < p.height; ++line) {
+                std::memcpy(
+                        dest_base + line * line_bytes,
+                        p.pixels.data() + line * p.pitch, line_bytes);
+            }
+        }
+    }
+
+    upload batch;
+    batch.textures.reserve(pending.size());
+    std::vector<std::uint32_t> mip_levels;
+    mip_levels.reserve(pending.size());
+    std::vector<VkImageMemoryBarrier> barriers;
+    barriers.reserve(pending.size());
+    for (auto const &p : pending) {
+        mip_levels.push_back(
+                p.mip_levels ? mip_levels_for(p.width, p.height) : 1);
+        auto &texture = batch.textures.emplace_back();
+        texture.fit = p.scale;
+        texture.image = {
+                images,
+                p.width,
+                p.height,
+                mip_levels.back(),
+                VK_SAMPLE_COUNT_1_BIT,
+                p.format,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+                        | VK_IMAGE_USAGE_TRANSFER_DST_BIT
+                        | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+        barriers.push_back(texture.image.transition(
+                {.new_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 .destination_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                 .mip_levels = mip_levels.back()}));
+    }
+
+    auto cb = planet::vk::command_buffer::single_use(command_pool);
+    cb.pipeline_barrier(
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            barriers);
+    for (std::size_t index{}; index < pending.size(); ++index) {
+        copy_from(cb, batch.textures[index].image, pixels, offsets[index]);
+    }
+    barriers.clear();
+    for (std::size_t index{}; index < pending.size(); ++index) {
+        auto &image = batch.textures[index].image;
+        if (mip_levels[index] > 1) {
+            generate_mip_maps(cb, image, mip_levels[index]);
+            image.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        } else {
+            barriers.push_back(image.transition(
+                    {.new_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                     .source_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                     .destination_access_mask = VK_ACCESS_SHADER_READ_BIT}));
+        }
+    }
+    if (not barriers.empty()) {
+        cb.pipeline_barrier(
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, barriers);
+    }
+    batch.submission = std::move(cb).end_and_submit_async();
+    batch.submission.keep_alive(std::move(pixels));
+
+    for (std::size_t index{}; index < pending.size(); ++index) {
+        auto const &p = pending[index];
+        auto &texture = batch.textures[index];
+        texture.image_view = {texture.image, VK_IMAGE_ASPECT_COLOR_BIT};
+        texture.sampler = {
+                {.device = images.device,
+                 .mip_levels = mip_levels[index],
+                 .address_mode = p.address_mode,
+                 .filter = p.filter,
+                 .border_color = p.border_color}};
+    }
+
+    pending.clear();
+    return batch;
+}
+
+
+std::vector<planet::vk::texture> planet::vk::texture_batch::create() {
+    auto batch = submit();
+    batch.submission.wait();
+    return std::move(batch.textures);
+}
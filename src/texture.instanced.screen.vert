@@ -0,0 +1,33 @@
+#version 450
+
+layout(location = 0) in vec4 corners;
+layout(location = 1) in vec4 tex_corners;
+layout(location = 2) in vec4 tint;
+layout(location = 3) in float z;
+
+layout(set = 0, binding = 0) uniform CoordinateSpace {
+    mat4 world;
+    mat4 pixel;
+} coordinates;
+
+layout(location = 0) out vec2 uv;
+layout(location = 1) out vec4 colour;
+
+/// Quad corner for each vertex, in the same order `textured_quad::emit`
+/// indexes them
+const int corner[6] = int[](0, 1, 2, 0, 2, 3);
+
+void main() {
+    int c = corner[gl_VertexIndex];
+    bool right = c < 2;
+    bool bottom = c == 0 || c == 3;
+    vec4 position = vec4(
+            right ? corners.z : corners.x,
+            bottom ? corners.w : corners.y,
+            z, 1.0);
+    gl_Position = coordinates.pixel * position;
+    uv = vec2(
+            right ? tex_corners.z : tex_corners.x,
+            bottom ? tex_corners.w : tex_corners.y);
+    colour = tint;
+}
@@ -0,0 +1,72 @@
+#include <planet/log.hpp>
+#include <planet/vk/headless.hpp>
+#include <planet/vk/texture.hpp>
+
+#include <felspar/test.hpp>
+
+#include <stdexcept>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::texture_batch", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Several textures come from one submission
+    auto const batches = suite.test("batch", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+        planet::vk::texture_batch batch{vk->device.startup_memory, pool};
+
+        std::vector<std::byte> const small(8 * 8 * 4, std::byte{0x80});
+        /// Rows padded out to 40 bytes, as SDL surfaces can be
+        std::vector<std::byte> const padded(40 * 6, std::byte{0x40});
+
+        check(batch.add({.pixels = small, .width = 8, .height = 8})) == 0u;
+        check(batch.add(
+                {.pixels = padded,
+                 .width = 6,
+                 .height = 6,
+                 .pitch = 40,
+                 .mip_levels = false}))
+                == 1u;
+        check(batch.add({.pixels = small, .width = 4, .height = 16})) == 2u;
+        check(batch.size()) == 3u;
+
+        auto const textures = batch.create();
+        check(batch.size()) == 0u;
+        check(textures.size()) == 3u;
+        check(textures[0].image.mip_levels) == 4u;
+        check(textures[1].image.mip_levels) == 1u;
+        check(textures[2].image.mip_levels) == 5u;
+        for (auto const &t : textures) {
+            check(static_cast<bool>(t)) == true;
+            check(t.image.layout) == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+    });
+
+
+    /// ## Pixel data smaller than the image is rejected
+    auto const rejects = suite.test("too-small", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::command_pool pool{vk->device, vk->instance.surface};
+        planet::vk::texture_batch batch{vk->device.startup_memory, pool};
+
+        std::vector<std::byte> const pixels(8 * 7 * 4);
+        check([&]() {
+            batch.add({.pixels = pixels, .width = 8, .height = 8});
+        }).throws(std::logic_error{
+                "The texture's pixel data doesn't cover its size"});
+        check(batch.size()) == 0u;
+    });
+
+
+}
@@ -0,0 +1,22 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+/// The texture slot is after the space `sprite` uses for its transform
+layout(push_constant) uniform PushConstants {
+    layout(offset = 64) uint texture_index;
+} push_constant;
+
+layout(location = 0) in vec2 tex_uv;
+layout(location = 1) in vec4 hint_colour;
+
+
+layout(location = 0) out vec4 colour;
+layout(location = 1) out vec4 glow;
+
+
+void main() {
+    colour = texture(textures[push_constant.texture_index], tex_uv) * hint_colour;
+    glow = vec4(0.0, 0.0, 0.0, colour.a);
+}
@@ -0,0 +1,156 @@
+#include <planet/vk/engine/pipeline/textured_quad.hpp>
+
+#include <felspar/test.hpp>
+
+#include <cstring>
+
+
+namespace {
+
+
+    using pipeline = planet::vk::engine::pipeline::textured_quad;
+
+
+    auto const suite = felspar::testsuite("textured_quad::emit");
+
+
+    std::vector<pipeline::quad_draw_info> make_quads(std::size_t const count) {
+        std::vector<pipeline::quad_draw_info> quads;
+        quads.reserve(count);
+        for (std::size_t index{}; index < count; ++index) {
+            auto const x = static_cast<float>(index % 256);
+            auto const y = static_cast<float>(index / 256);
+            quads.push_back(
+                    {.position = {{x, y}, planet::affine::extents2d{1, 1}},
+                     .uv = {{0, 0}, planet::affine::extents2d{1, 1}},
+                     .colour = planet::colour::white,
+                     .z = 0.5f});
+        }
+        return quads;
+    }
+
+
+    /// ### Expand into a CPU side vector and copy to the destination
+    /**
+     * This is the staged path, where the destination stands in for mapped GPU
+     * memory.
+     */
+    void staged(
+            std::span<pipeline::quad_draw_info const> const quads,
+            std::vector<pipeline::vertex_type> &vertices,
+            std::byte *const destination) {
+        vertices.resize(quads.size() * pipeline::vertices_per_quad);
+        for (std::size_t quad{}; auto const &q : quads) {
+            pipeline::emit(
+                    q, vertices.data() + quad * pipeline::vertices_per_quad);
+            ++quad;
+        }
+        std::memcpy(
+                destination, vertices.data(),
+                vertices.size() * sizeof(pipeline::vertex_type));
+    }
+
+
+    /// ### Expand straight into the destination
+    void write_through(
+            std::span<pipeline::quad_draw_info const> const quads,
+            std::byte *const destination) {
+        auto *vertices =
+                reinterpret_cast<pipeline::vertex_type *>(destination);
+        for (auto const &q : quads) {
+            pipeline::emit(q, vertices);
+            vertices += pipeline::vertices_per_quad;
+        }
+    }
+
+
+    /// The indices are shared, so only the vertices are written per quad
+    constexpr std::size_t bytes_per_quad =
+            pipeline::vertices_per_quad * sizeof(pipeline::vertex_type);
+
+
+    /// ## Both paths produce the same GPU data
+    auto const same = suite.test("same-output", [](auto check) {
+        auto const quads = make_quads(1000);
+        std::vector<std::byte> a(quads.size() * bytes_per_quad),
+                b(quads.size() * bytes_per_quad);
+        std::vector<pipeline::vertex_type> vertices;
+
+        staged(quads, vertices, a.data());
+        write_through(quads, b.data());
+
+        check(std::memcmp(a.data(), b.data(), a.size())) == 0;
+    });
+
+
+    /// ## Both paths draw the same triangles
+    /**
+     * Walks the shared quad indices over the vertices from each path, as the
+     * GPU would, so an index that points at the wrong vertex, or past the end,
+     * in either path is caught.
+     */
+    auto const triangles = suite.test("same-triangles", [](auto check) {
+        auto const quads = make_quads(600);
+        auto const vertex_count = quads.size() * pipeline::vertices_per_quad;
+        std::vector<pipeline::vertex_type> vertices, through(vertex_count);
+        std::vector<std::byte> copied(
+                vertex_count * sizeof(pipeline::vertex_type));
+
+        staged(quads, vertices, copied.data());
+        write_through(quads, reinterpret_cast<std::byte *>(through.data()));
+
+        std::vector<std::uint32_t> indices(
+                quads.size() * pipeline::indices_per_quad);
+        planet::vk::engine::quad_index_buffer::fill<std::uint32_t>(indices);
+        for (auto const index : indices) {
+            check(index) < vertex_count;
+            check(std::memcmp(
+                    copied.data() + index * sizeof(pipeline::vertex_type),
+                    &through[index], sizeof(pipeline::vertex_type)))
+                    == 0;
+        }
+
+        /// Each quad's two triangles use only that quad's vertices
+        for (std::size_t quad{}; quad < quads.size(); ++quad) {
+            for (std::size_t corner{}; corner < pipeline::indices_per_quad;
+                 ++corner) {
+                check(indices[quad * pipeline::indices_per_quad + corner]
+                      / pipeline::vertices_per_quad)
+                        == quad;
+            }
+        }
+    });
+
+
+    /// ## Vertex pulling uploads one record per quad
+    auto const instance = suite.test("instance", [](auto check) {
+        /// The colour is clamped and rounded to 8 bits
+        auto tint = planet::colour::white;
+        tint.g = 0.5f;
+        tint.b = -1.0f;
+        tint.a = 2.0f;
+        auto const record = pipeline::make_instance(
+                {.position = {{2, 3}, planet::affine::extents2d{4, 5}},
+                 .uv = {{0.25f, 0.5f}, planet::affine::extents2d{0.5f, 0.25f}},
+                 .colour = tint,
+                 .z = 0.5f});
+        check(record.position[0]) == 2.0f;
+        check(record.position[1]) == 3.0f;
+        check(record.position[2]) == 6.0f;
+        check(record.position[3]) == 8.0f;
+        check(record.uv[0]) == 0.25f;
+        check(record.uv[1]) == 0.5f;
+        check(record.uv[2]) == 0.75f;
+        check(record.uv[3]) == 0.75f;
+        check(record.colour[0]) == 255u;
+        check(record.colour[1]) == 128u;
+        check(record.colour[2]) == 0u;
+        check(record.colour[3]) == 255u;
+        check(record.z) == 0.5f;
+
+        /// Fewer bytes than even the vertices of a quad
+        check(sizeof(pipeline::instance_type)) < bytes_per_quad;
+    });
+
+
+}
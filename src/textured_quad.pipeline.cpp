@@ -2,28 +2,112 @@
 #include <planet/vk/engine/renderer.hpp>
 #include <planet/vk/engine/pipeline/textured_quad.hpp>
 
+#include <algorithm>
+
 
 /// ## `planet::vk::engine::pipeline::textured_quad`
 
 
+namespace {
+    /// Matches the `sprite` push constant layout, see `textured.bindless.frag`
+    constexpr std::uint32_t bindless_slot_offset = 64;
+
+    using instance_type =
+            planet::vk::engine::pipeline::textured_quad::instance_type;
+
+    constexpr auto instance_binding_description = std::array{
+            VkVertexInputBindingDescription{
+                    .binding = 0,
+                    .stride = sizeof(instance_type),
+                    .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE}};
+    constexpr auto instance_attribute_description = std::array{
+            VkVertexInputAttributeDescription{
+                    .location = 0,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, position)},
+            VkVertexInputAttributeDescription{
+                    .location = 1,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+                    .offset = offsetof(instance_type, uv)},
+            VkVertexInputAttributeDescription{
+                    .location = 2,
+                    .binding = 0,
+                    .format = VK_FORMAT_R8G8B8A8_UNORM,
+                    .offset = offsetof(instance_type, colour)},
+            VkVertexInputAttributeDescription{
+                    .location = 3,
+                    .binding = 0,
+                    .format = VK_FORMAT_R32_SFLOAT,
+                    .offset = offsetof(instance_type, z)}};
+
+    std::uint8_t as_unorm8(float const channel) noexcept {
+        return static_cast<std::uint8_t>(
+                std::clamp(channel, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+
 planet::vk::engine::pipeline::textured_quad::textured_quad(parameters const p)
 : id{p.name, p.use_name_suffix},
   textures_ubo{
           std::string{name()} + "__textures_ubo", p.renderer.app.device,
           p.textures_per_frame},
-  pipeline{planet::vk::engine::create_graphics_pipeline(
-          {.app = p.renderer.app,
-           .renderer = p.renderer,
-           .vertex_shader = p.vertex_shader,
-           .fragment_shader = p.fragment_shader,
-           .binding_descriptions = vertex::binding_description<vertex_type>(),
-           .attribute_descriptions =
-                   vertex::attribute_description<vertex_type>(),
-           .pipeline_layout = pipeline_layout{
-                   p.renderer.app.device,
-                   std::array{
-                           p.renderer.coordinates_ubo_layout().get(),
-                           textures_ubo.layout.get()}}})} {}
+  pipeline{create_pipeline(p)},
+  write_through{p.write_through},
+  vertex_pulling{p.vertex_pulling},
+  bindless{
+          p.bindless and p.renderer.bindless ? &*p.renderer.bindless
+                                             : nullptr} {}
+
+
+planet::vk::graphics_pipeline
+        planet::vk::engine::pipeline::textured_quad::create_pipeline(
+                parameters const &p) {
+    auto const vertex_bindings = vertex::binding_description<vertex_type>();
+    auto const vertex_attributes = vertex::attribute_description<vertex_type>();
+    std::span<VkVertexInputBindingDescription const> bindings =
+            vertex_bindings;
+    std::span<VkVertexInputAttributeDescription const> attributes =
+            vertex_attributes;
+    if (p.vertex_pulling) {
+        bindings = instance_binding_description;
+        attributes = instance_attribute_description;
+    }
+
+    if (p.bindless and p.renderer.bindless) {
+        VkPushConstantRange slot;
+        slot.offset = bindless_slot_offset;
+        slot.size = sizeof(std::uint32_t);
+        slot.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        return planet::vk::engine::create_graphics_pipeline(
+                {.app = p.renderer.app,
+                 .renderer = p.renderer,
+                 .vertex_shader = p.vertex_shader,
+                 .fragment_shader = p.bindless_fragment_shader,
+                 .binding_descriptions = bindings,
+                 .attribute_descriptions = attributes,
+                 .pipeline_layout = pipeline_layout{
+                         p.renderer.app.device,
+                         std::array{
+                                 p.renderer.coordinates_ubo_layout().get(),
+                                 p.renderer.bindless->layout.get()},
+                         std::array{slot}}});
+    }
+    return planet::vk::engine::create_graphics_pipeline(
+            {.app = p.renderer.app,
+             .renderer = p.renderer,
+             .vertex_shader = p.vertex_shader,
+             .fragment_shader = p.fragment_shader,
+             .binding_descriptions = bindings,
+             .attribute_descriptions = attributes,
+             .pipeline_layout = pipeline_layout{
+                     p.renderer.app.device,
+                     std::array{
+                             p.renderer.coordinates_ubo_layout().get(),
+                             textures_ubo.layout.get()}}});
+}
 
 
 void planet::vk::engine::pipeline::textured_quad::draw(
@@ -38,6 +122,50 @@ void planet::vk::engine::pipeline::textured_quad::draw(
                     .uv = texture.second,
                     .colour = colour,
                     .z = z});
+    ++quad_count;
+}
+
+
+void planet::vk::engine::pipeline::textured_quad::emit(
+        quad_draw_info const &cmd, vertex_type *const vertices) noexcept {
+    auto const &pos = cmd.position;
+    auto const &uv = cmd.uv;
+    auto const uv_br = uv.bottom_right();
+
+    vertices[0] = {
+            {pos.top_left.xh + pos.extents.width,
+             pos.top_left.yh + pos.extents.height, cmd.z},
+            cmd.colour,
+            {uv_br.xh, uv_br.yh}};
+    vertices[1] = {
+            {pos.top_left.xh + pos.extents.width, pos.top_left.yh, cmd.z},
+            cmd.colour,
+            {uv_br.xh, uv.top_left.yh}};
+    vertices[2] = {
+            {pos.top_left.xh, pos.top_left.yh, cmd.z},
+            cmd.colour,
+            {uv.top_left.xh, uv.top_left.yh}};
+    vertices[3] = {
+            {pos.top_left.xh, pos.top_left.yh + pos.extents.height, cmd.z},
+            cmd.colour,
+            {uv.top_left.xh, uv_br.yh}};
+}
+
+
+auto planet::vk::engine::pipeline::textured_quad::make_instance(
+        quad_draw_info const &cmd) noexcept -> instance_type {
+    auto const &pos = cmd.position;
+    auto const &uv = cmd.uv;
+    auto const uv_br = uv.bottom_right();
+    return {.position =
+                    {pos.top_left.xh, pos.top_left.yh,
+                     pos.top_left.xh + pos.extents.width,
+                     pos.top_left.yh + pos.extents.height},
+            .uv = {uv.top_left.xh, uv.top_left.yh, uv_br.xh, uv_br.yh},
+            .colour =
+                    {as_unorm8(cmd.colour.r), as_unorm8(cmd.colour.g),
+                     as_unorm8(cmd.colour.b), as_unorm8(cmd.colour.a)},
+            .z = cmd.z};
 }
 
 
@@ -47,112 +175,158 @@ void planet::vk::engine::pipeline::textured_quad::render(render_parameters rp) {
     if (texture_count == 0) { return; }
 
     textures_ubo.textures_in_frame.value(texture_count);
-    if (texture_count > textures_ubo.max_per_frame) {
-        planet::log::critical(
-                "We will run out of texture slots for this frame");
-    }
 
     /// #### Pass 1
-    /// Build combined vertex and index buffers across all textures
-    vertices.clear();
-    indices.clear();
+    /**
+     * Build the combined buffers across all textures, with the quads for each
+     * texture next to each other.
+     */
+    if (vertex_pulling) {
+        upload_instances(rp);
+    } else {
+        upload_vertices(rp);
+    }
+
+    /// #### Pass 2
+    /**
+     * Point the descriptor sets at the textures. Sets that already hold the
+     * right texture from the last time this frame index was drawn are
+     * skipped, and the rest are written in a single batch.
+     */
+    if (bindless) {
+        auto const set = bindless->set();
+        vkCmdBindDescriptorSets(
+                rp.cb.get(), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                pipeline.layout.get(), 1, 1, &set, 0, nullptr);
+    } else {
+        for (std::uint32_t texture_index{};
+             auto const &[texture, cmds] : commands.non_empty_vectors()) {
+            textures_ubo.write(
+                    rp.current_frame, texture_index++,
+                    {.sampler = texture->sampler.get(),
+                     .imageView = texture->image_view.get(),
+                     .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+        }
+        textures_ubo.flush();
+    }
+
+    /// #### Pass 3
+    /// Issue one draw call per texture using offsets into the combined buffers
+    std::uint32_t texture_index = 0;
+    std::uint32_t first_quad = 0;
+    for (auto const &[texture, cmds] : commands.non_empty_vectors()) {
+        auto const count = static_cast<std::uint32_t>(cmds.size());
+
+        if (bindless) {
+            auto const slot = bindless->slot_for(*texture);
+            vkCmdPushConstants(
+                    rp.cb.get(), pipeline.layout.get(),
+                    VK_SHADER_STAGE_FRAGMENT_BIT, bindless_slot_offset,
+                    sizeof(slot), &slot);
+        } else {
+            auto const set = textures_ubo.set(rp.current_frame, texture_index);
+            vkCmdBindDescriptorSets(
+                    rp.cb.get(), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    pipeline.layout.get(), 1, 1, &set, 0, nullptr);
+        }
+
+        if (vertex_pulling) {
+            static constexpr std::uint32_t first_vertex = 0;
+            vkCmdDraw(
+                    rp.cb.get(), vertices_per_instance, count, first_vertex,
+                    first_quad);
+        } else {
+            static constexpr std::uint32_t instance_count = 1;
+            static constexpr std::int32_t vertex_offset = 0;
+            static constexpr std::uint32_t first_instance = 0;
+            vkCmdDrawIndexed(
+                    rp.cb.get(),
+                    static_cast<std::uint32_t>(count * indices_per_quad),
+                    instance_count,
+                    static_cast<std::uint32_t>(first_quad * indices_per_quad),
+                    vertex_offset, first_instance);
+        }
+
+        first_quad += count;
+        ++texture_index;
+    }
+
+    commands.clear();
+    quad_count = 0;
+}
+
+
+/// ### Uploading four vertices per quad
+/**
+ * When writing through the quads are expanded directly into the mapped
+ * memory from `frame_uploads`, otherwise they go into the CPU side vector
+ * first and are then copied. The indices come from the renderer.
+ */
+void planet::vk::engine::pipeline::textured_quad::upload_vertices(
+        render_parameters &rp) {
+    auto &uploads = rp.renderer.frame_uploads;
+    auto const total_vertices = quad_count * vertices_per_quad;
+    memory::frame_ring::span<vertex_type> vertex_buffer;
+    vertex_type *vertex_out;
+    if (write_through) {
+        vertex_buffer =
+                uploads.allocate<vertex_type>(rp.current_frame, total_vertices);
+        vertex_out = vertex_buffer.data.data();
+    } else {
+        vertices.resize(total_vertices);
+        vertex_out = vertices.data();
+    }
     for (auto const &[texture, cmds] : commands.non_empty_vectors()) {
         for (auto const &cmd : cmds) {
-            auto const quad_index = static_cast<std::uint32_t>(vertices.size());
-
-            auto const &pos = cmd.position;
-            auto const &uv = cmd.uv;
-            auto const uv_br = uv.bottom_right();
-
-            vertices.push_back(
-                    {{pos.top_left.xh + pos.extents.width,
-                      pos.top_left.yh + pos.extents.height, cmd.z},
-                     cmd.colour,
-                     {uv_br.xh, uv_br.yh}});
-            vertices.push_back(
-                    {{pos.top_left.xh + pos.extents.width, pos.top_left.yh,
-                      cmd.z},
-                     cmd.colour,
-                     {uv_br.xh, uv.top_left.yh}});
-            vertices.push_back(
-                    {{pos.top_left.xh, pos.top_left.yh, cmd.z},
-                     cmd.colour,
-                     {uv.top_left.xh, uv.top_left.yh}});
-            vertices.push_back(
-                    {{pos.top_left.xh, pos.top_left.yh + pos.extents.height,
-                      cmd.z},
-                     cmd.colour,
-                     {uv.top_left.xh, uv_br.yh}});
-
-            indices.push_back(quad_index);
-            indices.push_back(quad_index + 1);
-            indices.push_back(quad_index + 2);
-            indices.push_back(quad_index);
-            indices.push_back(quad_index + 2);
-            indices.push_back(quad_index + 3);
+            emit(cmd, vertex_out);
+            vertex_out += vertices_per_quad;
         }
     }
+    if (not write_through) {
+        vertex_buffer = uploads.upload(rp.current_frame, vertices);
+    }
 
-    /// #### Upload combined buffers to GPU once
-    auto &vertex_buffer = vertex_buffers[rp.current_frame];
-    vertex_buffer = {
-            rp.renderer.per_frame_memory, vertices,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-    auto &index_buffer = index_buffers[rp.current_frame];
-    index_buffer = {
-            rp.renderer.per_frame_memory, indices,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-                    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-
-    std::array buffers{vertex_buffer.get()};
-    std::array offset{VkDeviceSize{}};
+    std::array buffers{vertex_buffer.buffer};
+    std::array offset{vertex_buffer.offset};
     vkCmdBindVertexBuffers(
             rp.cb.get(), 0, buffers.size(), buffers.data(), offset.data());
-    vkCmdBindIndexBuffer(
-            rp.cb.get(), index_buffer.get(), 0, VK_INDEX_TYPE_UINT32);
+    if (rp.renderer.quad_indices.bind(rp.cb, quad_count)
+        == VK_INDEX_TYPE_UINT16) {
+        ++c_index16_batches;
+    } else {
+        ++c_index32_batches;
+    }
+}
 
-    /// #### Pass 2
-    /// Issue one draw call per texture using offsets into the combined buffers
-    std::size_t texture_index = 0;
-    std::uint32_t first_index = 0;
-    for (auto const &[texture, cmds] : commands.non_empty_vectors()) {
-        auto const index_count = static_cast<std::uint32_t>(cmds.size()) * 6u;
-
-        VkDescriptorImageInfo const texture_info{
-                .sampler = texture->sampler.get(),
-                .imageView = texture->image_view.get(),
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
-
-        VkWriteDescriptorSet wds{};
-        wds.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        wds.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        wds.dstSet = textures_ubo.sets[rp.current_frame][texture_index];
-        wds.dstBinding = 0;
-        wds.dstArrayElement = 0;
-        wds.descriptorCount = 1;
-        wds.pImageInfo = &texture_info;
-        vkUpdateDescriptorSets(
-                rp.renderer.app.device.get(), 1, &wds, 0, nullptr);
 
-        vkCmdBindDescriptorSets(
-                rp.cb.get(), VK_PIPELINE_BIND_POINT_GRAPHICS,
-                pipeline.layout.get(), 1, 1,
-                &textures_ubo.sets[rp.current_frame][texture_index], 0,
-                nullptr);
-
-        static constexpr std::uint32_t instance_count = 1;
-        static constexpr std::int32_t vertex_offset = 0;
-        static constexpr std::uint32_t first_instance = 0;
-        vkCmdDrawIndexed(
-                rp.cb.get(), index_count, instance_count, first_index,
-                vertex_offset, first_instance);
-
-        first_index += index_count;
-        ++texture_index;
+/// ### Uploading one instance record per quad
+/**
+ * The vertex shader builds the corners, so there is no index buffer and each
+ * quad costs `sizeof(instance_type)` bytes rather than four vertices and six
+ * indices.
+ */
+void planet::vk::engine::pipeline::textured_quad::upload_instances(
+        render_parameters &rp) {
+    auto &uploads = rp.renderer.frame_uploads;
+    memory::frame_ring::span<instance_type> instance_buffer;
+    instance_type *out;
+    if (write_through) {
+        instance_buffer =
+                uploads.allocate<instance_type>(rp.current_frame, quad_count);
+        out = instance_buffer.data.data();
+    } else {
+        instances.resize(quad_count);
+        out = instances.data();
+    }
+    for (auto const &[texture, cmds] : commands.non_empty_vectors()) {
+        for (auto const &cmd : cmds) { *out++ = make_instance(cmd); }
+    }
+    if (not write_through) {
+        instance_buffer = uploads.upload(rp.current_frame, instances);
     }
 
-    commands.clear();
+    std::array buffers{instance_buffer.buffer};
+    std::array offset{instance_buffer.offset};
+    vkCmdBindVertexBuffers(
+            rp.cb.get(), 0, buffers.size(), buffers.data(), offset.data());
 }
@@ -0,0 +1,234 @@
+#include <planet/vk/trace.hpp>
+
+#include <felspar/exceptions/logic_error.hpp>
+#include <felspar/exceptions/runtime_error.hpp>
+
+#include <array>
+#include <iomanip>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+
+    /// ## Per-thread event rings
+    struct event {
+        char const *name;
+        char const *category;
+        planet::vk::trace::clock::time_point start;
+        planet::vk::trace::clock::duration duration;
+        bool gpu;
+    };
+    constexpr std::size_t ring_size = 1u << 13;
+    /**
+     * Only the owning thread writes to the `head` and only the session
+     * reads from the `tail`, so a pair of atomics is all the synchronisation
+     * that is needed.
+     */
+    struct ring {
+        ring(std::size_t const t) : tid{t} {}
+
+        std::size_t const tid;
+        std::atomic<bool> in_use = true;
+        std::atomic<std::size_t> head = {}, tail = {};
+        std::array<event, ring_size> events;
+    };
+
+    /**
+     * Rings are never freed. When a thread exits its ring is handed to the
+     * next thread to record an event once the session has emptied it.
+     */
+    std::mutex rings_mutex;
+    std::vector<std::unique_ptr<ring>> rings;
+    std::atomic<std::size_t> dropped_events = {};
+
+    ring *claim_ring() {
+        std::scoped_lock _{rings_mutex};
+        for (auto &r : rings) {
+            if (not r->in_use.load(std::memory_order_acquire)
+                and r->head.load(std::memory_order_relaxed)
+                        == r->tail.load(std::memory_order_acquire)) {
+                r->in_use.store(true, std::memory_order_relaxed);
+                return r.get();
+            }
+        }
+        rings.push_back(std::make_unique<ring>(rings.size() + 1));
+        return rings.back().get();
+    }
+
+    struct thread_ring {
+        ring *mine = nullptr;
+        ~thread_ring() {
+            if (mine) { mine->in_use.store(false, std::memory_order_release); }
+        }
+    };
+    thread_local thread_ring this_thread;
+
+
+    /// ## Interned names
+    std::mutex names_mutex;
+    std::set<std::string, std::less<>> names;
+
+
+    /// ## Only one session at a time
+    std::atomic<bool> session_running = false;
+
+
+    /// ## JSON output
+    void write_string(std::ostream &os, char const *s) {
+        os << '"';
+        for (; *s; ++s) {
+            auto const c = *s;
+            if (c == '"' or c == '\\') {
+                os << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                os << ' ';
+            } else {
+                os << c;
+            }
+        }
+        os << '"';
+    }
+    double as_us(planet::vk::trace::clock::duration const d) {
+        return std::chrono::duration<double, std::micro>{d}.count();
+    }
+    constexpr std::size_t gpu_tid = 0;
+    void write_thread_name(
+            std::ostream &os, std::size_t const tid, std::string_view const n) {
+        os << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid
+           << R"(,"args":{"name":")" << n << R"("}})";
+    }
+
+
+}
+
+
+/// ## `planet::vk::trace`
+
+
+void planet::vk::trace::detail::record(
+        char const *const name,
+        char const *const category,
+        clock::time_point const start,
+        clock::duration const duration,
+        bool const gpu) noexcept {
+    if (not this_thread.mine) {
+        try {
+            this_thread.mine = claim_ring();
+        } catch (...) {
+            dropped_events.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    auto &r = *this_thread.mine;
+    auto const head = r.head.load(std::memory_order_relaxed);
+    if (head - r.tail.load(std::memory_order_acquire) >= ring_size) {
+        dropped_events.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    r.events[head % ring_size] = {name, category, start, duration, gpu};
+    r.head.store(head + 1, std::memory_order_release);
+}
+
+
+char const *planet::vk::trace::intern(std::string_view const n) {
+    std::scoped_lock _{names_mutex};
+    auto found = names.find(n);
+    if (found == names.end()) { found = names.emplace(n).first; }
+    return found->c_str();
+}
+
+
+/// ## `planet::vk::trace::session`
+
+
+planet::vk::trace::session::session(
+        std::filesystem::path const path, clock::duration const interval) {
+    if (session_running.exchange(true)) {
+        throw felspar::stdexcept::logic_error{
+                "A trace session is already running"};
+    }
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (not file) {
+        session_running = false;
+        throw felspar::stdexcept::runtime_error{
+                "Could not open the trace file " + path.string()};
+    }
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+    write_thread_name(file, gpu_tid, "GPU");
+    detail::active = true;
+    writer = std::thread{[this, interval]() {
+        std::unique_lock lock{mutex};
+        auto const stopped = [this]() { return stopping; };
+        while (not wake.wait_for(lock, interval, stopped)) { drain(); }
+    }};
+}
+
+
+planet::vk::trace::session::~session() {
+    detail::active = false;
+    {
+        std::scoped_lock _{mutex};
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    drain();
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    file.close();
+    session_running = false;
+}
+
+
+void planet::vk::trace::session::flush() {
+    std::scoped_lock _{mutex};
+    drain();
+}
+
+
+std::size_t planet::vk::trace::session::written() const {
+    std::scoped_lock _{mutex};
+    return events;
+}
+
+
+std::size_t planet::vk::trace::session::dropped() noexcept {
+    return dropped_events.load(std::memory_order_relaxed);
+}
+
+
+void planet::vk::trace::session::drain() {
+    std::vector<ring *> current;
+    {
+        std::scoped_lock _{rings_mutex};
+        current.reserve(rings.size());
+        for (auto &r : rings) { current.push_back(r.get()); }
+    }
+    for (; named < current.size(); ++named) {
+        file << ",\n";
+        write_thread_name(
+                file, current[named]->tid,
+                "thread " + std::to_string(current[named]->tid));
+    }
+    for (auto *r : current) {
+        auto tail = r->tail.load(std::memory_order_relaxed);
+        auto const head = r->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            auto const &e = r->events[tail % ring_size];
+            file << ",\n{\"name\":";
+            write_string(file, e.name);
+            file << ",\"cat\":";
+            write_string(file, e.category);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                 << (e.gpu ? gpu_tid : r->tid)
+                 << ",\"ts\":" << as_us(e.start - origin)
+                 << ",\"dur\":" << as_us(e.duration) << '}';
+            ++events;
+        }
+        r->tail.store(tail, std::memory_order_release);
+    }
+    file.flush();
+}
@@ -0,0 +1,87 @@
+#include <planet/vk/trace.hpp>
+
+#include <felspar/test.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::trace");
+
+
+    std::string read(std::filesystem::path const &path) {
+        std::ifstream file{path};
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+
+    /// ## Events from several threads end up in the file
+    auto const writes = suite.test("session", [](auto check) {
+        auto const path = std::filesystem::temp_directory_path()
+                / "planet-vk-trace.tests.json";
+        {
+            /// Nothing is recorded before the session starts
+            planet::vk::trace::scope const ignored{"ignored", "test"};
+        }
+        {
+            planet::vk::trace::session session{path};
+            check(planet::vk::trace::enabled()) == true;
+            {
+                planet::vk::trace::scope const outer{"outer", "test"};
+                planet::vk::trace::scope const inner{
+                        std::string_view{"inner \"quoted\""}, "test"};
+            }
+            std::thread{[]() {
+                planet::vk::trace::scope const t{"worker", "test"};
+            }}.join();
+            planet::vk::trace::complete(
+                    "gpu work", "gpu", planet::vk::trace::clock::now(),
+                    std::chrono::microseconds{5}, true);
+            session.flush();
+            check(session.written()) == 4u;
+        }
+        check(planet::vk::trace::enabled()) == false;
+
+        auto const json = read(path);
+        check(json.starts_with("{\"traceEvents\":[")) == true;
+        check(json.ends_with("\"displayTimeUnit\":\"ms\"}\n")) == true;
+        check(json.find("\"outer\"")) != std::string::npos;
+        check(json.find(R"("inner \"quoted\"")")) != std::string::npos;
+        check(json.find("\"worker\"")) != std::string::npos;
+        check(json.find("\"gpu work\"")) != std::string::npos;
+        check(json.find("\"ignored\"")) == std::string::npos;
+        std::filesystem::remove(path);
+    });
+
+
+    /// ## Only one session at a time
+    auto const one = suite.test("one-session", [](auto check) {
+        auto const path = std::filesystem::temp_directory_path()
+                / "planet-vk-trace.one.tests.json";
+        {
+            planet::vk::trace::session session{path};
+            check([&]() {
+                planet::vk::trace::session second{path};
+            }).throws(std::logic_error{"A trace session is already running"});
+        }
+        std::filesystem::remove(path);
+    });
+
+
+    /// ## Interning returns the same pointer for the same string
+    auto const interns = suite.test("intern", [](auto check) {
+        std::string const name{"interned name"};
+        auto const *first = planet::vk::trace::intern(name);
+        check(first) != name.c_str();
+        check(planet::vk::trace::intern("interned name")) == first;
+        check(std::string_view{first}) == "interned name";
+    });
+
+
+}
@@ -0,0 +1,128 @@
+#include <planet/log.hpp>
+#include <planet/vk/headless.hpp>
+#include <planet/vk/image.hpp>
+#include <planet/vk/texture.hpp>
+#include <planet/vk/ubo/textures.hpp>
+#include <planet/vk/vertex/coloured_textured.hpp>
+
+#include <felspar/test.hpp>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::ubo::textures", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ### A view and sampler to write into the sets
+    struct sampled_image {
+        planet::vk::image image;
+        planet::vk::image_view view;
+        planet::vk::sampler sampler;
+
+        sampled_image(planet::vk::device &device)
+        : image{device.startup_memory,
+                4,
+                4,
+                1,
+                VK_SAMPLE_COUNT_1_BIT,
+                VK_FORMAT_R8G8B8A8_UNORM,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT},
+          view{image, VK_IMAGE_ASPECT_COLOR_BIT},
+          sampler{{.device = device}} {}
+
+        VkDescriptorImageInfo info() const {
+            return {.sampler = sampler.get(),
+                    .imageView = view.get(),
+                    .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        }
+    };
+
+
+    /// ## Writes are only needed when a set changes texture
+    /**
+     * Each frame index has its own sets, so the first write for each frame
+     * index always misses. After that only sets that are pointed at a
+     * different texture are written again.
+     */
+    auto const cache = suite.test("write-cache", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::ubo::textures<planet::vertex::coloured_textured, 2> ubo{
+                "write_cache", vk->device, 4};
+        sampled_image a{vk->device}, b{vk->device};
+
+        ubo.write(0, 0, a.info());
+        ubo.write(1, 0, a.info());
+        ubo.flush();
+        check(ubo.write_misses.value()) == 2;
+        check(ubo.write_hits.value()) == 0;
+
+        ubo.write(0, 0, a.info());
+        ubo.write(0, 1, b.info());
+        ubo.flush();
+        check(ubo.write_misses.value()) == 3;
+        check(ubo.write_hits.value()) == 1;
+
+        ubo.write(0, 0, b.info());
+        ubo.write(0, 1, a.info());
+        ubo.flush();
+        check(ubo.write_misses.value()) == 5;
+        check(ubo.write_hits.value()) == 1;
+    });
+
+
+    /// ## Sets are allocated past the first pool
+    auto const grows = suite.test("grows", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::ubo::textures<planet::vertex::coloured_textured, 2> ubo{
+                "grows", vk->device, 2};
+        sampled_image a{vk->device};
+
+        for (std::uint32_t index{}; index < 9; ++index) {
+            ubo.write(0, index, a.info());
+        }
+        ubo.flush();
+        check(ubo.write_misses.value()) == 9;
+        check(ubo.set(0, 8)) != ubo.set(0, 0);
+        check(ubo.set(0, 8)) == ubo.set(0, 8);
+    });
+
+
+    /// ## Reset returns the sets without creating new pools
+    auto const reset = suite.test("allocator-reset", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::descriptor_set_layout layout{
+                vk->device,
+                {.binding = 0,
+                 .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                 .descriptorCount = 1,
+                 .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+                 .pImmutableSamplers = nullptr}};
+        planet::vk::descriptor_allocator sets{
+                "allocator_reset", vk->device,
+                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2};
+
+        for (std::size_t frame{}; frame < 3; ++frame) {
+            sets.reset();
+            for (std::size_t count{}; count < 7; ++count) {
+                sets.allocate(layout);
+            }
+            check(sets.allocated()) == 7u;
+        }
+        /// Pools of 2, 4 and 8 sets are enough for 7 every frame
+        check(sets.pool_count()) == 3u;
+    });
+
+
+}
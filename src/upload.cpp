@@ -0,0 +1,350 @@
+#include <planet/vk/device.hpp>
+#include <planet/vk/surface.hpp>
+#include <planet/vk/trace.hpp>
+#include <planet/vk/upload.hpp>
+
+#include <felspar/exceptions/logic_error.hpp>
+#include <felspar/memory/sizes.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+
+/// ## `planet::vk::upload_engine`
+
+
+namespace {
+    /// Size of a texel for the uncompressed formats images are uploaded in
+    std::size_t bytes_per_texel(VkFormat const format) {
+        switch (format) {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SRGB: return 1;
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R8G8_SRGB:
+        case VK_FORMAT_R16_SFLOAT: return 2;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_SFLOAT: return 4;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT: return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+        default:
+            throw felspar::stdexcept::logic_error{
+                    "The upload engine doesn't know the texel size of the "
+                    "image's format"};
+        }
+    }
+}
+
+
+planet::vk::upload_engine::upload_engine(
+        vk::device &d, vk::surface const &surface, configuration const &c)
+: config{c},
+  device{d},
+  allocator{"upload_engine__staging", d},
+  graphics_family{surface.graphics_queue_family_index()},
+  transfer_family{graphics_family},
+  graphics_pool{d, surface} {
+    if (auto queue = d.transfer_queue(); queue) {
+        transfer_family = queue.family_index();
+        transfer_pool.emplace(d, std::move(queue));
+    }
+}
+
+
+planet::vk::upload_engine::~upload_engine() { wait_idle(); }
+
+
+auto planet::vk::upload_engine::commands() -> command_buffer & {
+    if (not recording.commands.get()) {
+        recording.commands = command_buffer::single_use(
+                transfer_pool ? *transfer_pool : graphics_pool);
+    }
+    return recording.commands;
+}
+
+
+auto planet::vk::upload_engine::allocate(
+        std::span<std::byte const> const data, std::size_t const alignment)
+        -> staging {
+    c_bytes += data.size();
+    auto &chunks = recording.chunks;
+    if (not chunks.empty()) {
+        auto &ch = chunks.back();
+        auto const start =
+                felspar::memory::aligned_offset(recording.offset, alignment);
+        if (start + data.size() <= ch.memory.byte_count()) {
+            std::memcpy(ch.mapping.get() + start, data.data(), data.size());
+            recording.offset = start + data.size();
+            return {ch.memory.get(), start};
+        }
+    }
+    /// Batches that have finished hand their chunks back before looking
+    retire();
+    auto reusable = std::find_if(spare.begin(), spare.end(), [&](auto &ch) {
+        return ch.memory.byte_count() >= data.size();
+    });
+    if (reusable != spare.end()) {
+        chunks.push_back(std::move(*reusable));
+        spare.erase(reusable);
+    } else {
+        ++c_chunks_created;
+        buffer<std::byte> memory{
+                allocator, std::max(data.size(), config.chunk_size),
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                        | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+        auto mapping = memory.map();
+        chunks.push_back({std::move(memory), std::move(mapping)});
+    }
+    auto &ch = chunks.back();
+    std::memcpy(ch.mapping.get(), data.data(), data.size());
+    recording.offset = data.size();
+    return {ch.memory.get(), 0};
+}
+
+
+void planet::vk::upload_engine::copy(
+        std::span<std::byte const> const data,
+        VkBuffer const destination,
+        VkDeviceSize const destination_offset,
+        VkPipelineStageFlags const destination_stage,
+        VkAccessFlags const destination_access) {
+    if (data.empty()) { return; }
+    auto const source = allocate(data, 16);
+    VkBufferCopy const region{
+            .srcOffset = source.offset,
+            .dstOffset = destination_offset,
+            .size = data.size()};
+    vkCmdCopyBuffer(commands().get(), source.buffer, destination, 1, &region);
+    ++recording.copies;
+    ++c_copies;
+
+    VkBufferMemoryBarrier barrier{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = nullptr,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = destination_access,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = destination,
+            .offset = destination_offset,
+            .size = data.size()};
+    if (transfers_ownership()) {
+        barrier.srcQueueFamilyIndex = transfer_family;
+        barrier.dstQueueFamilyIndex = graphics_family;
+        auto acquire = barrier;
+        acquire.srcAccessMask = VK_ACCESS_NONE;
+        recording.buffer_acquires.push_back(acquire);
+        /// The destination access is meaningless on the releasing queue
+        barrier.dstAccessMask = VK_ACCESS_NONE;
+    }
+    recording.buffer_releases.push_back(barrier);
+    recording.destination_stages |= destination_stage;
+}
+
+
+void planet::vk::upload_engine::copy(
+        std::span<std::byte const> const data,
+        vk::image &destination,
+        VkImageLayout const final_layout,
+        VkPipelineStageFlags const destination_stage,
+        VkAccessFlags const destination_access) {
+    auto const needed = std::size_t{destination.width} * destination.height
+            * bytes_per_texel(destination.format);
+    if (data.size() < needed) {
+        throw felspar::stdexcept::logic_error{
+                "The data doesn't cover the whole of the image"};
+    }
+    auto const source = allocate(data.first(needed), 16);
+    auto &cb = commands();
+
+    std::array const to_transfer{destination.transition(
+            {.old_layout = VK_IMAGE_LAYOUT_UNDEFINED,
+             .new_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+             .destination_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT})};
+    cb.pipeline_barrier(
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            to_transfer);
+
+    VkBufferImageCopy const region{
+            .bufferOffset = source.offset,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource =
+                    {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                     .mipLevel = 0,
+                     .baseArrayLayer = 0,
+                     .layerCount = 1},
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {destination.width, destination.height, 1}};
+    vkCmdCopyBufferToImage(
+            cb.get(), source.buffer, destination.get(),
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    ++recording.copies;
+    ++c_copies;
+
+    if (transfers_ownership()) {
+        recording.image_releases.push_back(destination.transition(
+                {.old_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 .new_layout = final_layout,
+                 .source_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                 .destination_access_mask = VK_ACCESS_NONE,
+                 .source_queue_family_index = transfer_family,
+                 .destination_queue_family_index = graphics_family}));
+        recording.image_acquires.push_back(destination.transition(
+                {.old_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 .new_layout = final_layout,
+                 .source_access_mask = VK_ACCESS_NONE,
+                 .destination_access_mask = destination_access,
+                 .source_queue_family_index = transfer_family,
+                 .destination_queue_family_index = graphics_family}));
+    } else {
+        recording.image_releases.push_back(destination.transition(
+                {.old_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 .new_layout = final_layout,
+                 .source_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                 .destination_access_mask = destination_access}));
+    }
+    destination.layout = final_layout;
+    recording.destination_stages |= destination_stage;
+}
+
+
+auto planet::vk::upload_engine::submit() -> ticket {
+    retire();
+    if (not recording.copies) { return {}; }
+    trace::scope const tracing{"upload_engine::submit", "upload"};
+
+    batch submitted;
+    submitted.transfer = std::move(recording.commands);
+    submitted.chunks = std::move(recording.chunks);
+    submitted.done = std::make_shared<vk::fence>(device());
+    /// Fences are created signalled
+    submitted.done->reset();
+
+    auto const stages = recording.destination_stages;
+    auto &transfer = submitted.transfer;
+    if (transfers_ownership()) {
+        vkCmdPipelineBarrier(
+                transfer.get(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+                recording.buffer_releases.size(),
+                recording.buffer_releases.data(),
+                recording.image_releases.size(),
+                recording.image_releases.data());
+        transfer.end();
+
+        submitted.handoff = std::make_unique<vk::semaphore>(device());
+        std::array const signals{submitted.handoff->get()};
+        std::array const transfers{transfer.get()};
+        VkSubmitInfo const release_info{
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .commandBufferCount = transfers.size(),
+                .pCommandBuffers = transfers.data(),
+                .signalSemaphoreCount = signals.size(),
+                .pSignalSemaphores = signals.data()};
+        worked(vkQueueSubmit(
+                transfer_pool->command_queue(), 1, &release_info,
+                VK_NULL_HANDLE));
+
+        submitted.acquire = command_buffer::single_use(graphics_pool);
+        vkCmdPipelineBarrier(
+                submitted.acquire.get(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                stages, 0, 0, nullptr, recording.buffer_acquires.size(),
+                recording.buffer_acquires.data(),
+                recording.image_acquires.size(),
+                recording.image_acquires.data());
+        submitted.acquire.end();
+
+        std::array<VkPipelineStageFlags, 1> const wait_stages{
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+        std::array const acquires{submitted.acquire.get()};
+        VkSubmitInfo const acquire_info{
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .waitSemaphoreCount = signals.size(),
+                .pWaitSemaphores = signals.data(),
+                .pWaitDstStageMask = wait_stages.data(),
+                .commandBufferCount = acquires.size(),
+                .pCommandBuffers = acquires.data()};
+        worked(vkQueueSubmit(
+                graphics_pool.command_queue(), 1, &acquire_info,
+                submitted.done->get()));
+    } else {
+        vkCmdPipelineBarrier(
+                transfer.get(), VK_PIPELINE_STAGE_TRANSFER_BIT, stages, 0, 0,
+                nullptr, recording.buffer_releases.size(),
+                recording.buffer_releases.data(),
+                recording.image_releases.size(),
+                recording.image_releases.data());
+        transfer.end();
+        transfer.submit(submitted.done->get());
+    }
+    ++c_batches;
+
+    ticket issued;
+    issued.done = submitted.done;
+    in_flight.push_back(std::move(submitted));
+
+    recording.chunks.clear();
+    recording.offset = 0;
+    recording.copies = 0;
+    recording.buffer_releases.clear();
+    recording.image_releases.clear();
+    recording.buffer_acquires.clear();
+    recording.image_acquires.clear();
+    recording.destination_stages = {};
+    return issued;
+}
+
+
+void planet::vk::upload_engine::retire() {
+    while (not in_flight.empty() and in_flight.front().done->is_ready()) {
+        for (auto &ch : in_flight.front().chunks) {
+            spare.push_back(std::move(ch));
+        }
+        in_flight.pop_front();
+    }
+}
+
+
+void planet::vk::upload_engine::wait_idle() {
+    for (auto const &b : in_flight) {
+        ticket outstanding;
+        outstanding.done = b.done;
+        outstanding.wait();
+    }
+    retire();
+}
+
+
+/// ## `planet::vk::upload_engine::ticket`
+
+
+bool planet::vk::upload_engine::ticket::is_complete() const {
+    return not done or done->is_ready();
+}
+
+
+auto planet::vk::upload_engine::ticket::fence() const -> vk::fence const & {
+    if (not done) {
+        throw felspar::stdexcept::logic_error{
+                "An empty upload ticket has no fence"};
+    }
+    return *done;
+}
+
+
+void planet::vk::upload_engine::ticket::wait() const {
+    if (done) {
+        auto const handle = done->get();
+        worked(vkWaitForFences(
+                done->device.get(), 1, &handle, VK_TRUE,
+                std::numeric_limits<std::uint64_t>::max()));
+    }
+}
@@ -0,0 +1,125 @@
+#include <planet/log.hpp>
+#include <planet/vk/headless.hpp>
+#include <planet/vk/upload.hpp>
+
+#include <felspar/test.hpp>
+
+#include <numeric>
+
+
+namespace {
+
+
+    auto const suite = felspar::testsuite("vulkan::upload_engine", []() {
+        planet::log::active = planet::log::level::error;
+    });
+
+
+    /// ## Many copies go in one batch and arrive intact
+    auto const batches = suite.test("batch", [](auto check) {
+        /// Skip rather than fail where `VK_EXT_headless_surface` is unavailable
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::upload_engine uploads{vk->device, vk->instance.surface};
+
+        std::vector<std::uint32_t> values(1024);
+        std::iota(values.begin(), values.end(), 0u);
+        planet::vk::buffer<std::uint32_t> destination{
+                vk->device.startup_memory, values.size(),
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                        | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+
+        constexpr std::size_t parts = 8;
+        auto const part = values.size() / parts;
+        for (std::size_t index{}; index < parts; ++index) {
+            uploads.copy(
+                    std::span<std::uint32_t const>{values}.subspan(
+                            index * part, part),
+                    destination, VK_PIPELINE_STAGE_HOST_BIT,
+                    VK_ACCESS_HOST_READ_BIT, index * part);
+        }
+        check(uploads.pending_copies()) == parts;
+
+        auto const batches_before = uploads.c_batches.value();
+        auto const ticket = uploads.submit();
+        check(uploads.c_batches.value()) == batches_before + 1;
+        check(uploads.pending_copies()) == 0u;
+
+        ticket.wait();
+        check(ticket.is_complete()) == true;
+
+        auto mapped = destination.map();
+        auto const *const arrived =
+                reinterpret_cast<std::uint32_t const *>(mapped.get());
+        check(std::equal(values.begin(), values.end(), arrived)) == true;
+    });
+
+
+    /// ## Staging chunks are re-used once a batch is done
+    auto const recycles = suite.test("recycle", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::upload_engine uploads{vk->device, vk->instance.surface};
+        planet::vk::buffer<std::uint32_t> destination{
+                vk->device.startup_memory, 256,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+        std::vector<std::uint32_t> const values(256, 42u);
+
+        auto const chunks_before = uploads.c_chunks_created.value();
+        for (std::size_t round{}; round < 4; ++round) {
+            uploads.copy(
+                    std::span<std::uint32_t const>{values}, destination,
+                    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                    VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+            uploads.submit().wait();
+        }
+        check(uploads.c_chunks_created.value()) == chunks_before + 1;
+        uploads.retire();
+        check(uploads.batches_in_flight()) == 0u;
+    });
+
+
+    /// ## Images end up in their final layout
+    auto const images = suite.test("image", [](auto check) {
+        auto const vk = planet::vk::headless::make_if_available();
+        if (not vk) { return; }
+
+        planet::vk::upload_engine uploads{vk->device, vk->instance.surface};
+        planet::vk::image texture{
+                vk->device.startup_memory,
+                16,
+                16,
+                1,
+                VK_SAMPLE_COUNT_1_BIT,
+                VK_FORMAT_R8G8B8A8_UNORM,
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT};
+        std::vector<std::byte> const pixels(16 * 16 * 4, std::byte{0xff});
+
+        uploads.copy(pixels, texture);
+        check(texture.layout) == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        uploads.submit().wait();
+        check(uploads.pending_copies()) == 0u;
+
+        /// An empty batch is always complete, but has no fence to wait on
+        auto const empty = uploads.submit();
+        check(empty.is_complete()) == true;
+        check([&]() { empty.fence(); }).throws(std::logic_error{
+                "An empty upload ticket has no fence"});
+
+        /// The data must cover the whole image
+        std::span<std::byte const> const short_pixels{
+                pixels.data(), pixels.size() - 4};
+        check([&]() { uploads.copy(short_pixels, texture); })
+                .throws(std::logic_error{
+                        "The data doesn't cover the whole of the image"});
+        check(uploads.pending_copies()) == 0u;
+    });
+
+
+}